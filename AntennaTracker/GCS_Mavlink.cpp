@@ -254,6 +254,14 @@ const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
     // @RebootRequired: True
     // @User: Advanced
     AP_GROUPINFO("PARAMS",   8, GCS_MAVLINK_Parameters, streamRates[8],  10),
+
+    // @Param: TX_BUDGET
+    // @DisplayName: Transmit bandwidth budget
+    // @Description: Bandwidth budget in bytes per second shared by stream-rated messages, parameter downloads and MAVLink FTP replies on this link. Each gets a weighted share of the budget so that none of them starves the others on low-bandwidth telemetry radios. A value of 0 disables the budget
+    // @Range: 0 1000000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("TX_BUDGET", 10, GCS_MAVLINK_Parameters, tx_budget, 0),
     AP_GROUPEND
 };
 
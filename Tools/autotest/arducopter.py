@@ -8,7 +8,9 @@ from __future__ import print_function
 import copy
 import math
 import os
+import re
 import shutil
+import signal
 import time
 import numpy
 
@@ -3008,6 +3010,44 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
 
         self.CopterMission()
 
+    def DroneCANESCOutputs(self):
+        '''check ESC commands keep their rate with output coalescing'''
+        self.set_parameters({
+            "CAN_P1_DRIVER": 1,
+            "CAN_D1_UC_ESC_BM": 0x0f,
+            "CAN_D1_UC_OPTION": 1 << 9,  # CoalesceOutputs
+            "CAN_D1_UC_OUT_RF": 1,
+            # fly on the DroneCAN ESCs only
+            "SIM_CAN_SRV_MSK": 0xFF,
+        })
+        self.reboot_sitl()
+        self.wait_ready_to_arm()
+        self.takeoff(10, mode='LOITER')
+
+        # the first read starts the measurement period
+        self.fetch_file_via_ftp("@SYS/dronecan0_stats.txt")
+        self.delay_sim_time(5)
+        content = self.fetch_file_via_ftp("@SYS/dronecan0_stats.txt")
+        self.progress("Got content (%s)" % str(content))
+
+        m = re.search(r"bus_load: (-?\d+)%", content)
+        if m is None:
+            raise NotAchievedException("No bus load in stats")
+        if int(m.group(1)) < 0:
+            raise NotAchievedException("Bus load unknown, CAN bitrate not set")
+
+        lines = content.split("\n")
+        start = lines.index("ESC Node CmdHz TelemHz") + 1
+        escs = [line.split() for line in lines[start:] if len(line)]
+        if len(escs) < 4:
+            raise NotAchievedException("Expected 4 ESCs got (%s)" % str(escs))
+        for esc in escs:
+            # ESC commands must never be coalesced down to the refresh rate
+            if int(esc[2]) < 50:
+                raise NotAchievedException("ESC %s command rate %sHz too low" % (esc[0], esc[2]))
+
+        self.do_RTL()
+
     def TakeoffAlt(self):
         '''Test Takeoff command altitude'''
         # Test case #1 (set target altitude to relative -10m from the ground, -10m is invalid, so it is set to 1m)
@@ -11535,6 +11575,59 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
 
         raise NotAchievedException("Home is set when it shouldn't be")
 
+    def SITLCheckpointRestore(self):
+        '''check a landed SITL checkpoint restores parameters, position and clock'''
+        checkpoint = os.path.join(os.getcwd(), "SITLCheckpointRestore.bin")
+        if os.path.exists(checkpoint):
+            os.unlink(checkpoint)
+
+        self.context_push()
+        self.customise_SITL_commandline(["--checkpoint=%s" % checkpoint])
+
+        # move away from home so the restored position is meaningful
+        home = self.home_position_as_mav_location()
+        self.takeoff(10, mode='GUIDED')
+
+        # checkpoints are refused while armed and flying
+        os.kill(self.sitl.pid, signal.SIGUSR1)
+        self.delay_sim_time(2)
+        if os.path.exists(checkpoint):
+            raise NotAchievedException("Checkpoint written while flying")
+
+        self.fly_guided_move_local(50, 0, 10)
+        self.change_mode('LAND')
+        self.wait_disarmed()
+
+        self.set_parameter("RTL_ALT", 2345)
+        # give the parameter time to reach storage
+        self.delay_sim_time(2)
+
+        saved_loc = self.sim_location()
+        saved_time = self.get_sim_time()
+        os.kill(self.sitl.pid, signal.SIGUSR1)
+        tstart = time.time()
+        while not os.path.exists(checkpoint):
+            if time.time() - tstart > 30:
+                raise NotAchievedException("Checkpoint file not written")
+            self.delay_sim_time(1)
+
+        self.customise_SITL_commandline(["--restore=%s" % checkpoint])
+
+        self.assert_parameter_value("RTL_ALT", 2345)
+        loc = self.sim_location()
+        dist = self.get_distance(saved_loc, loc)
+        if dist > 5:
+            raise NotAchievedException("Restored %.1fm from checkpoint position" % dist)
+        home_dist = self.get_distance(home, loc)
+        if home_dist < 40:
+            raise NotAchievedException("Restored position only %.1fm from home" % home_dist)
+        if self.get_sim_time() < saved_time:
+            raise NotAchievedException("Clock not restored")
+
+        self.context_pop()
+        self.reboot_sitl()
+        os.unlink(checkpoint)
+
     def REQUIRE_POSITION_FOR_ARMING(self):
         '''check FlightOption::REQUIRE_POSITION_FOR_ARMING works'''
         self.context_push()
@@ -11650,12 +11743,14 @@ class AutoTestCopter(vehicle_test_suite.TestSuite):
             self.Clamp,
             self.GripperReleaseOnThrustLoss,
             self.REQUIRE_POSITION_FOR_ARMING,
+            self.SITLCheckpointRestore,
         ])
         return ret
 
     def testcan(self):
         ret = ([
             self.CANGPSCopterMission,
+            self.DroneCANESCOutputs,
             self.TestLogDownloadMAVProxyCAN,
         ])
         return ret
@@ -11,6 +11,7 @@ import copy
 import math
 import operator
 import os
+import shutil
 import sys
 import time
 
@@ -5317,6 +5318,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
             "math.lua",
             "strings.lua",
             "mavlink_test.lua",
+            "userdata.lua",
         ])
 
         self.context_collect('STATUSTEXT')
@@ -5328,6 +5330,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
                 "Internal tests passed",
                 "Math tests passed",
                 "String tests passed",
+                "Userdata tests passed",
                 "Received heartbeat from"
         ]:
             self.wait_statustext(success_text, check_context=True)
@@ -5356,6 +5359,82 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         self.context_pop()
         self.reboot_sitl()
 
+    def test_scripting_bytecode_cache(self):
+        self.start_subtest("Scripting bytecode cache")
+
+        script_name = "cache_test.lua"
+        script_path = self.installed_script_path(script_name)
+        cache_dir = os.path.join("scripts", "cache")
+
+        def write_script(text):
+            with open(script_path, "w") as f:
+                f.write('gcs:send_text(6, "%s")\n' % text)
+
+        def cache_files():
+            if not os.path.exists(cache_dir):
+                return []
+            return [os.path.join(cache_dir, x) for x in os.listdir(cache_dir) if x.endswith("_" + script_name + "c")]
+
+        def load_script(text):
+            self.context_clear_collection("STATUSTEXT")
+            self.reboot_sitl()
+            self.wait_statustext(text, check_context=True, timeout=30)
+
+        self.context_push()
+        self.context_collect("STATUSTEXT")
+        self.set_parameter("SCR_ENABLE", 1)
+        if not os.path.exists("scripts"):
+            os.mkdir("scripts")
+        write_script("cache test A")
+        self.context_get().installed_scripts.append(script_name)
+
+        # the cache is opt-in
+        load_script("cache test A")
+        if len(cache_files()) != 0:
+            raise NotAchievedException("Cache written while disabled")
+
+        self.set_parameter("SCR_DEBUG_OPTS", 1 << 6)
+        load_script("cache test A")
+        files = cache_files()
+        if len(files) != 1:
+            raise NotAchievedException("Expected one cache file got %s" % str(files))
+        cache_file = files[0]
+
+        # an unchanged script is loaded from the cache, not rewritten
+        mtime = os.stat(cache_file).st_mtime_ns
+        load_script("cache test A")
+        if os.stat(cache_file).st_mtime_ns != mtime:
+            raise NotAchievedException("Cache rewritten for an unchanged script")
+
+        # a tampered cache must be rejected and the source used
+        with open(cache_file, "rb") as f:
+            content = f.read()
+        if b"cache test A" not in content:
+            raise NotAchievedException("Script text not found in cache")
+        with open(cache_file, "wb") as f:
+            f.write(content.replace(b"cache test A", b"cache test B"))
+        load_script("cache test A")
+        if self.statustext_in_collections("cache test B") is not None:
+            raise NotAchievedException("Tampered cache was loaded")
+
+        # editing the script invalidates its cache entry
+        write_script("cache test C")
+        load_script("cache test C")
+        if self.statustext_in_collections("cache test A") is not None:
+            raise NotAchievedException("Stale cache was loaded")
+
+        # the cache is not used while the checksums are enforced
+        os.unlink(cache_file)
+        self.set_parameter("SCR_LD_CHECKSUM", 0)
+        load_script("cache test C")
+        if len(cache_files()) != 0:
+            raise NotAchievedException("Cache written with SCR_LD_CHECKSUM set")
+
+        self.context_pop()
+        if os.path.exists(cache_dir):
+            shutil.rmtree(cache_dir)
+        self.reboot_sitl()
+
     def ScriptingSteeringAndThrottle(self):
         '''Scripting test - steering and throttle'''
         self.start_subtest("Scripting square")
@@ -5455,6 +5534,7 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         self.test_scripting_set_home_to_vehicle_location()
         self.test_scripting_print_home_and_origin()
         self.test_scripting_hello_world()
+        self.test_scripting_bytecode_cache()
         self.test_scripting_simple_loop()
         self.test_scripting_internal_test()
         self.test_scripting_auxfunc()
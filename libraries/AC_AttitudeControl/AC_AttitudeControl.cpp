@@ -918,10 +918,13 @@ Vector3f AC_AttitudeControl::euler_accel_limit(const Quaternion &att, const Vect
     const float phi = att.get_euler_roll();
     const float theta = att.get_euler_pitch();
 
-    const float sin_phi = constrain_float(fabsf(sinf(phi)), 0.1f, 1.0f);
-    const float cos_phi = constrain_float(fabsf(cosf(phi)), 0.1f, 1.0f);
-    const float sin_theta = constrain_float(fabsf(sinf(theta)), 0.1f, 1.0f);
-    const float cos_theta = constrain_float(fabsf(cosf(theta)), 0.1f, 1.0f);
+    float sin_phi, cos_phi, sin_theta, cos_theta;
+    ctrl_sincosf(phi, sin_phi, cos_phi);
+    ctrl_sincosf(theta, sin_theta, cos_theta);
+    sin_phi = constrain_float(fabsf(sin_phi), 0.1f, 1.0f);
+    cos_phi = constrain_float(fabsf(cos_phi), 0.1f, 1.0f);
+    sin_theta = constrain_float(fabsf(sin_theta), 0.1f, 1.0f);
+    cos_theta = constrain_float(fabsf(cos_theta), 0.1f, 1.0f);
 
     return Vector3f {
         euler_accel.x,
@@ -983,10 +986,9 @@ void AC_AttitudeControl::euler_rate_to_ang_vel(const Quaternion& att, const Vect
     const float theta = att.get_euler_pitch();
     const float phi = att.get_euler_roll();
 
-    const float sin_theta = sinf(theta);
-    const float cos_theta = cosf(theta);
-    const float sin_phi = sinf(phi);
-    const float cos_phi = cosf(phi);
+    float sin_theta, cos_theta, sin_phi, cos_phi;
+    ctrl_sincosf(theta, sin_theta, cos_theta);
+    ctrl_sincosf(phi, sin_phi, cos_phi);
 
     ang_vel_rads.x = euler_rate_rads.x - sin_theta * euler_rate_rads.z;
     ang_vel_rads.y = cos_phi * euler_rate_rads.y + sin_phi * cos_theta * euler_rate_rads.z;
@@ -1000,10 +1002,9 @@ bool AC_AttitudeControl::ang_vel_to_euler_rate(const Quaternion& att, const Vect
     const float theta = att.get_euler_pitch();
     const float phi = att.get_euler_roll();
 
-    const float sin_theta = sinf(theta);
-    const float cos_theta = cosf(theta);
-    const float sin_phi = sinf(phi);
-    const float cos_phi = cosf(phi);
+    float sin_theta, cos_theta, sin_phi, cos_phi;
+    ctrl_sincosf(theta, sin_theta, cos_theta);
+    ctrl_sincosf(phi, sin_phi, cos_phi);
 
     // When the vehicle pitches all the way up or all the way down, the euler angles become discontinuous. In this case, we just return false.
     if (is_zero(cos_theta)) {
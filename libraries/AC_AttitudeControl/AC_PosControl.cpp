@@ -1065,12 +1065,10 @@ void AC_PosControl::set_pos_vel_accel_xy(const Vector2p& pos, const Vector2f& ve
 Vector3f AC_PosControl::lean_angles_to_accel(const Vector3f& att_target_euler) const
 {
     // rotate our roll, pitch angles into lat/lon frame
-    const float sin_roll = sinf(att_target_euler.x);
-    const float cos_roll = cosf(att_target_euler.x);
-    const float sin_pitch = sinf(att_target_euler.y);
-    const float cos_pitch = cosf(att_target_euler.y);
-    const float sin_yaw = sinf(att_target_euler.z);
-    const float cos_yaw = cosf(att_target_euler.z);
+    float sin_roll, cos_roll, sin_pitch, cos_pitch, sin_yaw, cos_yaw;
+    ctrl_sincosf(att_target_euler.x, sin_roll, cos_roll);
+    ctrl_sincosf(att_target_euler.y, sin_pitch, cos_pitch);
+    ctrl_sincosf(att_target_euler.z, sin_yaw, cos_yaw);
 
     return Vector3f{
         (GRAVITY_MSS * 100.0f) * (-cos_yaw * sin_pitch * cos_roll - sin_yaw * sin_roll) / MAX(cos_roll * cos_pitch, 0.1f),
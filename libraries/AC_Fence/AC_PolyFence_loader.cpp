@@ -15,6 +15,7 @@
 #include <GCS_MAVLink/GCS.h>
 #include <AP_Logger/AP_Logger.h>
 #include <AC_Fence/AC_Fence.h>
+#include <AP_Common/LocalTangentPlane.h>
 
 #include <stdio.h>
 
@@ -254,12 +255,16 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
         }
     }
 
+    // distances to all circle centres are taken in one tangent plane
+    // around the vehicle so the longitude scale is only calculated once
+    const LocalTangentPlane plane{loc};
+
     for (uint8_t i=0; i<_num_loaded_circle_exclusion_boundaries; i++) {
         const ExclusionCircle &circle = _loaded_circle_exclusion_boundary[i];
         Location circle_center;
         circle_center.lat = circle.point.x;
         circle_center.lng = circle.point.y;
-        const float diff_cm = loc.get_distance(circle_center)*100.0f;
+        const float diff_cm = plane.get_distance_NE(circle_center).length()*100.0f;
         if (diff_cm < circle.radius * 100.0f) {
             return true;
         }
@@ -270,7 +275,7 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
         Location circle_center;
         circle_center.lat = circle.point.x;
         circle_center.lng = circle.point.y;
-        const float diff_cm = loc.get_distance(circle_center)*100.0f;
+        const float diff_cm = plane.get_distance_NE(circle_center).length()*100.0f;
         if (diff_cm > circle.radius * 100.0f) {
             num_inclusion_outside++;
         }
@@ -294,7 +294,15 @@ void AP_AHRS::update_trim_rotation_matrices()
 // return a Quaternion representing our current attitude in NED frame
 void AP_AHRS::get_quat_body_to_ned(Quaternion &quat) const
 {
-    quat.from_rotation_matrix(get_rotation_body_to_ned());
+    if (!hal.scheduler->in_main_thread()) {
+        quat.from_rotation_matrix(get_rotation_body_to_ned());
+        return;
+    }
+    if (_quat_cache_version != _attitude_version) {
+        _quat_cache.from_rotation_matrix(get_rotation_body_to_ned());
+        _quat_cache_version = _attitude_version;
+    }
+    quat = _quat_cache;
 }
 
 // convert a vector from body to earth frame
@@ -584,6 +584,10 @@ public:
     // return a Quaternion representing our current attitude in NED frame
     void get_quat_body_to_ned(Quaternion &quat) const;
 
+    // incremented each time the attitude changes, so callers can tell
+    // whether values they derived from it are still current
+    uint32_t get_attitude_version(void) const { return _attitude_version; }
+
 #if AP_AHRS_DCM_ENABLED
     // get rotation matrix specifically from DCM backend (used for
     // compass calibrator)
@@ -752,6 +756,17 @@ private:
     float _sin_pitch;
     float _sin_yaw;
 
+    // see get_attitude_version()
+    uint32_t _attitude_version{1};
+
+    /*
+      attitude quaternion, calculated from the rotation matrix on first
+      use in each attitude version rather than by every caller. Only
+      the main thread, which also updates the attitude, uses the cache
+     */
+    mutable Quaternion _quat_cache;
+    mutable uint32_t _quat_cache_version;
+
 #if HAL_NAVEKF2_AVAILABLE
     void update_EKF2(void);
     bool _ekf2_started;
@@ -141,6 +141,9 @@ void AP_AHRS::calc_trig(const Matrix3f &rot,
 //      should be called after _dcm_matrix is updated
 void AP_AHRS::update_trig(void)
 {
+    // this is called after every change to the rotation matrix
+    _attitude_version++;
+
     calc_trig(get_rotation_body_to_ned(),
               _cos_roll, _cos_pitch, _cos_yaw,
               _sin_roll, _sin_pitch, _sin_yaw);
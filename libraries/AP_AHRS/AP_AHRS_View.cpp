@@ -20,6 +20,9 @@
 
 #include "AP_AHRS_View.h"
 #include <stdio.h>
+#include <AP_HAL/AP_HAL.h>
+
+extern const AP_HAL::HAL& hal;
 
 AP_AHRS_View::AP_AHRS_View(AP_AHRS &_ahrs, enum Rotation _rotation, float pitch_trim_deg) :
     rotation(_rotation),
@@ -80,6 +83,22 @@ void AP_AHRS_View::update()
     ahrs.calc_trig(rot_body_to_ned,
                    trig.cos_roll, trig.cos_pitch, trig.cos_yaw,
                    trig.sin_roll, trig.sin_pitch, trig.sin_yaw);
+
+    quat_cache_valid = false;
+}
+
+// return a Quaternion representing our current attitude in this view
+void AP_AHRS_View::get_quat_body_to_ned(Quaternion &quat) const
+{
+    if (!hal.scheduler->in_main_thread()) {
+        quat.from_rotation_matrix(rot_body_to_ned);
+        return;
+    }
+    if (!quat_cache_valid) {
+        quat_cache.from_rotation_matrix(rot_body_to_ned);
+        quat_cache_valid = true;
+    }
+    quat = quat_cache;
 }
 
 // return a smoothed and corrected gyro vector using the latest ins data (which may not have been consumed by the EKF yet)
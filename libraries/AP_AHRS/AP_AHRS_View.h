@@ -52,9 +52,7 @@ public:
     }
 
     // return a Quaternion representing our current attitude in this view
-    void get_quat_body_to_ned(Quaternion &quat) const {
-        quat.from_rotation_matrix(rot_body_to_ned);
-    }
+    void get_quat_body_to_ned(Quaternion &quat) const;
 
     // apply pitch trim
     void set_pitch_trim(float trim_deg);
@@ -218,6 +216,11 @@ private:
         float sin_yaw;
     } trig;
 
+    // attitude quaternion, calculated on first use by the main thread
+    // after each update
+    mutable Quaternion quat_cache;
+    mutable bool quat_cache_valid;
+
     float y_angle;
     float _pitch_trim_deg;
 };
@@ -285,9 +285,16 @@ float closest_approach_xy(const Location &my_loc,
                           const Vector3f &obstacle_vel,
                           const uint8_t time_horizon)
 {
+    return closest_approach_xy(obstacle_loc.get_distance_NE(my_loc), my_vel, obstacle_vel, time_horizon);
+}
+
+float closest_approach_xy(const Vector2f &delta_pos_ne,
+                          const Vector3f &my_vel,
+                          const Vector3f &obstacle_vel,
+                          const uint8_t time_horizon)
+{
 
     Vector2f delta_vel_ne = Vector2f(obstacle_vel[0] - my_vel[0], obstacle_vel[1] - my_vel[1]);
-    const Vector2f delta_pos_ne = obstacle_loc.get_distance_NE(my_loc);
 
     Vector2f line_segment_ne = delta_vel_ne * time_horizon;
 
@@ -332,22 +339,26 @@ float closest_approach_z(const Location &my_loc,
     return ret*0.01f;
 }
 
-void AP_Avoidance::update_threat_level(const Location &my_loc,
+void AP_Avoidance::update_threat_level(const LocalTangentPlane &my_frame,
                                        const Vector3f &my_vel,
                                        AP_Avoidance::Obstacle &obstacle)
 {
 
+    const Location &my_loc = my_frame.get_origin();
     Location &obstacle_loc = obstacle._location;
     Vector3f &obstacle_vel = obstacle._velocity;
 
     obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
 
+    // our position relative to the obstacle, shared by the checks below
+    const Vector2f delta_pos_ne = -my_frame.get_distance_NE(obstacle_loc);
+
     const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
-    float closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
+    float closest_xy = closest_approach_xy(delta_pos_ne, my_vel, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
     if (closest_xy < _fail_distance_xy) {
         obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
     } else {
-        closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
+        closest_xy = closest_approach_xy(delta_pos_ne, my_vel, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
         if (closest_xy < _warn_distance_xy) {
             obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
         }
@@ -376,7 +387,7 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
     // level is none - but only *once the GCS has been informed*!
     obstacle.closest_approach_xy = closest_xy;
     obstacle.closest_approach_z = closest_z;
-    float current_distance = my_loc.get_distance(obstacle_loc);
+    float current_distance = delta_pos_ne.length();
     obstacle.distance_to_closest_approach = current_distance - closest_xy;
     Vector2f net_velocity_ne = Vector2f(my_vel[0] - obstacle_vel[0], my_vel[1] - obstacle_vel[1]);
     obstacle.time_to_closest_approach = 0.0f;
@@ -477,13 +488,14 @@ void AP_Avoidance::check_for_threats()
     // is most likely our own position and/or velocity have changed
     // determine the current most-serious-threat
     _current_most_serious_threat = -1;
+    const LocalTangentPlane my_frame{my_loc};
     for (uint8_t i=0; i<_obstacle_count; i++) {
 
         AP_Avoidance::Obstacle &obstacle = _obstacles[i];
         const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
         debug("i=%d src_id=%d timestamp=%u age=%d", i, obstacle.src_id, obstacle.timestamp_ms, obstacle_age);
 
-        update_threat_level(my_loc, my_vel, obstacle);
+        update_threat_level(my_frame, my_vel, obstacle);
         debug("   threat-level=%d", obstacle.threat_level);
 
         // ignore any really old data:
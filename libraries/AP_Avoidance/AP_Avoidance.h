@@ -26,6 +26,7 @@
 */
 
 #include <AP_ADSB/AP_ADSB.h>
+#include <AP_Common/LocalTangentPlane.h>
 
 #if HAL_ADSB_ENABLED
 
@@ -171,7 +172,7 @@ private:
     uint32_t src_id_for_adsb_vehicle(const AP_ADSB::adsb_vehicle_t &vehicle) const;
 
     void check_for_threats();
-    void update_threat_level(const Location &my_loc,
+    void update_threat_level(const LocalTangentPlane &my_frame,
                              const Vector3f &my_vel,
                              AP_Avoidance::Obstacle &obstacle);
 
@@ -220,6 +221,12 @@ float closest_approach_xy(const Location &my_loc,
                           const Vector3f &obstacle_vel,
                           uint8_t time_horizon);
 
+// as above, with the north/east position of my_loc relative to the obstacle
+float closest_approach_xy(const Vector2f &delta_pos_ne,
+                          const Vector3f &my_vel,
+                          const Vector3f &obstacle_vel,
+                          uint8_t time_horizon);
+
 float closest_approach_z(const Location &my_loc,
                          const Vector3f &my_vel,
                          const Location &obstacle_loc,
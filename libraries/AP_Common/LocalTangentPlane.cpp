@@ -0,0 +1,36 @@
+#include "LocalTangentPlane.h"
+
+void LocalTangentPlane::set_origin(const Location &origin)
+{
+    _origin = origin;
+    const float lat_rad = origin.lat * (1.0e-7f * DEG_TO_RAD);
+    _cos_lat = cosf(lat_rad);
+    _sin_lat = sinf(lat_rad);
+}
+
+float LocalTangentPlane::longitude_scale(int32_t dlat) const
+{
+    // cos(lat + d) = cos(lat)*(1 - d^2/2) - sin(lat)*d + O(d^3)
+    const float d = dlat * (1.0e-7f * DEG_TO_RAD);
+    const float scale = _cos_lat - d * (_sin_lat + 0.5f * d * _cos_lat);
+    // same limit as Location::longitude_scale()
+    return MAX(scale, 0.01f);
+}
+
+Vector2f LocalTangentPlane::get_distance_NE(const Location &loc) const
+{
+    const int32_t dlat = loc.lat - _origin.lat;
+    const int32_t dlng = Location::diff_longitude(loc.lng, _origin.lng);
+    return Vector2f(dlat * float(LATLON_TO_M),
+                    dlng * float(LATLON_TO_M) * longitude_scale(dlat / 2));
+}
+
+Location LocalTangentPlane::offset(float ofs_north, float ofs_east) const
+{
+    Location loc = _origin;
+    const int32_t dlat = ofs_north * float(LATLON_TO_M_INV);
+    const int64_t dlng = (ofs_east * float(LATLON_TO_M_INV)) / longitude_scale(dlat / 2);
+    loc.lat = Location::limit_lattitude(_origin.lat + dlat);
+    loc.lng = Location::wrap_longitude(dlng + _origin.lng);
+    return loc;
+}
@@ -45,6 +45,8 @@ bool MultiHeap::create(uint32_t total_size, uint8_t max_heaps)
         return false;
     }
     num_heaps = max_heaps;
+    heap_size = total_size;
+    failed_allocations = 0;
     for (uint8_t i=0; i<max_heaps; i++) {
         uint32_t alloc_size = total_size;
         while (alloc_size > 0) {
@@ -81,6 +83,7 @@ void MultiHeap::destroy(void)
     delete[] heaps;
     heaps = nullptr;
     num_heaps = 0;
+    heap_size = 0;
 }
 
 // return true if heap is available for operations
@@ -106,6 +109,7 @@ void *MultiHeap::allocate(uint32_t size)
             return newptr;
         }
     }
+    failed_allocations++;
     return nullptr;
 }
 
@@ -141,7 +145,11 @@ void *MultiHeap::change_size(void *ptr, uint32_t old_size, uint32_t new_size)
       through old_size and new_size so that we can validate the lua
       old_size value
     */
-    return hal.util->heap_realloc(heaps[0], ptr, old_size, new_size);
+    void *newptr = hal.util->heap_realloc(heaps[0], ptr, old_size, new_size);
+    if (newptr == nullptr) {
+        failed_allocations++;
+    }
+    return newptr;
 }
 
 #endif // HAL_BOOTLOADER_BUILD
@@ -4,6 +4,10 @@
   STM32 boards
  */
 
+#pragma once
+
+#include <stdint.h>
+
 class MultiHeap {
 public:
     /*
@@ -23,7 +27,15 @@ public:
     // size, unlike realloc()
     void *change_size(void *ptr, uint32_t old_size, uint32_t new_size);
 
+    // total size of the heaps
+    uint32_t get_size(void) const { return heap_size; }
+
+    // number of allocations that failed for lack of memory
+    uint32_t get_failed_allocations(void) const { return failed_allocations; }
+
 private:
     uint8_t num_heaps;
     void **heaps;
+    uint32_t heap_size;
+    uint32_t failed_allocations;
 };
@@ -0,0 +1,182 @@
+/*
+  pools of fixed size blocks for frequent small allocations. Blocks
+  are carved from slabs allocated from a MultiHeap on demand, and slabs
+  with no blocks in use can be returned to the heap with trim()
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <AP_Math/AP_Math.h>
+#include "MultiHeap.h"
+
+template <uint8_t NUM_POOLS, uint8_t SLAB_BLOCKS, uint8_t MAX_SLABS>
+class MultiHeapPool {
+public:
+    // block sizes must be in increasing order
+    MultiHeapPool(MultiHeap &_heap, const uint16_t (&block_sizes)[NUM_POOLS]) :
+        heap(_heap)
+    {
+        for (uint8_t i = 0; i < NUM_POOLS; i++) {
+            // blocks hold the free list link, and stay 8 byte aligned
+            pools[i].block_size = uint16_t((MAX(block_sizes[i], uint16_t(sizeof(Block))) + 7U) & ~7U);
+        }
+    }
+
+    /*
+      allocate a block from the smallest pool that holds size bytes,
+      returning nullptr if there is no such pool or it is full. The
+      caller should then allocate from the heap
+     */
+    void *allocate(uint32_t size) {
+        Pool *pool = pool_for_size(size);
+        if (pool == nullptr) {
+            return nullptr;
+        }
+        if (pool->free_list == nullptr && !add_slab(*pool)) {
+            return nullptr;
+        }
+        Block *block = pool->free_list;
+        pool->free_list = block->next;
+        pool->used[pool->slab_index(block)]++;
+        return block;
+    }
+
+    /*
+      equivalent of MultiHeap::change_size() for memory from either the
+      pools or the heap. A pooled block keeps its place if the new size
+      fits the same pool, and otherwise moves to the heap
+     */
+    void *change_size(void *ptr, uint32_t old_size, uint32_t new_size) {
+        Pool *pool = ptr != nullptr ? pool_for_size(old_size) : nullptr;
+        const int8_t slab = pool != nullptr ? pool->slab_index(ptr) : -1;
+        if (slab < 0) {
+            return heap.change_size(ptr, old_size, new_size);
+        }
+        if (new_size == 0) {
+            pool->release(slab, ptr);
+            return nullptr;
+        }
+        if (pool_for_size(new_size) == pool) {
+            return ptr;
+        }
+        void *ret = heap.allocate(new_size);
+        if (ret != nullptr) {
+            memcpy(ret, ptr, MIN(old_size, new_size));
+            pool->release(slab, ptr);
+        }
+        return ret;
+    }
+
+    // return slabs with no blocks in use to the heap, true if any were
+    bool trim(void) {
+        bool freed = false;
+        for (auto &pool : pools) {
+            uint8_t i = 0;
+            while (i < pool.num_slabs) {
+                if (pool.used[i] != 0) {
+                    i++;
+                    continue;
+                }
+                // unlink the slab's blocks from the free list
+                Block **link = &pool.free_list;
+                while (*link != nullptr) {
+                    if (pool.slab_index(*link) == int8_t(i)) {
+                        *link = (*link)->next;
+                    } else {
+                        link = &(*link)->next;
+                    }
+                }
+                heap.deallocate(pool.slabs[i]);
+                pool.num_slabs--;
+                pool.slabs[i] = pool.slabs[pool.num_slabs];
+                pool.used[i] = pool.used[pool.num_slabs];
+                freed = true;
+            }
+        }
+        return freed;
+    }
+
+    // heap memory held in slabs but not in use
+    uint32_t free_bytes(void) const {
+        uint32_t ret = 0;
+        for (const auto &pool : pools) {
+            for (uint8_t i = 0; i < pool.num_slabs; i++) {
+                ret += uint32_t(SLAB_BLOCKS - pool.used[i]) * pool.block_size;
+            }
+        }
+        return ret;
+    }
+
+    // forget all slabs, for when the heap itself is destroyed
+    void reset(void) {
+        for (auto &pool : pools) {
+            pool.num_slabs = 0;
+            pool.free_list = nullptr;
+        }
+    }
+
+private:
+    struct Block {
+        Block *next;
+    };
+
+    struct Pool {
+        uint16_t block_size;
+        uint8_t num_slabs;
+        uint8_t *slabs[MAX_SLABS];
+        uint8_t used[MAX_SLABS];    // blocks in use in each slab
+        Block *free_list;
+
+        // index of the slab holding ptr, or -1 if it is not pooled
+        int8_t slab_index(const void *ptr) const {
+            const uint32_t slab_size = uint32_t(block_size) * SLAB_BLOCKS;
+            for (uint8_t i = 0; i < num_slabs; i++) {
+                if (ptr >= slabs[i] && ptr < slabs[i] + slab_size) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        void release(int8_t slab, void *ptr) {
+            Block *block = (Block *)ptr;
+            block->next = free_list;
+            free_list = block;
+            used[slab]--;
+        }
+    };
+
+    // return the smallest pool that holds size bytes, or nullptr if none do
+    Pool *pool_for_size(uint32_t size) {
+        for (auto &pool : pools) {
+            if (size <= pool.block_size) {
+                return &pool;
+            }
+        }
+        return nullptr;
+    }
+
+    // add a slab, threading its blocks onto the free list
+    bool add_slab(Pool &pool) {
+        if (pool.num_slabs >= MAX_SLABS) {
+            return false;
+        }
+        uint8_t *slab = (uint8_t *)heap.allocate(uint32_t(pool.block_size) * SLAB_BLOCKS);
+        if (slab == nullptr) {
+            return false;
+        }
+        pool.slabs[pool.num_slabs] = slab;
+        pool.used[pool.num_slabs] = 0;
+        pool.num_slabs++;
+        for (uint8_t i = 0; i < SLAB_BLOCKS; i++) {
+            Block *block = (Block *)&slab[uint32_t(i) * pool.block_size];
+            block->next = pool.free_list;
+            pool.free_list = block;
+        }
+        return true;
+    }
+
+    MultiHeap &heap;
+    Pool pools[NUM_POOLS] {};
+};
@@ -0,0 +1,74 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Common/Location.h>
+#include <AP_Common/LocalTangentPlane.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static Location bm_origin()
+{
+    Location loc;
+    loc.lat = -353632620;
+    loc.lng = 1491652300;
+    return loc;
+}
+
+// a point moving around within a few km of the origin
+static Location bm_point(const Location &origin, uint32_t i)
+{
+    Location loc = origin;
+    loc.lat += int32_t(i % 4001) * 97 - 194000;
+    loc.lng += int32_t(i % 3989) * 113 - 225000;
+    return loc;
+}
+
+static void BM_LocationDistanceNE(benchmark::State& state)
+{
+    const Location origin = bm_origin();
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        Vector2f ne = origin.get_distance_NE(bm_point(origin, i++));
+        gbenchmark_escape(&ne);
+    }
+}
+
+static void BM_LocalTangentPlaneDistanceNE(benchmark::State& state)
+{
+    const Location origin = bm_origin();
+    const LocalTangentPlane frame{origin};
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        Vector2f ne = frame.get_distance_NE(bm_point(origin, i++));
+        gbenchmark_escape(&ne);
+    }
+}
+
+static void BM_LocationOffset(benchmark::State& state)
+{
+    const Location origin = bm_origin();
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        Location loc = origin;
+        loc.offset(float(i % 4001) - 2000.0f, float(i % 3989) - 1994.0f);
+        i++;
+        gbenchmark_escape(&loc);
+    }
+}
+
+static void BM_LocalTangentPlaneOffset(benchmark::State& state)
+{
+    const LocalTangentPlane frame{bm_origin()};
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        Location loc = frame.offset(float(i % 4001) - 2000.0f, float(i % 3989) - 1994.0f);
+        i++;
+        gbenchmark_escape(&loc);
+    }
+}
+
+BENCHMARK(BM_LocationDistanceNE);
+BENCHMARK(BM_LocalTangentPlaneDistanceNE);
+BENCHMARK(BM_LocationOffset);
+BENCHMARK(BM_LocalTangentPlaneOffset);
+
+BENCHMARK_MAIN();
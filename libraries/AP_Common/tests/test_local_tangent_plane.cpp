@@ -0,0 +1,67 @@
+#include <AP_gtest.h>
+#include <AP_Common/LocalTangentPlane.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// reference north/east distance using the mean latitude in double precision
+static void reference_NE(const Location &from, const Location &to, double &north, double &east)
+{
+    const double mean_lat_rad = (double(from.lat) + double(to.lat)) * 0.5 * 1.0e-7 * DEG_TO_RAD;
+    north = (double(to.lat) - double(from.lat)) * LATLON_TO_M;
+    east = Location::diff_longitude(to.lng, from.lng) * LATLON_TO_M * cos(mean_lat_rad);
+}
+
+TEST(LocalTangentPlaneTest, DistanceNE)
+{
+    // including the date line and high latitudes
+    const int32_t origin_lats[] { 0, -353632620, 473980000, 780000000 };
+    const int32_t origin_lngs[] { 0, 1491652300, -1799900000, 1799990000 };
+    for (uint8_t i = 0; i < ARRAY_SIZE(origin_lats); i++) {
+        Location origin;
+        origin.lat = origin_lats[i];
+        origin.lng = origin_lngs[i];
+        const LocalTangentPlane frame{origin};
+
+        // points up to 50km away
+        for (int32_t dn = -4500000; dn <= 4500000; dn += 450000) {
+            for (int32_t de = -4500000; de <= 4500000; de += 450000) {
+                Location loc = origin;
+                loc.lat += dn;
+                loc.lng = Location::wrap_longitude(int64_t(loc.lng) + de);
+                double north, east;
+                reference_NE(origin, loc, north, east);
+                const Vector2f ne = frame.get_distance_NE(loc);
+                EXPECT_NEAR(ne.x, north, 0.01) << "origin " << unsigned(i);
+                EXPECT_NEAR(ne.y, east, 0.01) << "origin " << unsigned(i);
+            }
+        }
+    }
+}
+
+TEST(LocalTangentPlaneTest, Offset)
+{
+    Location origin;
+    origin.lat = -353632620;
+    origin.lng = 1491652300;
+    origin.alt = 58400;
+    const LocalTangentPlane frame{origin};
+
+    for (float n = -50000; n <= 50000; n += 2500) {
+        for (float e = -50000; e <= 50000; e += 2500) {
+            Location expected = origin;
+            expected.offset(n, e);
+            const Location loc = frame.offset(n, e);
+            // within one unit of the 1e-7 degree resolution
+            EXPECT_NEAR(loc.lat, expected.lat, 1);
+            EXPECT_NEAR(loc.lng, expected.lng, 1);
+            EXPECT_EQ(loc.alt, origin.alt);
+
+            // and the round trip is within the location resolution
+            const Vector2f ne = frame.get_distance_NE(loc);
+            EXPECT_NEAR(ne.x, n, 0.02);
+            EXPECT_NEAR(ne.y, e, 0.02);
+        }
+    }
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,144 @@
+#include <AP_gtest.h>
+#include <AP_Common/MultiHeapPool.h>
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// two pools of 16 and 32 byte blocks, 4 blocks per slab and 2 slabs each
+typedef MultiHeapPool<2, 4, 2> TestPool;
+static const uint16_t test_block_sizes[] { 16, 32 };
+
+class MultiHeapPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(heap.create(1024, 1));
+    }
+    void TearDown() override {
+        pool.reset();
+        heap.destroy();
+    }
+    MultiHeap heap;
+    TestPool pool{heap, test_block_sizes};
+};
+
+TEST_F(MultiHeapPoolTest, AllocateFree)
+{
+    // sizes beyond the largest block are not pooled
+    EXPECT_EQ(nullptr, pool.allocate(33));
+
+    void *blocks[8];
+    for (uint8_t i = 0; i < 8; i++) {
+        blocks[i] = pool.allocate(10);
+        ASSERT_NE(nullptr, blocks[i]);
+        EXPECT_EQ(0U, uintptr_t(blocks[i]) & 7U);
+        memset(blocks[i], i, 10);
+        for (uint8_t j = 0; j < i; j++) {
+            EXPECT_NE(blocks[i], blocks[j]);
+        }
+    }
+    EXPECT_EQ(0U, pool.free_bytes());
+
+    // both slabs are full
+    EXPECT_EQ(nullptr, pool.allocate(16));
+
+    // blocks do not overlap
+    for (uint8_t i = 0; i < 8; i++) {
+        for (uint8_t j = 0; j < 10; j++) {
+            EXPECT_EQ(i, ((uint8_t *)blocks[i])[j]);
+        }
+    }
+
+    // a freed block is reused
+    EXPECT_EQ(nullptr, pool.change_size(blocks[3], 10, 0));
+    EXPECT_EQ(16U, pool.free_bytes());
+    EXPECT_EQ(blocks[3], pool.allocate(16));
+    EXPECT_EQ(0U, pool.free_bytes());
+
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_EQ(nullptr, pool.change_size(blocks[i], 10, 0));
+    }
+    EXPECT_EQ(8 * 16U, pool.free_bytes());
+}
+
+TEST_F(MultiHeapPoolTest, ChangeSize)
+{
+    uint8_t *p = (uint8_t *)pool.allocate(12);
+    ASSERT_NE(nullptr, p);
+    for (uint8_t i = 0; i < 12; i++) {
+        p[i] = i;
+    }
+
+    // growing within the block size keeps the block
+    EXPECT_EQ(p, pool.change_size(p, 12, 16));
+
+    // growing beyond it moves to the heap and frees the block
+    uint8_t *q = (uint8_t *)pool.change_size(p, 16, 24);
+    ASSERT_NE(nullptr, q);
+    EXPECT_NE(p, q);
+    for (uint8_t i = 0; i < 12; i++) {
+        EXPECT_EQ(i, q[i]);
+    }
+    EXPECT_EQ(4 * 16U, pool.free_bytes());
+
+    // heap memory is passed through to the heap
+    uint8_t *r = (uint8_t *)pool.change_size(q, 24, 200);
+    ASSERT_NE(nullptr, r);
+    for (uint8_t i = 0; i < 12; i++) {
+        EXPECT_EQ(i, r[i]);
+    }
+    EXPECT_EQ(nullptr, pool.change_size(r, 200, 0));
+
+    // a new allocation with no old pointer comes from the heap
+    void *s = pool.change_size(nullptr, 0, 8);
+    ASSERT_NE(nullptr, s);
+    EXPECT_EQ(4 * 16U, pool.free_bytes());
+    EXPECT_EQ(nullptr, pool.change_size(s, 8, 0));
+}
+
+TEST_F(MultiHeapPoolTest, Trim)
+{
+    // fill both slabs of the 32 byte pool
+    void *blocks[8];
+    for (uint8_t i = 0; i < 8; i++) {
+        blocks[i] = pool.allocate(32);
+        ASSERT_NE(nullptr, blocks[i]);
+    }
+    // the slabs leave too little of the heap for a large allocation
+    EXPECT_EQ(nullptr, heap.allocate(800));
+
+    // nothing to trim while the slabs are in use
+    EXPECT_FALSE(pool.trim());
+
+    // empty the first slab, keeping one block of the second
+    for (uint8_t i = 0; i < 7; i++) {
+        pool.change_size(blocks[i], 32, 0);
+    }
+    EXPECT_EQ(7 * 32U, pool.free_bytes());
+    EXPECT_TRUE(pool.trim());
+    EXPECT_EQ(3 * 32U, pool.free_bytes());
+
+    // the remaining slab still works
+    void *more[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        more[i] = pool.allocate(32);
+        ASSERT_NE(nullptr, more[i]);
+        EXPECT_NE(blocks[7], more[i]);
+    }
+    EXPECT_EQ(0U, pool.free_bytes());
+    for (uint8_t i = 0; i < 3; i++) {
+        pool.change_size(more[i], 32, 0);
+    }
+    pool.change_size(blocks[7], 32, 0);
+
+    // with all slabs returned the heap has room again
+    EXPECT_TRUE(pool.trim());
+    EXPECT_EQ(0U, pool.free_bytes());
+    void *big = heap.allocate(800);
+    EXPECT_NE(nullptr, big);
+    heap.deallocate(big);
+
+    // and the pool can grow again
+    EXPECT_NE(nullptr, pool.allocate(32));
+}
+
+AP_GTEST_MAIN()
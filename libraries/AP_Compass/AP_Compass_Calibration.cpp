@@ -95,6 +95,13 @@ bool Compass::_start_calibration(uint8_t i, bool retry, float delay)
         // lot noisier
         _calibrator[prio]->start(retry, delay, get_offsets_max(), i, _calibration_threshold*2);
     }
+#if COMPASS_CAL_THREAD_PER_COMPASS
+    _cal_requires_reboot = true;
+    if (!_calibrator[prio]->start_thread()) {
+        GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "CompassCalibrator: Cannot start compass thread.");
+        return false;
+    }
+#else
     if (!_cal_thread_started) {
         _cal_requires_reboot = true;
         if (!hal.scheduler->thread_create(FUNCTOR_BIND(this, &Compass::_update_calibration_trampoline, void), "compasscal", 2048, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
@@ -103,6 +110,7 @@ bool Compass::_start_calibration(uint8_t i, bool retry, float delay)
         }
         _cal_thread_started = true;
     }
+#endif
 
     // disable compass learning both for calibration and after completion
     _learn.set_and_save(0);
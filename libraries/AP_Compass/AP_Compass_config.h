@@ -22,6 +22,12 @@
 #define AP_COMPASS_CALIBRATION_FIXED_YAW_ENABLED AP_COMPASS_ENABLED && AP_GPS_ENABLED && AP_AHRS_ENABLED
 #endif
 
+// give each compass being calibrated its own fitting thread so that
+// calibrations run in parallel on boards with more than one core
+#ifndef COMPASS_CAL_THREAD_PER_COMPASS
+#define COMPASS_CAL_THREAD_PER_COMPASS (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 #define COMPASS_MAX_SCALE_FACTOR 1.5
 #define COMPASS_MIN_SCALE_FACTOR (1.0/COMPASS_MAX_SCALE_FACTOR)
 
@@ -65,6 +65,7 @@
 #include "CompassCalibrator.h"
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_GeodesicGrid.h>
+#include <AP_Math/matrixN.h>
 #include <AP_AHRS/AP_AHRS.h>
 #include <AP_GPS/AP_GPS.h>
 #include <GCS_MAVLink/GCS.h>
@@ -221,6 +222,28 @@ void CompassCalibrator::update()
     }
 }
 
+#if COMPASS_CAL_THREAD_PER_COMPASS
+bool CompassCalibrator::start_thread()
+{
+    if (_thread_started) {
+        return true;
+    }
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&CompassCalibrator::thread_main, void), "compasscal", 2048, AP_HAL::Scheduler::PRIORITY_IO, 0)) {
+        return false;
+    }
+    _thread_started = true;
+    return true;
+}
+
+void CompassCalibrator::thread_main()
+{
+    while (true) {
+        update();
+        hal.scheduler->delay(1);
+    }
+}
+#endif
+
 void CompassCalibrator::pull_sample()
 {
     CompassSample mag_sample;
@@ -557,14 +580,13 @@ bool CompassCalibrator::accept_sample(const CompassSample& sample, uint16_t skip
     return accept_sample(sample.get(), skip_index);
 }
 
-float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const
+Matrix3f CompassCalibrator::param_t::get_softiron() const
 {
-    Matrix3f softiron(
-        params.diag.x    , params.offdiag.x , params.offdiag.y,
-        params.offdiag.x , params.diag.y    , params.offdiag.z,
-        params.offdiag.y , params.offdiag.z , params.diag.z
+    return Matrix3f(
+        diag.x    , offdiag.x , offdiag.y,
+        offdiag.x , diag.y    , offdiag.z,
+        offdiag.y , offdiag.z , diag.z
     );
-    return params.radius - (softiron*(sample+params.offset)).length();
 }
 
 // calc the fitness given a set of parameters (offsets, diagonals, off diagonals)
@@ -573,16 +595,38 @@ float CompassCalibrator::calc_mean_squared_residuals(const param_t& params) cons
     if (_sample_buffer == nullptr || _samples_collected == 0) {
         return 1.0e30f;
     }
+    const Matrix3f softiron = params.get_softiron();
     float sum = 0.0f;
     for (uint16_t i=0; i < _samples_collected; i++) {
         Vector3f sample = _sample_buffer[i].get();
-        float resid = calc_residual(sample, params);
+        float resid = params.radius - (softiron*(sample+params.offset)).length();
         sum += sq(resid);
     }
     sum /= _samples_collected;
     return sum;
 }
 
+// calc the fitness of the two candidate parameter sets of a fit step
+// in one pass, so each sample is only decompressed once
+void CompassCalibrator::calc_mean_squared_residuals(const param_t& params1, const param_t& params2, float &fit1, float &fit2) const
+{
+    if (_sample_buffer == nullptr || _samples_collected == 0) {
+        fit1 = fit2 = 1.0e30f;
+        return;
+    }
+    const Matrix3f softiron1 = params1.get_softiron();
+    const Matrix3f softiron2 = params2.get_softiron();
+    float sum1 = 0.0f;
+    float sum2 = 0.0f;
+    for (uint16_t i=0; i < _samples_collected; i++) {
+        const Vector3f sample = _sample_buffer[i].get();
+        sum1 += sq(params1.radius - (softiron1*(sample+params1.offset)).length());
+        sum2 += sq(params2.radius - (softiron2*(sample+params2.offset)).length());
+    }
+    fit1 = sum1 / _samples_collected;
+    fit2 = sum2 / _samples_collected;
+}
+
 // calculate initial offsets by simply taking the average values of the samples
 void CompassCalibrator::calc_initial_offset()
 {
@@ -594,28 +638,23 @@ void CompassCalibrator::calc_initial_offset()
     _params.offset /= _samples_collected;
 }
 
-void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+float CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t& params, const Matrix3f& softiron, float* ret) const
 {
-    const Vector3f &offset = params.offset;
-    const Vector3f &diag = params.diag;
-    const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
-
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
+    // corrected sample, its length is the estimated field strength
+    const Vector3f corrected = softiron*(sample+params.offset);
+    const float length = corrected.length();
+    // softiron is symmetric, so this is the derivative of the length
+    // with respect to the offsets
+    const Vector3f dlength = softiron*corrected / length;
 
     // 0: partial derivative (radius wrt fitness fn) fn operated on sample
     ret[0] = 1.0f;
     // 1-3: partial derivative (offsets wrt fitness fn) fn operated on sample
-    ret[1] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[2] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+    ret[1] = -dlength.x;
+    ret[2] = -dlength.y;
+    ret[3] = -dlength.z;
+
+    return params.radius - length;
 }
 
 // run sphere fit to calculate diagonals and offdiagonals
@@ -633,55 +672,55 @@ void CompassCalibrator::run_sphere_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
+    // JTJ is symmetric so only its lower triangle is accumulated
+    MatrixN<float,COMPASS_CAL_NUM_SPHERE_PARAMS> JTJ;
+    VectorN<float,COMPASS_CAL_NUM_SPHERE_PARAMS> JTFI;
 
-    // Gauss Newton Part common for all kind of extensions including LM
+    // Gauss Newton Part common for all kind of extensions including LM.
+    // The residual and jacobian of each sample come from a single pass
+    const Matrix3f softiron = fit1_params.get_softiron();
     for (uint16_t k = 0; k<_samples_collected; k++) {
         Vector3f sample = _sample_buffer[k].get();
 
-        float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
+        VectorN<float,COMPASS_CAL_NUM_SPHERE_PARAMS> sphere_jacob;
 
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
+        const float residual = calc_sphere_jacob(sample, fit1_params, softiron, &sphere_jacob[0]);
 
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
+        // compute JTJ
+        JTJ.add_outer_lower(sphere_jacob);
+        // compute JTFI
+        JTFI += sphere_jacob * residual;
     }
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
+    // solve the damped normal equations for both candidate lambdas
+    // with a Cholesky factorisation rather than forming inverses
+    VectorN<float,COMPASS_CAL_NUM_SPHERE_PARAMS> step1, step2;
+    MatrixN<float,COMPASS_CAL_NUM_SPHERE_PARAMS> JTJ_damped = JTJ;
     for (uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda/lma_damping;
+        JTJ_damped(i, i) += _sphere_lambda;
     }
-
-    if (!mat_inverse(JTJ, JTJ, 4)) {
+    if (!JTJ_damped.solve_spd(JTFI, step1)) {
         return;
     }
 
-    if (!mat_inverse(JTJ2, JTJ2, 4)) {
+    JTJ_damped = JTJ;
+    for (uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
+        JTJ_damped(i, i) += _sphere_lambda/lma_damping;
+    }
+    if (!JTJ_damped.solve_spd(JTFI, step2)) {
         return;
     }
 
     // extract radius, offset, diagonals and offdiagonal parameters
     for (uint8_t row=0; row < COMPASS_CAL_NUM_SPHERE_PARAMS; row++) {
-        for (uint8_t col=0; col < COMPASS_CAL_NUM_SPHERE_PARAMS; col++) {
-            fit1_params.get_sphere_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-            fit2_params.get_sphere_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-        }
+        fit1_params.get_sphere_params()[row] -= step1[row];
+        fit2_params.get_sphere_params()[row] -= step2[row];
     }
 
     // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    calc_mean_squared_residuals(fit1_params, fit2_params, fit1, fit2);
 
     // decide which of the two sets of parameters is best and store in fit1_params
     if (fit1 > _fitness && fit2 > _fitness) {
@@ -705,34 +744,31 @@ void CompassCalibrator::run_sphere_fit()
     }
 }
 
-void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
+float CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, const Matrix3f& softiron, float* ret) const
 {
-    const Vector3f &offset = params.offset;
-    const Vector3f &diag = params.diag;
-    const Vector3f &offdiag = params.offdiag;
-    Matrix3f softiron(
-        diag.x    , offdiag.x , offdiag.y,
-        offdiag.x , diag.y    , offdiag.z,
-        offdiag.y , offdiag.z , diag.z
-    );
-
-    float A =  (diag.x    * (sample.x + offset.x)) + (offdiag.x * (sample.y + offset.y)) + (offdiag.y * (sample.z + offset.z));
-    float B =  (offdiag.x * (sample.x + offset.x)) + (diag.y    * (sample.y + offset.y)) + (offdiag.z * (sample.z + offset.z));
-    float C =  (offdiag.y * (sample.x + offset.x)) + (offdiag.z * (sample.y + offset.y)) + (diag.z    * (sample.z + offset.z));
-    float length = (softiron*(sample+offset)).length();
+    const Vector3f v = sample + params.offset;
+    // corrected sample, its length is the estimated field strength
+    const Vector3f c = softiron*v;
+    const float length = c.length();
+    const float inv_length = 1.0f / length;
+    // softiron is symmetric, so this is the derivative of the length
+    // with respect to the offsets
+    const Vector3f dlength = softiron*c * inv_length;
 
     // 0-2: partial derivative (offset wrt fitness fn) fn operated on sample
-    ret[0] = -1.0f * (((diag.x    * A) + (offdiag.x * B) + (offdiag.y * C))/length);
-    ret[1] = -1.0f * (((offdiag.x * A) + (diag.y    * B) + (offdiag.z * C))/length);
-    ret[2] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
+    ret[0] = -dlength.x;
+    ret[1] = -dlength.y;
+    ret[2] = -dlength.z;
     // 3-5: partial derivative (diag offset wrt fitness fn) fn operated on sample
-    ret[3] = -1.0f * ((sample.x + offset.x) * A)/length;
-    ret[4] = -1.0f * ((sample.y + offset.y) * B)/length;
-    ret[5] = -1.0f * ((sample.z + offset.z) * C)/length;
+    ret[3] = -(v.x * c.x) * inv_length;
+    ret[4] = -(v.y * c.y) * inv_length;
+    ret[5] = -(v.z * c.z) * inv_length;
     // 6-8: partial derivative (off-diag offset wrt fitness fn) fn operated on sample
-    ret[6] = -1.0f * (((sample.y + offset.y) * A) + ((sample.x + offset.x) * B))/length;
-    ret[7] = -1.0f * (((sample.z + offset.z) * A) + ((sample.x + offset.x) * C))/length;
-    ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
+    ret[6] = -((v.y * c.x) + (v.x * c.y)) * inv_length;
+    ret[7] = -((v.z * c.x) + (v.x * c.z)) * inv_length;
+    ret[8] = -((v.z * c.y) + (v.y * c.z)) * inv_length;
+
+    return params.radius - length;
 }
 
 void CompassCalibrator::run_ellipsoid_fit()
@@ -749,55 +785,55 @@ void CompassCalibrator::run_ellipsoid_fit()
     param_t fit1_params, fit2_params;
     fit1_params = fit2_params = _params;
 
-    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+    // JTJ is symmetric so only its lower triangle is accumulated
+    MatrixN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> JTJ;
+    VectorN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> JTFI;
 
-    // Gauss Newton Part common for all kind of extensions including LM
+    // Gauss Newton Part common for all kind of extensions including LM.
+    // The residual and jacobian of each sample come from a single pass
+    const Matrix3f softiron = fit1_params.get_softiron();
     for (uint16_t k = 0; k<_samples_collected; k++) {
         Vector3f sample = _sample_buffer[k].get();
 
-        float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        VectorN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> ellipsoid_jacob;
 
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
+        const float residual = calc_ellipsoid_jacob(sample, fit1_params, softiron, &ellipsoid_jacob[0]);
 
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-            }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
-        }
+        // compute JTJ
+        JTJ.add_outer_lower(ellipsoid_jacob);
+        // compute JTFI
+        JTFI += ellipsoid_jacob * residual;
     }
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
+    // solve the damped normal equations for both candidate lambdas
+    // with a Cholesky factorisation rather than forming inverses
+    VectorN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> step1, step2;
+    MatrixN<float,COMPASS_CAL_NUM_ELLIPSOID_PARAMS> JTJ_damped = JTJ;
     for (uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda/lma_damping;
+        JTJ_damped(i, i) += _ellipsoid_lambda;
     }
-
-    if (!mat_inverse(JTJ, JTJ, 9)) {
+    if (!JTJ_damped.solve_spd(JTFI, step1)) {
         return;
     }
 
-    if (!mat_inverse(JTJ2, JTJ2, 9)) {
+    JTJ_damped = JTJ;
+    for (uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
+        JTJ_damped(i, i) += _ellipsoid_lambda/lma_damping;
+    }
+    if (!JTJ_damped.solve_spd(JTFI, step2)) {
         return;
     }
 
     // extract radius, offset, diagonals and offdiagonal parameters
     for (uint8_t row=0; row < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; row++) {
-        for (uint8_t col=0; col < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; col++) {
-            fit1_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
-            fit2_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
-        }
+        fit1_params.get_ellipsoid_params()[row] -= step1[row];
+        fit2_params.get_ellipsoid_params()[row] -= step2[row];
     }
 
     // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
+    calc_mean_squared_residuals(fit1_params, fit2_params, fit1, fit2);
 
     // decide which of the two sets of parameters is best and store in fit1_params
     if (fit1 > _fitness && fit2 > _fitness) {
@@ -34,6 +34,11 @@ public:
     // update the state machine and calculate offsets, diagonals and offdiagonals
     void update();
 
+#if COMPASS_CAL_THREAD_PER_COMPASS
+    // start a thread that calls update() for this calibrator only
+    bool start_thread();
+#endif
+
     // compass calibration states
     enum class Status {
         NOT_STARTED = 0,
@@ -115,6 +120,9 @@ private:
             return &offset.x;
         }
 
+        // symmetric soft iron correction matrix
+        Matrix3f get_softiron() const;
+
         float radius;       // magnetic field strength calculated from samples
         Vector3f offset;    // offsets
         Vector3f diag;      // diagonal scaling
@@ -170,22 +178,21 @@ private:
     // thins out samples between step one and step two
     void thin_samples();
 
-    // calc the fitness of a single sample vs a set of parameters (offsets, diagonals, off diagonals)
-    float calc_residual(const Vector3f& sample, const param_t& params) const;
-
     // calc the fitness of the parameters (offsets, diagonals, off diagonals) vs all the samples collected
     // returns 1.0e30f if the sample buffer is empty
     float calc_mean_squared_residuals(const param_t& params) const;
+    void calc_mean_squared_residuals(const param_t& params1, const param_t& params2, float &fit1, float &fit2) const;
 
     // calculate initial offsets by simply taking the average values of the samples
     void calc_initial_offset();
 
-    // run sphere fit to calculate diagonals and offdiagonals
-    void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
+    // run sphere fit to calculate diagonals and offdiagonals. The
+    // jacobian functions return the residual of the sample
+    float calc_sphere_jacob(const Vector3f& sample, const param_t& params, const Matrix3f& softiron, float* ret) const;
     void run_sphere_fit();
 
     // run ellipsoid fit to calculate diagonals and offdiagonals
-    void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
+    float calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, const Matrix3f& softiron, float* ret) const;
     void run_ellipsoid_fit();
 
     // update the completion mask based on a single sample
@@ -209,6 +216,11 @@ private:
     // running method for use in thread
     bool _running() const;
 
+#if COMPASS_CAL_THREAD_PER_COMPASS
+    void thread_main();
+    bool _thread_started;
+#endif
+
     uint8_t _compass_idx;                   // index of the compass providing data
     Status _status;                         // current state of calibrator
 
@@ -14,6 +14,7 @@
 #include <AP_Arming/AP_Arming.h>
 #include <AP_Vehicle/AP_Vehicle.h>
 #include <AP_ExternalControl/AP_ExternalControl_config.h>
+#include <AP_Common/ExpandingString.h>
 
 #include "ardupilot_msgs/srv/ArmMotors.h"
 #include "ardupilot_msgs/srv/ModeSwitch.h"
@@ -30,16 +31,18 @@
 
 // Enable DDS at runtime by default
 static constexpr uint8_t ENABLED_BY_DEFAULT = 1;
-static constexpr uint16_t DELAY_TIME_TOPIC_MS = 10;
-static constexpr uint16_t DELAY_BATTERY_STATE_TOPIC_MS = 1000;
-static constexpr uint16_t DELAY_IMU_TOPIC_MS = 5;
-static constexpr uint16_t DELAY_LOCAL_POSE_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_LOCAL_VELOCITY_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_GEO_POSE_TOPIC_MS = 33;
-static constexpr uint16_t DELAY_CLOCK_TOPIC_MS = 10;
-static constexpr uint16_t DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS = 1000;
+static constexpr uint16_t RATE_TIME_TOPIC_HZ = 100;
+static constexpr uint16_t RATE_BATTERY_STATE_TOPIC_HZ = 1;
+static constexpr uint16_t RATE_IMU_TOPIC_HZ = 200;
+static constexpr uint16_t RATE_LOCAL_POSE_TOPIC_HZ = 30;
+static constexpr uint16_t RATE_LOCAL_VELOCITY_TOPIC_HZ = 30;
+static constexpr uint16_t RATE_GEO_POSE_TOPIC_HZ = 30;
+static constexpr uint16_t RATE_CLOCK_TOPIC_HZ = 100;
+static constexpr uint16_t RATE_GPS_GLOBAL_ORIGIN_TOPIC_HZ = 1;
 static constexpr uint16_t DELAY_PING_MS = 500;
 
+AP_DDS_Client *AP_DDS_Client::_singleton;
+
 // Define the subscriber data members, which are static class scope.
 // If these are created on the stack in the subscriber,
 // the AP_DDS_Client::on_topic frame size is exceeded.
@@ -74,6 +77,93 @@ const AP_Param::GroupInfo AP_DDS_Client::var_info[] {
 
 #endif
 
+    // @Param: _RATE_TIME
+    // @DisplayName: DDS time topic rate
+    // @Description: Publishing rate of the time topic. Zero disables the topic
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_TIME", 4, AP_DDS_Client, rates.time, RATE_TIME_TOPIC_HZ),
+
+    // @Param: _RATE_BATT
+    // @DisplayName: DDS battery state topic rate
+    // @Description: Publishing rate of the battery state topic. Zero disables the topic
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_BATT", 5, AP_DDS_Client, rates.battery_state, RATE_BATTERY_STATE_TOPIC_HZ),
+
+    // @Param: _RATE_IMU
+    // @DisplayName: DDS IMU topic rate
+    // @Description: Publishing rate of the IMU topic. Zero disables the topic
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_IMU", 6, AP_DDS_Client, rates.imu, RATE_IMU_TOPIC_HZ),
+
+    // @Param: _RATE_POSE
+    // @DisplayName: DDS local pose topic rate
+    // @Description: Publishing rate of the local pose topic. Zero disables the topic
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_POSE", 7, AP_DDS_Client, rates.local_pose, RATE_LOCAL_POSE_TOPIC_HZ),
+
+    // @Param: _RATE_VEL
+    // @DisplayName: DDS local velocity topic rate
+    // @Description: Publishing rate of the local velocity topic. Zero disables the topic
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_VEL", 8, AP_DDS_Client, rates.local_velocity, RATE_LOCAL_VELOCITY_TOPIC_HZ),
+
+    // @Param: _RATE_GEOPOSE
+    // @DisplayName: DDS geo pose topic rate
+    // @Description: Publishing rate of the geo pose topic. Zero disables the topic
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_GEOPOSE", 9, AP_DDS_Client, rates.geo_pose, RATE_GEO_POSE_TOPIC_HZ),
+
+    // @Param: _RATE_CLOCK
+    // @DisplayName: DDS clock topic rate
+    // @Description: Publishing rate of the clock topic. Zero disables the topic
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_CLOCK", 10, AP_DDS_Client, rates.clock, RATE_CLOCK_TOPIC_HZ),
+
+    // @Param: _RATE_ORIGIN
+    // @DisplayName: DDS GPS global origin topic rate
+    // @Description: Publishing rate of the GPS global origin topic. Zero disables the topic
+    // @Units: Hz
+    // @Range: 0 1000
+    // @User: Advanced
+    AP_GROUPINFO("_RATE_ORIGIN", 11, AP_DDS_Client, rates.gps_global_origin, RATE_GPS_GLOBAL_ORIGIN_TOPIC_HZ),
+
+    // @Param: _PUB_MASK
+    // @DisplayName: DDS published topics
+    // @Description: Topics to publish
+    // @Bitmask: 0:Time,1:NavSatFix,2:StaticTransforms,3:BatteryState,4:IMU,5:LocalPose,6:LocalVelocity,7:GeoPose,8:Clock,9:GPSGlobalOrigin
+    // @User: Advanced
+    AP_GROUPINFO("_PUB_MASK", 12, AP_DDS_Client, pub_mask, -1),
+
+    // @Param: _RELIABLE
+    // @DisplayName: DDS reliable topics
+    // @Description: Topics to publish with reliable delivery. Other topics are sent best effort, which avoids retransmissions and acknowledgements on constrained links. -1 uses the default for each topic
+    // @Bitmask: 0:Time,1:NavSatFix,2:StaticTransforms,3:BatteryState,4:IMU,5:LocalPose,6:LocalVelocity,7:GeoPose,8:Clock,9:GPSGlobalOrigin
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("_RELIABLE", 13, AP_DDS_Client, reliable_mask, -1),
+
+    // @Param: _BATCH_MS
+    // @DisplayName: DDS batching time
+    // @Description: Time to collect samples before sending them together. Larger values reduce the number of transport writes, at the cost of latency on published and received topics. Zero sends samples every update
+    // @Units: ms
+    // @Range: 0 100
+    // @User: Advanced
+    AP_GROUPINFO("_BATCH_MS", 14, AP_DDS_Client, batch_ms, 0),
+
     AP_GROUPEND
 };
 
@@ -500,6 +590,8 @@ void AP_DDS_Client::update_topic(geographic_msgs_msg_GeoPointStamped& msg)
  */
 bool AP_DDS_Client::start(void)
 {
+    _singleton = this;
+
     AP_Param::setup_object_defaults(this, var_info);
     AP_Param::load_object_from_eeprom(this, var_info);
 
@@ -704,8 +796,10 @@ void AP_DDS_Client::main_loop(void)
         connected = true;
         GCS_SEND_TEXT(MAV_SEVERITY_INFO, "%s Initialization passed", msg_prefix);
 
-        populate_static_transforms(tx_static_transforms_topic);
-        write_static_transforms();
+        if (publish_enabled(to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB))) {
+            populate_static_transforms(tx_static_transforms_topic);
+            write_static_transforms();
+        }
 
         uint64_t last_ping_ms{0};
         uint8_t num_pings_missed{0};
@@ -801,6 +895,14 @@ bool AP_DDS_Client::init_session()
     reliable_in = uxr_create_input_reliable_stream(&session, input_reliable_stream, DDS_BUFFER_SIZE, DDS_STREAM_HISTORY);
     reliable_out = uxr_create_output_reliable_stream(&session, output_reliable_stream, DDS_BUFFER_SIZE, DDS_STREAM_HISTORY);
 
+    // setup best effort stream buffer, holding one batch of samples
+    output_best_effort_stream = NEW_NOTHROW uint8_t[DDS_MTU];
+    if (output_best_effort_stream == nullptr) {
+        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "%s Allocation failed", msg_prefix);
+        return false;
+    }
+    best_effort_out = uxr_create_output_best_effort_stream(&session, output_best_effort_stream, DDS_MTU);
+
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "%s Init complete", msg_prefix);
 
     return true;
@@ -858,8 +960,10 @@ bool AP_DDS_Client::create()
                                     participant_id, UXR_REPLACE);
 
             // Data Writer
+            uxrQoS_t qos = topics[i].qos;
+            qos.reliability = topic_reliable(i) ? UXR_RELIABILITY_RELIABLE : UXR_RELIABILITY_BEST_EFFORT;
             const auto dwriter_req_id = uxr_buffer_create_datawriter_bin(&session, reliable_out, topics[i].dw_id,
-                                        pub_id, topic_id, topics[i].qos, UXR_REPLACE);
+                                        pub_id, topic_id, qos, UXR_REPLACE);
 
             // save the request statuses
             requests[0] = topic_req_id;
@@ -950,7 +1054,9 @@ void AP_DDS_Client::write_time_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = builtin_interfaces_msg_Time_size_of_topic(&time_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::TIME_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::TIME_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = builtin_interfaces_msg_Time_serialize_topic(&ub, &time_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -965,7 +1071,9 @@ void AP_DDS_Client::write_nav_sat_fix_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = sensor_msgs_msg_NavSatFix_size_of_topic(&nav_sat_fix_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::NAV_SAT_FIX_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::NAV_SAT_FIX_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = sensor_msgs_msg_NavSatFix_serialize_topic(&ub, &nav_sat_fix_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -980,7 +1088,9 @@ void AP_DDS_Client::write_static_transforms()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = tf2_msgs_msg_TFMessage_size_of_topic(&tx_static_transforms_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::STATIC_TRANSFORMS_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = tf2_msgs_msg_TFMessage_serialize_topic(&ub, &tx_static_transforms_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -995,7 +1105,9 @@ void AP_DDS_Client::write_battery_state_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = sensor_msgs_msg_BatteryState_size_of_topic(&battery_state_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::BATTERY_STATE_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::BATTERY_STATE_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = sensor_msgs_msg_BatteryState_serialize_topic(&ub, &battery_state_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1010,7 +1122,9 @@ void AP_DDS_Client::write_local_pose_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geometry_msgs_msg_PoseStamped_size_of_topic(&local_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_POSE_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::LOCAL_POSE_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geometry_msgs_msg_PoseStamped_serialize_topic(&ub, &local_pose_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1025,7 +1139,9 @@ void AP_DDS_Client::write_tx_local_velocity_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geometry_msgs_msg_TwistStamped_size_of_topic(&tx_local_velocity_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::LOCAL_VELOCITY_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::LOCAL_VELOCITY_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geometry_msgs_msg_TwistStamped_serialize_topic(&ub, &tx_local_velocity_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1040,7 +1156,9 @@ void AP_DDS_Client::write_imu_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = sensor_msgs_msg_Imu_size_of_topic(&imu_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::IMU_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::IMU_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = sensor_msgs_msg_Imu_serialize_topic(&ub, &imu_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1055,7 +1173,9 @@ void AP_DDS_Client::write_geo_pose_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geographic_msgs_msg_GeoPoseStamped_size_of_topic(&geo_pose_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GEOPOSE_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::GEOPOSE_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geographic_msgs_msg_GeoPoseStamped_serialize_topic(&ub, &geo_pose_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1070,7 +1190,9 @@ void AP_DDS_Client::write_clock_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = rosgraph_msgs_msg_Clock_size_of_topic(&clock_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::CLOCK_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::CLOCK_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = rosgraph_msgs_msg_Clock_serialize_topic(&ub, &clock_topic);
         if (!success) {
             // TODO sometimes serialization fails on bootup. Determine why.
@@ -1085,7 +1207,9 @@ void AP_DDS_Client::write_gps_global_origin_topic()
     if (connected) {
         ucdrBuffer ub {};
         const uint32_t topic_size = geographic_msgs_msg_GeoPointStamped_size_of_topic(&gps_global_origin_topic, 0);
-        uxr_prepare_output_stream(&session, reliable_out, topics[to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB)].dw_id, &ub, topic_size);
+        if (!prepare_output_stream(to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB), ub, topic_size)) {
+            return;
+        }
         const bool success = geographic_msgs_msg_GeoPointStamped_serialize_topic(&ub, &gps_global_origin_topic);
         if (!success) {
             // AP_HAL::panic("FATAL: DDS_Client failed to serialize\n");
@@ -1093,66 +1217,152 @@ void AP_DDS_Client::write_gps_global_origin_topic()
     }
 }
 
+/*
+  return true if a periodic topic is due to be published, and schedule
+  its next sample
+ */
+bool AP_DDS_Client::publish_due(uint8_t index, int16_t rate_hz, uint64_t now_ms)
+{
+    auto &state = pub_state[index];
+    if (rate_hz <= 0 || !publish_enabled(index)) {
+        // restart the schedule when the topic is enabled
+        state.due_ms = 0;
+        return false;
+    }
+    if (now_ms < state.due_ms) {
+        return false;
+    }
+    const uint32_t period_ms = 1000U / MIN(uint16_t(rate_hz), 1000U);
+    const uint64_t behind_ms = now_ms - state.due_ms;
+    if (state.due_ms == 0 || behind_ms >= period_ms) {
+        if (state.due_ms != 0) {
+            // whole periods were missed
+            state.dropped += behind_ms / period_ms;
+        }
+        state.due_ms = now_ms;
+    } else if (behind_ms * 2 > period_ms) {
+        state.late++;
+    }
+    state.due_ms += period_ms;
+    return true;
+}
+
+bool AP_DDS_Client::publish_enabled(uint8_t index) const
+{
+    static_assert(ARRAY_SIZE(topics) <= MAX_TOPICS, "too many DDS topics");
+    return (uint32_t(pub_mask.get()) & (1U<<index)) != 0;
+}
+
+bool AP_DDS_Client::topic_reliable(uint8_t index) const
+{
+    if (reliable_mask.get() == -1) {
+        return topics[index].qos.reliability == UXR_RELIABILITY_RELIABLE;
+    }
+    return (uint32_t(reliable_mask.get()) & (1U<<index)) != 0;
+}
+
+/*
+  reserve space in the output stream for a sample. Samples collect in
+  the stream until it is flushed, so a full best effort stream is sent
+  early to make room
+ */
+bool AP_DDS_Client::prepare_output_stream(uint8_t index, ucdrBuffer &ub, uint32_t topic_size)
+{
+    const uxrStreamId stream = topic_reliable(index) ? reliable_out : best_effort_out;
+    auto &state = pub_state[index];
+    if (uxr_prepare_output_stream(&session, stream, topics[index].dw_id, &ub, topic_size) == UXR_INVALID_REQUEST_ID) {
+        uxr_flush_output_streams(&session);
+        num_flushes++;
+        if (uxr_prepare_output_stream(&session, stream, topics[index].dw_id, &ub, topic_size) == UXR_INVALID_REQUEST_ID) {
+            state.dropped++;
+            return false;
+        }
+    }
+    state.sent++;
+    return true;
+}
+
 void AP_DDS_Client::update()
 {
     WITH_SEMAPHORE(csem);
     const auto cur_time_ms = AP_HAL::millis64();
 
-    if (cur_time_ms - last_time_time_ms > DELAY_TIME_TOPIC_MS) {
+    if (publish_due(to_underlying(TopicIndex::TIME_PUB), rates.time, cur_time_ms)) {
         update_topic(time_topic);
-        last_time_time_ms = cur_time_ms;
         write_time_topic();
     }
 
     constexpr uint8_t gps_instance = 0;
-    if (update_topic(nav_sat_fix_topic, gps_instance)) {
+    if (publish_enabled(to_underlying(TopicIndex::NAV_SAT_FIX_PUB)) &&
+        update_topic(nav_sat_fix_topic, gps_instance)) {
         write_nav_sat_fix_topic();
     }
 
-    if (cur_time_ms - last_battery_state_time_ms > DELAY_BATTERY_STATE_TOPIC_MS) {
+    if (publish_due(to_underlying(TopicIndex::BATTERY_STATE_PUB), rates.battery_state, cur_time_ms)) {
         constexpr uint8_t battery_instance = 0;
         update_topic(battery_state_topic, battery_instance);
-        last_battery_state_time_ms = cur_time_ms;
         write_battery_state_topic();
     }
 
-    if (cur_time_ms - last_local_pose_time_ms > DELAY_LOCAL_POSE_TOPIC_MS) {
+    if (publish_due(to_underlying(TopicIndex::LOCAL_POSE_PUB), rates.local_pose, cur_time_ms)) {
         update_topic(local_pose_topic);
-        last_local_pose_time_ms = cur_time_ms;
         write_local_pose_topic();
     }
 
-    if (cur_time_ms - last_local_velocity_time_ms > DELAY_LOCAL_VELOCITY_TOPIC_MS) {
+    if (publish_due(to_underlying(TopicIndex::LOCAL_VELOCITY_PUB), rates.local_velocity, cur_time_ms)) {
         update_topic(tx_local_velocity_topic);
-        last_local_velocity_time_ms = cur_time_ms;
         write_tx_local_velocity_topic();
     }
 
-    if (cur_time_ms - last_imu_time_ms > DELAY_IMU_TOPIC_MS) {
+    if (publish_due(to_underlying(TopicIndex::IMU_PUB), rates.imu, cur_time_ms)) {
         update_topic(imu_topic);
-        last_imu_time_ms = cur_time_ms;
         write_imu_topic();
     }
 
-    if (cur_time_ms - last_geo_pose_time_ms > DELAY_GEO_POSE_TOPIC_MS) {
+    if (publish_due(to_underlying(TopicIndex::GEOPOSE_PUB), rates.geo_pose, cur_time_ms)) {
         update_topic(geo_pose_topic);
-        last_geo_pose_time_ms = cur_time_ms;
         write_geo_pose_topic();
     }
 
-    if (cur_time_ms - last_clock_time_ms > DELAY_CLOCK_TOPIC_MS) {
+    if (publish_due(to_underlying(TopicIndex::CLOCK_PUB), rates.clock, cur_time_ms)) {
         update_topic(clock_topic);
-        last_clock_time_ms = cur_time_ms;
         write_clock_topic();
     }
 
-    if (cur_time_ms - last_gps_global_origin_time_ms > DELAY_GPS_GLOBAL_ORIGIN_TOPIC_MS) {
+    if (publish_due(to_underlying(TopicIndex::GPS_GLOBAL_ORIGIN_PUB), rates.gps_global_origin, cur_time_ms)) {
         update_topic(gps_global_origin_topic);
-        last_gps_global_origin_time_ms = cur_time_ms;
         write_gps_global_origin_topic();
     }
 
-    status_ok = uxr_run_session_time(&session, 1);
+    // send the batch of samples and service incoming data. Incoming
+    // data waits for the batch
+    if (cur_time_ms - last_flush_ms >= uint64_t(MAX(batch_ms.get(), 0))) {
+        last_flush_ms = cur_time_ms;
+        num_flushes++;
+        status_ok = uxr_run_session_time(&session, 1);
+    }
+}
+
+/*
+  write per-topic publishing statistics
+ */
+void AP_DDS_Client::stats_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(csem);
+    str.printf("connected=%u flushes=%u\n", unsigned(connected), unsigned(num_flushes));
+    for (uint8_t i = 0; i < ARRAY_SIZE(topics); i++) {
+        if (topics[i].topic_rw != Topic_rw::DataWriter) {
+            continue;
+        }
+        const auto &state = pub_state[i];
+        str.printf("%-28s %s %s sent=%u dropped=%u late=%u\n",
+                   topics[i].topic_name,
+                   publish_enabled(i) ? "ON " : "OFF",
+                   topic_reliable(i) ? "RELIABLE   " : "BEST_EFFORT",
+                   unsigned(state.sent),
+                   unsigned(state.dropped),
+                   unsigned(state.late));
+    }
 }
 
 #if CONFIG_HAL_BOARD != HAL_BOARD_SITL
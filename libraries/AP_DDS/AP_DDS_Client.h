@@ -41,6 +41,8 @@
 
 extern const AP_HAL::HAL& hal;
 
+class ExpandingString;
+
 class AP_DDS_Client
 {
 
@@ -48,6 +50,26 @@ private:
 
     AP_Int8 enabled;
 
+    // publishing rates in Hz, zero disables the topic
+    struct {
+        AP_Int16 time;
+        AP_Int16 battery_state;
+        AP_Int16 imu;
+        AP_Int16 local_pose;
+        AP_Int16 local_velocity;
+        AP_Int16 geo_pose;
+        AP_Int16 clock;
+        AP_Int16 gps_global_origin;
+    } rates;
+    // bitmask of published topics
+    AP_Int32 pub_mask;
+    // bitmask of topics published reliably, -1 for the topic defaults
+    AP_Int32 reliable_mask;
+    // time to collect samples before sending them together
+    AP_Int16 batch_ms;
+
+    static AP_DDS_Client *_singleton;
+
     // Serial Allocation
     uxrSession session; //Session
     bool is_using_serial; // true when using serial transport
@@ -57,6 +79,9 @@ private:
     uint8_t *output_reliable_stream;
     uxrStreamId reliable_in;
     uxrStreamId reliable_out;
+    // output stream for best effort topics
+    uint8_t *output_best_effort_stream;
+    uxrStreamId best_effort_out;
 
     // Outgoing Sensor and AHRS data
     builtin_interfaces_msg_Time time_topic;
@@ -112,24 +137,30 @@ private:
         .min_pace_period = 0
     };
 
-    // The last ms timestamp AP_DDS wrote a Time message
-    uint64_t last_time_time_ms;
-    // The last ms timestamp AP_DDS wrote a NavSatFix message
+    // The last GPS fix time AP_DDS wrote a NavSatFix message for
     uint64_t last_nav_sat_fix_time_ms;
-    // The last ms timestamp AP_DDS wrote a BatteryState message
-    uint64_t last_battery_state_time_ms;
-    // The last ms timestamp AP_DDS wrote an IMU message
-    uint64_t last_imu_time_ms;
-    // The last ms timestamp AP_DDS wrote a Local Pose message
-    uint64_t last_local_pose_time_ms;
-    // The last ms timestamp AP_DDS wrote a Local Velocity message
-    uint64_t last_local_velocity_time_ms;
-    // The last ms timestamp AP_DDS wrote a GeoPose message
-    uint64_t last_geo_pose_time_ms;
-    // The last ms timestamp AP_DDS wrote a Clock message
-    uint64_t last_clock_time_ms;
-    // The last ms timestamp AP_DDS wrote a gps global origin message
-    uint64_t last_gps_global_origin_time_ms;
+
+    // publishing schedule and statistics for each topic
+    static constexpr uint8_t MAX_TOPICS = 16;
+    struct {
+        uint64_t due_ms;    // time the next sample is due
+        uint32_t sent;      // samples queued for sending
+        uint32_t dropped;   // samples not sent for lack of stream space or time
+        uint32_t late;      // samples sent over half a period late
+    } pub_state[MAX_TOPICS];
+    // The last ms timestamp AP_DDS sent a batch of samples
+    uint64_t last_flush_ms;
+    uint32_t num_flushes;
+
+    //! @brief Return true if the periodic topic at index should be published now
+    bool publish_due(uint8_t index, int16_t rate_hz, uint64_t now_ms);
+    //! @brief Return true if the topic at index is enabled in DDS_PUB_MASK
+    bool publish_enabled(uint8_t index) const;
+    //! @brief Return true if the topic at index is published on the reliable stream
+    bool topic_reliable(uint8_t index) const;
+    //! @brief Reserve space for a sample of the topic at index in its output stream
+    //! @return False if the sample was dropped
+    bool prepare_output_stream(uint8_t index, ucdrBuffer &ub, uint32_t topic_size) WARN_IF_UNUSED;
 
     // functions for serial transport
     bool ddsSerialInit();
@@ -168,6 +199,10 @@ private:
 public:
     ~AP_DDS_Client();
 
+    static AP_DDS_Client *get_singleton() {
+        return _singleton;
+    }
+
     bool start(void);
     void main_loop(void);
 
@@ -207,6 +242,9 @@ public:
     //! @brief Update the internally stored DDS messages with latest data
     void update();
 
+    //! @brief Write per-topic publishing statistics for @SYS/dds_stats.txt
+    void stats_info(ExpandingString &str);
+
     //! @brief GCS message prefix
     static constexpr const char* msg_prefix = "DDS:";
 
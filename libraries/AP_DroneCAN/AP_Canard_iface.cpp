@@ -15,6 +15,18 @@ extern const AP_HAL::HAL& hal;
 
 #define CANARD_MSG_TYPE_FROM_ID(x)                         ((uint16_t)(((x) >> 8U)  & 0xFFFFU))
 
+// end of transfer flag in the tail byte of a frame
+#define CANARD_TAIL_END_OF_TRANSFER 0x40U
+
+/*
+  length of a frame on the bus in bits, without stuffing bits
+ */
+static uint32_t frame_bits(const AP_HAL::CANFrame &frame)
+{
+    const uint32_t overhead = frame.isExtended() ? 67 : 47;
+    return overhead + 8U * AP_HAL::CANFrame::dlcToDataLength(frame.dlc);
+}
+
 DEFINE_HANDLER_LIST_HEADS();
 DEFINE_HANDLER_LIST_SEMAPHORES();
 
@@ -264,6 +276,14 @@ void CanardInterface::processTx(bool raw_commands_only = false) {
                 // try sending to interfaces, clearing the mask if we succeed
                 if (ifaces[iface]->send(txmsg, txf->deadline_usec, 0) > 0) {
                     txf->iface_mask &= ~(1U<<iface);
+                    bus_bits[iface] += frame_bits(txmsg);
+                    const uint16_t type = CANARD_MSG_TYPE_FROM_ID(txf->id);
+                    if ((type == UAVCAN_EQUIPMENT_ESC_RAWCOMMAND_ID || type == COM_HOBBYWING_ESC_RAWCOMMAND_ID) &&
+                        txf->data_len > 0 &&
+                        (txf->data[txf->data_len-1] & CANARD_TAIL_END_OF_TRANSFER) != 0) {
+                        esc_tx_count++;
+                        esc_tx_us = AP_HAL::micros();
+                    }
                 } else {
                     // if we fail to send then we try sending on next interface
                     if (!iface_down) {
@@ -347,6 +367,10 @@ void CanardInterface::processRx() {
             if (ifaces[i]->receive(rxmsg, timestamp, flags) <= 0) {
                 break;
             }
+            {
+                WITH_SEMAPHORE(_sem_tx);
+                bus_bits[i] += frame_bits(rxmsg);
+            }
 
             if (!rxmsg.isExtended()) {
                 // 11 bit frame, see if we have a handler
@@ -401,6 +425,7 @@ void CanardInterface::process(uint32_t duration_ms) {
     while (true) {
         processRx();
         processTx();
+        update_bus_load();
         {
             WITH_SEMAPHORE(_sem_rx);
             WITH_SEMAPHORE(_sem_tx);
@@ -416,6 +441,33 @@ void CanardInterface::process(uint32_t duration_ms) {
 #endif
 }
 
+/*
+  estimate the utilisation of each bus from the frames we sent and
+  received. Stuffing bits are not counted, so this is a lower bound
+ */
+void CanardInterface::update_bus_load()
+{
+    const uint32_t now_us = AP_HAL::micros();
+    const uint32_t dt_us = now_us - bus_load_update_us;
+    if (dt_us < AP_DRONECAN_BUS_LOAD_PERIOD_US) {
+        return;
+    }
+    bus_load_update_us = now_us;
+
+    WITH_SEMAPHORE(_sem_tx);
+    int8_t load_pct = -1;
+    for (uint8_t i = 0; i < num_ifaces; i++) {
+        const uint32_t bitrate = ifaces[i] != nullptr ? ifaces[i]->get_bitrate() : 0;
+        if (bitrate != 0) {
+            const uint64_t capacity = uint64_t(bitrate) * dt_us / 1000000U;
+            const uint32_t pct = MIN(uint64_t(bus_bits[i]) * 100U / MAX(capacity, uint64_t(1)), uint64_t(100));
+            load_pct = MAX(load_pct, int8_t(pct));
+        }
+        bus_bits[i] = 0;
+    }
+    bus_load_pct = load_pct;
+}
+
 bool CanardInterface::add_interface(AP_HAL::CANIface *can_iface)
 {
     if (num_ifaces > HAL_NUM_CAN_IFACES) {
@@ -4,6 +4,11 @@
 #include <canard/interface.h>
 #include <dronecan_msgs.h>
 
+// period over which bus load is measured
+#ifndef AP_DRONECAN_BUS_LOAD_PERIOD_US
+#define AP_DRONECAN_BUS_LOAD_PERIOD_US 250000U
+#endif
+
 class AP_DroneCAN;
 class CANSensor;
 
@@ -64,6 +69,19 @@ public:
     void update_rx_protocol_stats(int16_t res);
 
     uint8_t get_node_id() const override { return canard.node_id; }
+
+    // update the bus load estimate, called from process()
+    void update_bus_load();
+
+    // highest utilisation of the interfaces over the last
+    // measurement period in percent, or -1 if unknown
+    int8_t get_bus_load_pct() const { return bus_load_pct; }
+
+    // number of ESC command transfers completely handed to an
+    // interface, and the time in microseconds of the last one
+    uint32_t get_esc_tx_count() const { return esc_tx_count; }
+    uint32_t get_esc_tx_us() const { return esc_tx_us; }
+
 private:
     CanardInstance canard;
     AP_HAL::CANIface* ifaces[HAL_NUM_CAN_IFACES];
@@ -79,6 +97,14 @@ private:
     CanardTxTransfer tx_transfer;
     dronecan_protocol_Stats protocol_stats;
 
+    // bits seen on each bus since the last load update
+    uint32_t bus_bits[HAL_NUM_CAN_IFACES];
+    uint32_t bus_load_update_us;
+    int8_t bus_load_pct = -1;
+
+    uint32_t esc_tx_count;
+    uint32_t esc_tx_us;
+
     // auxillary 11 bit CANSensor
     CANSensor *aux_11bit_driver;
 };
@@ -47,6 +47,7 @@
 #include "AP_DroneCAN_DNA_Server.h"
 #include <AP_Logger/AP_Logger.h>
 #include <AP_Notify/AP_Notify.h>
+#include <AP_Common/ExpandingString.h>
 #include <AP_OpenDroneID/AP_OpenDroneID.h>
 #include <AP_Mount/AP_Mount_Xacti.h>
 #include <string.h>
@@ -128,7 +129,7 @@ const AP_Param::GroupInfo AP_DroneCAN::var_info[] = {
     // @Param: OPTION
     // @DisplayName: DroneCAN options
     // @Description: Option flags
-    // @Bitmask: 0:ClearDNADatabase,1:IgnoreDNANodeConflicts,2:EnableCanfd,3:IgnoreDNANodeUnhealthy,4:SendServoAsPWM,5:SendGNSS,6:UseHimarkServo,7:HobbyWingESC,8:EnableStats
+    // @Bitmask: 0:ClearDNADatabase,1:IgnoreDNANodeConflicts,2:EnableCanfd,3:IgnoreDNANodeUnhealthy,4:SendServoAsPWM,5:SendGNSS,6:UseHimarkServo,7:HobbyWingESC,8:EnableStats,9:CoalesceOutputs
     // @User: Advanced
     AP_GROUPINFO("OPTION", 5, AP_DroneCAN, _options, 0),
     
@@ -171,6 +172,22 @@ const AP_Param::GroupInfo AP_DroneCAN::var_info[] = {
     AP_GROUPINFO("RLY_RT", 23, AP_DroneCAN, _relay.rate_hz, 0),
 #endif
 
+    // @Param: OUT_RF
+    // @DisplayName: Unchanged output refresh rate
+    // @Description: With the CoalesceOutputs option set, servo outputs that have not changed are only resent at this rate. Changed outputs are sent at the normal rate. ESC commands are always sent at the normal rate
+    // @Range: 1 200
+    // @Units: Hz
+    // @User: Advanced
+    AP_GROUPINFO("OUT_RF", 24, AP_DroneCAN, _output_refresh_hz, 20),
+
+    // @Param: BUS_LD
+    // @DisplayName: Bus load limit
+    // @Description: CAN bus utilisation above which servo outputs are sent at a reduced rate, so that ESC commands keep their full rate. Zero disables the rate reduction
+    // @Range: 0 100
+    // @Units: %
+    // @User: Advanced
+    AP_GROUPINFO("BUS_LD", 25, AP_DroneCAN, _bus_load_max, 70),
+
 #if AP_DRONECAN_SERIAL_ENABLED
     /*
       due to the parameter tree depth limitation we can't use a sub-table for the serial parameters
@@ -537,10 +554,16 @@ void AP_DroneCAN::loop(void)
 #if AP_DRONECAN_HOBBYWING_ESC_SUPPORT
         hobbywing_ESC_update();
 #endif
+        update_output_rate();
+        {
+            WITH_SEMAPHORE(SRV_sem);
+            update_esc_latency();
+        }
+
         if (_SRV_armed_mask != 0) {
             // we have active servos
             uint32_t now = AP_HAL::micros();
-            const uint32_t servo_period_us = 1000000UL / unsigned(_servo_rate_hz.get());
+            const uint32_t servo_period_us = 1000000UL / unsigned(_servo_rate_hz.get()) * _SRV_rate_div;
             if (now - _SRV_last_send_us >= servo_period_us) {
                 _SRV_last_send_us = now;
 #if AP_DRONECAN_HIMARK_SERVO_SUPPORT
@@ -623,6 +646,11 @@ void AP_DroneCAN::handle_hobbywing_StatusMsg1(const CanardRxTransfer& transfer,
     uint8_t esc_index;
     if (hobbywing_find_esc_index(transfer.source_node_id, esc_index)) {
         update_rpm(esc_index, msg.rpm);
+        if (esc_index < DRONECAN_SRV_NUMBER) {
+            WITH_SEMAPHORE(SRV_sem);
+            _esc_stats.esc[esc_index].node_id = transfer.source_node_id;
+            _esc_stats.esc[esc_index].telem_count++;
+        }
     }
 }
 
@@ -726,9 +754,18 @@ void AP_DroneCAN::SRV_send_actuator(void)
 
     WITH_SEMAPHORE(SRV_sem);
 
+    // with coalescing, unchanged outputs are only sent at the refresh rate
+    const uint32_t now_us = AP_HAL::micros();
+    const bool refresh = !option_is_set(Options::COALESCE_OUTPUTS) ||
+                         now_us - _SRV_last_refresh_us >= output_refresh_period_us();
+    if (refresh) {
+        _SRV_last_refresh_us = now_us;
+    }
+
     do {
         repeat_send = false;
         uavcan_equipment_actuator_ArrayCommand msg;
+        uint8_t servos[15];
 
         uint8_t i;
         // DroneCAN can hold maximum of 15 commands in one frame
@@ -744,7 +781,8 @@ void AP_DroneCAN::SRV_send_actuator(void)
              * physically possible throws at [-1:1] limits.
              */
 
-            if (_SRV_conf[starting_servo].servo_pending && ((((uint32_t) 1) << starting_servo) & _SRV_armed_mask)) {
+            if (_SRV_conf[starting_servo].servo_pending && ((((uint32_t) 1) << starting_servo) & _SRV_armed_mask) &&
+                (refresh || _SRV_conf[starting_servo].pulse != _SRV_conf[starting_servo].servo_sent_pulse)) {
                 cmd.actuator_id = starting_servo + 1;
 
                 if (option_is_set(Options::USE_ACTUATOR_PWM)) {
@@ -756,6 +794,7 @@ void AP_DroneCAN::SRV_send_actuator(void)
                 }
 
                 msg.commands.data[i] = cmd;
+                servos[i] = starting_servo;
 
                 i++;
             }
@@ -764,6 +803,9 @@ void AP_DroneCAN::SRV_send_actuator(void)
         if (i > 0) {
             if (act_out_array.broadcast(msg) > 0) {
                 _srv_send_count++;
+                for (uint8_t j = 0; j < i; j++) {
+                    _SRV_conf[servos[j]].servo_sent_pulse = _SRV_conf[servos[j]].pulse;
+                }
             } else {
                 _fail_send_count++;
             }
@@ -844,13 +886,29 @@ void AP_DroneCAN::SRV_send_esc(void)
         }
         esc_msg.cmd.len = k;
 
+        /*
+          ESC commands are never coalesced, many ESCs stop the motor
+          when commands arrive more slowly than their timeout
+         */
         if (esc_raw.broadcast(esc_msg)) {
+            const uint32_t now_us = AP_HAL::micros();
             _esc_send_count++;
+            for (uint8_t i = esc_offset; i < max_esc_num; i++) {
+                if ((((uint32_t) 1) << i) & _ESC_armed_mask) {
+                    _esc_stats.esc[i].cmd_count++;
+                }
+            }
+            if (!_esc_stats.latency_pending) {
+                _esc_stats.push_us = now_us;
+                _esc_stats.tx_count = canard_iface.get_esc_tx_count();
+                _esc_stats.latency_pending = true;
+            }
         } else {
             _fail_send_count++;
         }
         // immediately push data to CAN bus
         canard_iface.processTx(true);
+        update_esc_latency();
     }
 
     for (uint8_t i = 0; i < DRONECAN_SRV_NUMBER; i++) {
@@ -858,6 +916,57 @@ void AP_DroneCAN::SRV_send_esc(void)
     }
 }
 
+/*
+  record the time from sending an ESC command to the interface
+  taking its last frame
+ */
+void AP_DroneCAN::update_esc_latency(void)
+{
+    if (!_esc_stats.latency_pending ||
+        canard_iface.get_esc_tx_count() == _esc_stats.tx_count) {
+        return;
+    }
+    const uint32_t latency_us = canard_iface.get_esc_tx_us() - _esc_stats.push_us;
+    _esc_stats.latency_sum_us += latency_us;
+    _esc_stats.latency_max_us = MAX(_esc_stats.latency_max_us, latency_us);
+    _esc_stats.latency_count++;
+    _esc_stats.latency_pending = false;
+}
+
+uint32_t AP_DroneCAN::output_refresh_period_us(void) const
+{
+    return 1000000UL / unsigned(MAX(_output_refresh_hz.get(), 1));
+}
+
+/*
+  halve the servo output rate while the bus load is above the limit,
+  down to 1/AP_DRONECAN_SRV_RATE_DIV_MAX of the configured rate, and
+  double it again once the load has dropped. ESC commands are never
+  slowed
+ */
+void AP_DroneCAN::update_output_rate(void)
+{
+    const uint32_t now_us = AP_HAL::micros();
+    if (now_us - _SRV_rate_update_us < AP_DRONECAN_BUS_LOAD_PERIOD_US) {
+        return;
+    }
+    _SRV_rate_update_us = now_us;
+
+    const int8_t load_pct = canard_iface.get_bus_load_pct();
+    const int8_t load_max = _bus_load_max.get();
+    if (load_pct < 0 || load_max <= 0) {
+        _SRV_rate_div = 1;
+        return;
+    }
+    if (load_pct > load_max) {
+        if (_SRV_rate_div < AP_DRONECAN_SRV_RATE_DIV_MAX) {
+            _SRV_rate_div *= 2;
+        }
+    } else if (load_pct + AP_DRONECAN_BUS_LOAD_HYST_PCT < load_max && _SRV_rate_div > 1) {
+        _SRV_rate_div /= 2;
+    }
+}
+
 #if AP_DRONECAN_HOBBYWING_ESC_SUPPORT
 /*
   support for Hobbywing DroneCAN ESCs
@@ -899,6 +1008,11 @@ void AP_DroneCAN::SRV_send_esc_hobbywing(void)
 
         if (esc_hobbywing_raw.broadcast(esc_msg)) {
             _esc_send_count++;
+            for (uint8_t i = esc_offset; i < max_esc_num; i++) {
+                if ((((uint32_t) 1) << i) & _ESC_armed_mask) {
+                    _esc_stats.esc[i].cmd_count++;
+                }
+            }
         } else {
             _fail_send_count++;
         }
@@ -1434,6 +1548,12 @@ void AP_DroneCAN::handle_ESC_status(const CanardRxTransfer& transfer, const uavc
         return;
     }
 
+    if (esc_index < DRONECAN_SRV_NUMBER) {
+        WITH_SEMAPHORE(SRV_sem);
+        _esc_stats.esc[esc_index].node_id = transfer.source_node_id;
+        _esc_stats.esc[esc_index].telem_count++;
+    }
+
     TelemetryData t {
         .temperature_cdeg = int16_t((KELVIN_TO_C(msg.temperature)) * 100),
         .voltage = msg.voltage,
@@ -1846,6 +1966,45 @@ void AP_DroneCAN::logging(void)
 #endif // HAL_LOGGING_ENABLED
 }
 
+/*
+  write bus load, output rates and per ESC statistics since the last
+  call. ESC commands are broadcast, so the latency is shared by all
+  ESCs and is the time from a command being sent to the interface
+  taking its last frame
+ */
+void AP_DroneCAN::get_stats(ExpandingString &str)
+{
+    WITH_SEMAPHORE(SRV_sem);
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = MAX(now_ms - _esc_stats.last_info_ms, 1U);
+    _esc_stats.last_info_ms = now_ms;
+
+    str.printf("bus_load: %d%%\n", int(canard_iface.get_bus_load_pct()));
+    str.printf("servo_rate: %uHz\n", unsigned(_servo_rate_hz.get()) / _SRV_rate_div);
+    str.printf("esc_sent: %u send_fail: %u\n",
+               unsigned(_esc_send_count), unsigned(_fail_send_count));
+    str.printf("esc_latency_us: avg %u max %u\n",
+               unsigned(_esc_stats.latency_count > 0 ? _esc_stats.latency_sum_us / _esc_stats.latency_count : 0),
+               unsigned(_esc_stats.latency_max_us));
+    _esc_stats.latency_sum_us = 0;
+    _esc_stats.latency_max_us = 0;
+    _esc_stats.latency_count = 0;
+
+    str.printf("ESC Node CmdHz TelemHz\n");
+    for (uint8_t i = 0; i < DRONECAN_SRV_NUMBER; i++) {
+        auto &esc = _esc_stats.esc[i];
+        if (((((uint32_t) 1) << i) & uint32_t(_esc_bm.get())) || esc.node_id != 0) {
+            str.printf("%-3u %-4u %-5u %u\n",
+                       unsigned(i+1),
+                       unsigned(esc.node_id),
+                       unsigned(uint64_t(esc.cmd_count) * 1000U / dt_ms),
+                       unsigned(uint64_t(esc.telem_count) * 1000U / dt_ms));
+        }
+        esc.cmd_count = 0;
+        esc.telem_count = 0;
+    }
+}
+
 // add an 11 bit auxillary driver
 bool AP_DroneCAN::add_11bit_driver(CANSensor *sensor)
 {
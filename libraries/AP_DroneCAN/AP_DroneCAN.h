@@ -68,6 +68,16 @@
 #include "AP_DroneCAN_serial.h"
 #endif
 
+// largest reduction of the servo output rate under bus load
+#ifndef AP_DRONECAN_SRV_RATE_DIV_MAX
+#define AP_DRONECAN_SRV_RATE_DIV_MAX 8
+#endif
+
+// bus load below the limit before the servo output rate is raised again
+#ifndef AP_DRONECAN_BUS_LOAD_HYST_PCT
+#define AP_DRONECAN_BUS_LOAD_HYST_PCT 10
+#endif
+
 // fwd-declare callback classes
 class AP_DroneCAN_DNA_Server;
 class CANSensor;
@@ -108,6 +118,10 @@ public:
     ///// SRV output /////
     void SRV_push_servos(void);
 
+    // write bus load, output rate and per ESC statistics since the
+    // last call, available as @SYS/dronecanN_stats.txt
+    void get_stats(ExpandingString &str);
+
     ///// LED /////
     bool led_write(uint8_t led_index, uint8_t red, uint8_t green, uint8_t blue);
 
@@ -144,6 +158,7 @@ public:
         USE_HIMARK_SERVO          = (1U<<6),
         USE_HOBBYWING_ESC         = (1U<<7),
         ENABLE_STATS              = (1U<<8),
+        COALESCE_OUTPUTS          = (1U<<9),
     };
 
     // check if a option is set
@@ -185,6 +200,15 @@ private:
     //scale servo output appropriately before sending
     int16_t scale_esc_output(uint8_t idx);
 
+    // adjust the servo output rate to the bus load
+    void update_output_rate();
+
+    // period at which unchanged outputs are resent when coalescing
+    uint32_t output_refresh_period_us() const;
+
+    // record the latency of the pending ESC command once it is sent
+    void update_esc_latency();
+
     // SafetyState
     void safety_state_send();
 
@@ -228,6 +252,8 @@ private:
     AP_Int16 _notify_state_hz;
     AP_Int16 _pool_size;
     AP_Int32 _esc_rv;
+    AP_Int16 _output_refresh_hz;
+    AP_Int8 _bus_load_max;
 
     uint32_t *mem_pool;
 
@@ -240,6 +266,7 @@ private:
     ///// SRV output /////
     struct {
         uint16_t pulse;
+        uint16_t servo_sent_pulse;
         bool esc_pending;
         bool servo_pending;
     } _SRV_conf[DRONECAN_SRV_NUMBER];
@@ -251,8 +278,27 @@ private:
     uint32_t _SRV_armed_mask; // mask of servo outputs that are active
     uint32_t _ESC_armed_mask; // mask of ESC outputs that are active
     uint32_t _SRV_last_send_us;
+    uint32_t _SRV_last_refresh_us;  // last time unchanged servo outputs were sent
+    uint32_t _SRV_rate_update_us;
+    uint8_t _SRV_rate_div = 1;      // servo output rate reduction for bus load
     HAL_Semaphore SRV_sem;
 
+    // ESC output statistics, reset by get_stats()
+    struct {
+        uint32_t push_us;           // time the pending command was sent
+        uint32_t tx_count;          // interface ESC transfer count at that time
+        bool latency_pending;
+        uint32_t latency_sum_us;
+        uint32_t latency_max_us;
+        uint32_t latency_count;
+        uint32_t last_info_ms;
+        struct {
+            uint32_t cmd_count;
+            uint32_t telem_count;
+            uint8_t node_id;
+        } esc[DRONECAN_SRV_NUMBER];
+    } _esc_stats;
+
     // last log time
     uint32_t last_log_ms;
 
@@ -63,6 +63,9 @@ int AP_Filesystem_Param::open(const char *fname, int flags, bool allow_absolute_
     r.count = 0;
     r.read_size = 0;
     r.file_size = 0;
+#if AP_FILESYSTEM_PARAM_CACHE_ENABLED
+    r.use_cache = false;
+#endif
     r.writebuf = nullptr;
     if (!read_only) {
         // setup for upload
@@ -338,12 +341,28 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
      */
     if (r.read_size == 0 && count > 0) {
         r.read_size = count;
+#if AP_FILESYSTEM_PARAM_CACHE_ENABLED
+        r.use_cache = cache_prepare(r);
+#endif
     }
     if (r.read_size != 0 && r.read_size != count) {
         errno = EINVAL;
         return -1;
     }
 
+#if AP_FILESYSTEM_PARAM_CACHE_ENABLED
+    if (r.use_cache) {
+        const uint32_t length = cache.data->get_length();
+        if (r.file_ofs >= length) {
+            return 0;
+        }
+        count = MIN(count, length - r.file_ofs);
+        memcpy(buf, &cache.data->get_string()[r.file_ofs], count);
+        r.file_ofs += count;
+        return count;
+    }
+#endif
+
     if (r.file_size != 0) {
         // ensure we don't try to read past EOF
         if (r.file_ofs > r.file_size) {
@@ -446,6 +465,135 @@ int32_t AP_Filesystem_Param::read(int fd, void *buf, uint32_t count)
     return total + header_total;
 }
 
+#if AP_FILESYSTEM_PARAM_CACHE_ENABLED
+/*
+  return true if any open file is being served from the cache
+ */
+bool AP_Filesystem_Param::cache_in_use(void) const
+{
+    for (uint8_t i=0; i<max_open_file; i++) {
+        if (file[i].open && file[i].use_cache) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  get the cache ready to serve a full parameter download, returning
+  false if this file should use the uncached path
+ */
+bool AP_Filesystem_Param::cache_prepare(const struct rfile &r)
+{
+    if (r.start != 0 || r.count != 0) {
+        // partial downloads are generated on demand
+        return false;
+    }
+    const bool matches = cache.data != nullptr &&
+        cache.read_size == r.read_size &&
+        cache.with_defaults == r.with_defaults;
+    if (matches && cache.save_generation == AP_Param::get_save_generation()) {
+        // nothing has been saved, but values may have been changed
+        // without a save, so pick up the current values
+        return cache_refresh_values() || (!cache_in_use() && cache_build(r));
+    }
+    if (cache_in_use()) {
+        // another download is reading the current image, don't
+        // change its layout underneath it
+        return false;
+    }
+    return cache_build(r);
+}
+
+/*
+  build the packed image for a full download
+ */
+bool AP_Filesystem_Param::cache_build(const struct rfile &r)
+{
+    if (cache.data == nullptr) {
+        cache.data = NEW_NOTHROW ExpandingString();
+        if (cache.data == nullptr) {
+            return false;
+        }
+    }
+    cache.data->reset();
+
+    // take the generation before packing so a save during the build
+    // causes a rebuild on the next download
+    cache.save_generation = AP_Param::get_save_generation();
+    cache.read_size = r.read_size;
+    cache.with_defaults = r.with_defaults;
+
+    struct header hdr;
+    hdr.total_params = AP_Param::count_parameters();
+    hdr.num_params = hdr.total_params;
+    if (r.with_defaults) {
+        hdr.magic = pmagic_with_default;
+    }
+    bool ok = cache.data->append((const char *)&hdr, sizeof(hdr));
+
+    struct cursor c {};
+    uint8_t tbuf[max_pack_len];
+    uint8_t len;
+    while (ok && (len = pack_param(r, c, tbuf)) > 0) {
+        ok = cache.data->append((const char *)tbuf, len);
+        c.token_ofs += len;
+    }
+    if (!ok || c.idx != hdr.num_params) {
+        // out of memory, or the parameter set changed while packing
+        delete cache.data;
+        cache.data = nullptr;
+        return false;
+    }
+    return true;
+}
+
+/*
+  copy current parameter values into the cached image. The layout of
+  the image only depends on the names and types of the parameters,
+  apart from the default flag when defaults are included, so values
+  can be updated in place. Returns false if the layout no longer
+  matches and the image needs to be rebuilt
+ */
+bool AP_Filesystem_Param::cache_refresh_values(void)
+{
+    uint8_t *b = (uint8_t *)cache.data->get_writeable_string();
+    const uint32_t length = cache.data->get_length();
+    uint32_t ofs = sizeof(struct header);
+
+    AP_Param::ParamToken token {};
+    enum ap_var_type ptype;
+    float default_val;
+    for (AP_Param *ap = AP_Param::first(&token, &ptype, &default_val);
+         ap != nullptr;
+         ap = AP_Param::next_scalar(&token, &ptype, &default_val)) {
+        // skip pad bytes
+        while (ofs < length && b[ofs] == 0) {
+            ofs++;
+        }
+        if (ofs + 2 > length || (b[ofs] & 0x0F) != uint8_t(ptype)) {
+            return false;
+        }
+        const bool has_default = (b[ofs] >> 4) != 0;
+#if AP_PARAM_DEFAULTS_ENABLED
+        if (cache.with_defaults &&
+            has_default == is_equal(ap->cast_to_float(ptype), default_val)) {
+            return false;
+        }
+#endif
+        const uint8_t name_len = (b[ofs+1] >> 4) + 1;
+        const uint8_t type_len = AP_Param::type_size(ptype);
+        const uint32_t data_ofs = ofs + 2 + name_len;
+        ofs = data_ofs + type_len * (has_default ? 2 : 1);
+        if (ofs > length) {
+            return false;
+        }
+        memcpy(&b[data_ofs], ap, type_len);
+    }
+    return ofs == length;
+}
+#endif // AP_FILESYSTEM_PARAM_CACHE_ENABLED
+
 int32_t AP_Filesystem_Param::lseek(int fd, int32_t offset, int seek_from)
 {
     if (fd < 0 || fd >= max_open_file || !file[fd].open) {
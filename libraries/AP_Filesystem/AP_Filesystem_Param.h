@@ -74,6 +74,9 @@ private:
         uint16_t count;
         uint32_t file_ofs;
         uint32_t file_size;
+#if AP_FILESYSTEM_PARAM_CACHE_ENABLED
+        bool use_cache;
+#endif
         struct cursor *cursors;
         ExpandingString *writebuf; // for upload
     } file[max_open_file];
@@ -85,6 +88,26 @@ private:
     // finish uploading parameters
     bool finish_upload(const rfile &r);
     bool param_upload_parse(const rfile &r, bool &need_retry);
+
+#if AP_FILESYSTEM_PARAM_CACHE_ENABLED
+    /*
+      packed image of the whole parameter table (start=0, count=0)
+      for one read size. Values are refreshed in place at the start of
+      each download, and the image is rebuilt when a parameter save
+      or a change in the set of parameters may have changed its layout
+     */
+    struct {
+        ExpandingString *data;
+        uint16_t read_size;
+        bool with_defaults;
+        uint16_t save_generation;
+    } cache;
+
+    bool cache_prepare(const struct rfile &r);
+    bool cache_build(const struct rfile &r);
+    bool cache_refresh_values(void);
+    bool cache_in_use(void) const;
+#endif
 };
 
 #endif  // AP_FILESYSTEM_PARAM_ENABLED
@@ -26,6 +26,13 @@
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Networking/AP_Networking.h>
+#include <AP_DroneCAN/AP_DroneCAN.h>
+#include <AP_DDS/AP_DDS_config.h>
+#include <GCS_MAVLink/GCS.h>
+#if AP_DDS_ENABLED
+#include <AP_DDS/AP_DDS_Client.h>
+#endif
 
 extern const AP_HAL::HAL& hal;
 
@@ -47,6 +54,19 @@ static const SysFileList sysfs_file_list[] = {
     {"can0_stats.txt"},
     {"can1_stats.txt"},
 #endif
+#if HAL_ENABLE_DRONECAN_DRIVERS
+    {"dronecan0_stats.txt"},
+    {"dronecan1_stats.txt"},
+#endif
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    {"net_ports.txt"},
+#endif
+#if AP_DDS_ENABLED
+    {"dds_stats.txt"},
+#endif
+#if AP_MAVLINK_SEND_RATE_STATS_ENABLED
+    {"mavlink_rates.txt"},
+#endif
 #if !defined(HAL_BOOTLOADER_BUILD) && (defined(STM32F7) || defined(STM32H7))
     {"persistent.parm"},
 #endif
@@ -137,6 +157,32 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
             hal.can[can_stats_num]->get_stats(*r.str);
         }
     }
+#endif
+#if HAL_ENABLE_DRONECAN_DRIVERS
+    if (strcmp(fname, "dronecan0_stats.txt") == 0 || strcmp(fname, "dronecan1_stats.txt") == 0) {
+        AP_DroneCAN *dronecan = AP_DroneCAN::get_dronecan(fname[8] - '0');
+        if (dronecan != nullptr) {
+            dronecan->get_stats(*r.str);
+        }
+    }
+#endif
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+    if (strcmp(fname, "net_ports.txt") == 0) {
+        AP::network().ports_info(*r.str);
+    }
+#endif
+#if AP_DDS_ENABLED
+    if (strcmp(fname, "dds_stats.txt") == 0) {
+        AP_DDS_Client *dds = AP_DDS_Client::get_singleton();
+        if (dds != nullptr) {
+            dds->stats_info(*r.str);
+        }
+    }
+#endif
+#if AP_MAVLINK_SEND_RATE_STATS_ENABLED
+    if (strcmp(fname, "mavlink_rates.txt") == 0) {
+        gcs().send_rate_info(*r.str);
+    }
 #endif
     if (strcmp(fname, "persistent.parm") == 0) {
         hal.util->load_persistent_params(*r.str);
@@ -22,6 +22,12 @@
 #define AP_FILESYSTEM_PARAM_ENABLED 1
 #endif
 
+// keep a packed copy of the full parameter table in RAM so repeated
+// param.pck downloads don't need to re-walk the parameter tree
+#ifndef AP_FILESYSTEM_PARAM_CACHE_ENABLED
+#define AP_FILESYSTEM_PARAM_CACHE_ENABLED (AP_FILESYSTEM_PARAM_ENABLED && BOARD_FLASH_SIZE > 1024)
+#endif
+
 #ifndef AP_FILESYSTEM_POSIX_ENABLED
 #define AP_FILESYSTEM_POSIX_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
 #endif
@@ -169,8 +169,8 @@ const AP_Param::GroupInfo AP_GyroFFT::var_info[] = {
 
     // @Param: OPTIONS
     // @DisplayName: FFT options
-    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference
-    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise
+    // @Description: FFT configuration options. Values: 1:Apply the FFT *after* the filter bank,2:Check noise at the motor frequencies using ESC data as a reference,4:Update the frequency bins between MINHZ and MAXHZ with a sliding DFT as each sample arrives instead of calculating an FFT of every window. This is cheaper when the band is narrow or the window overlap is high
+    // @Bitmask: 0:Enable post-filter FFT,1:Check motor noise,2:Use sliding DFT
     // @User: Advanced
     // @RebootRequired: True
     AP_GROUPINFO("OPTIONS", 15, AP_GyroFFT, _options, 0),
@@ -245,13 +245,16 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
     // save any changes that were made
     _window_size.save();
 
+    // the sliding DFT keeps a whole window in the buffer so allow a frame to accumulate behind it
+    const uint16_t buffer_size = _window_size + _samples_per_frame * (using_sliding_dft() ? 2 : 1);
+
     // determine the FFT sample rate based on the gyro rate, loop rate and configuration
     if (_sample_mode == 0) {
         _fft_sampling_rate_hz = _ins->get_raw_gyro_rate_hz();
     } else {
         _fft_sampling_rate_hz = loop_rate_hz / _sample_mode;
         for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            if (!_downsampled_gyro_data[axis].set_size(_window_size + _samples_per_frame)) {
+            if (!_downsampled_gyro_data[axis].set_size(buffer_size)) {
                 GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Failed to allocate window for AP_GyroFFT");
                 return;
             }
@@ -267,9 +270,16 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
 
     // make the gyro window match the window size plus a buffer to cope with the backend
     // getting too far ahead.
-    if (!_ins->set_gyro_window_size(_window_size + _samples_per_frame)) {
+    if (!_ins->set_gyro_window_size(buffer_size)) {
         return;
     }
+    for (uint8_t axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        for (uint8_t i = 0; i < INS_MAX_INSTANCES; i++) {
+            _gyro_window_reader[i][axis].attach(_ins->get_raw_gyro_window(i, axis));
+        }
+        _downsampled_gyro_reader[axis].attach(_downsampled_gyro_data[axis]);
+        _analysed_gyro[axis] = _ins->get_first_usable_gyro();
+    }
 
 #if AP_INERTIALSENSOR_HARMONICNOTCH_ENABLED
     // check for harmonics across all harmonic notch filters
@@ -318,6 +328,15 @@ void AP_GyroFFT::init(uint16_t loop_rate_hz)
         return;
     }
 
+    if (using_sliding_dft()) {
+        _sliding_dft = NEW_NOTHROW SlidingDFT();
+        if (_sliding_dft == nullptr || !_sliding_dft->init(_window_size, XYZ_AXIS_COUNT)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "AP_GyroFFT: sliding DFT unavailable, using FFT");
+            delete _sliding_dft;
+            _sliding_dft = nullptr;
+        }
+    }
+
     // per-axis frame time
     _frame_time_ms = _samples_per_frame * 1000 / _fft_sampling_rate_hz;
     // The update rate for the output, defaults are 1Khz / (1 - 0.5) * 32 == 62hz
@@ -455,17 +474,37 @@ uint16_t AP_GyroFFT::run_cycle()
     uint32_t now = AP_HAL::micros();
 
     // get the appropriate gyro buffer
-    FloatBuffer& gyro_buffer = (_sample_mode == 0 ?_ins->get_raw_gyro_window(_update_axis) : _downsampled_gyro_data[_update_axis]);
-    // if we have many more samples than the window size then we are struggling to 
-    // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
-    if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
-        gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
-    }
-    // let's go!
-    hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame);
+    FloatRing::Reader& gyro_buffer = get_gyro_reader(_update_axis);
+    uint16_t bin_max;
+    if (_sliding_dft != nullptr) {
+        // add the new samples to the band, which takes care of dropping samples if we have fallen behind
+        _sliding_dft->set_band(config._fft_start_bin, config._fft_end_bin);
+        // the transform cannot continue across a change of IMU
+        if (_sample_mode == 0 && _analysed_gyro[_update_axis] != _ins->get_first_usable_gyro()) {
+            _analysed_gyro[_update_axis] = _ins->get_first_usable_gyro();
+            _sliding_dft->restart(_update_axis);
+        }
+        _sliding_dft->update(_update_axis, gyro_buffer);
+        if (!_sliding_dft->valid(_update_axis)) {
+            _thread_state._analysis_started = false;
+            return get_available_samples(_update_axis);
+        }
+        bin_max = hal.dsp->sdft_analyse(_state, *_sliding_dft, _update_axis, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    } else {
+        // if we have many more samples than the window size then we are struggling to 
+        // stay ahead of the gyro loop so drop samples so that this cycle will use all available samples
+        if (gyro_buffer.available() > uint32_t(_state->_window_size + uint16_t(_samples_per_frame >> 1))) { // half the frame size is a heuristic
+            gyro_buffer.advance(gyro_buffer.available() - _state->_window_size);
+        }
+        // let's go! the window can be lost to the gyro loop lapping us while it is copied
+        if (!hal.dsp->fft_start(_state, gyro_buffer, _samples_per_frame)) {
+            _thread_state._analysis_started = false;
+            return get_available_samples(_update_axis);
+        }
 
-    // calculate FFT and update filters outside the semaphore
-    uint16_t bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+        // calculate FFT and update filters outside the semaphore
+        bin_max = hal.dsp->fft_analyse(_state, config._fft_start_bin, config._fft_end_bin, config._attenuation_cutoff);
+    }
 
     // something has been detected, update the peak frequency and associated metrics
     update_ref_energy(bin_max);
@@ -1392,7 +1431,7 @@ float AP_GyroFFT::self_test_bin_frequencies()
         return 0.0f;
     }
 
-    FloatBuffer test_window(_state->_window_size);
+    FloatRing test_window(_state->_window_size);
     // in the unlikely event we can't allocate a test window, skip the checks
     if (test_window.get_size() == 0) {
         return 0.0f;
@@ -1413,24 +1452,23 @@ float AP_GyroFFT::self_test_bin_frequencies()
 
 // perform FFT analysis of a single sine wave at the selected frequency
 // called from main thread
-float AP_GyroFFT::self_test(float frequency, FloatBuffer& test_window)
+float AP_GyroFFT::self_test(float frequency, FloatRing& test_window)
 {
     test_window.clear();
     for(uint16_t i = 0; i < _state->_window_size; i++) {
-        if (!test_window.push(sinf(2.0f * M_PI * frequency * i / _fft_sampling_rate_hz) * ToRad(20) * 2000)) {
-            AP_HAL::panic("Could not create FFT test window");
-        }
+        test_window.push(sinf(2.0f * M_PI * frequency * i / _fft_sampling_rate_hz) * ToRad(20) * 2000);
     }
+    FloatRing::Reader test_reader(test_window);
 
     _update_axis = 0;
 
     // if using averaging we need to process _num_frames in order to not bias the result
     for (uint8_t i = 1; i < _num_frames; i++) {
-        hal.dsp->fft_start(_state, test_window, 0);
+        hal.dsp->fft_start(_state, test_reader, 0);
         hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
     }
     // final cycle is the one we want
-    hal.dsp->fft_start(_state, test_window, 0);
+    hal.dsp->fft_start(_state, test_reader, 0);
     uint16_t max_bin = hal.dsp->fft_analyse(_state, _config._fft_start_bin, _config._fft_end_bin, _config._attenuation_cutoff);
 
     if (max_bin == 0) {
@@ -21,7 +21,8 @@
 #if HAL_GYROFFT_ENABLED
 
 #include <AP_Common/AP_Common.h>
-#include <AP_HAL/utility/RingBuffer.h>
+#include <AP_HAL/utility/SampleRing.h>
+#include <AP_HAL/utility/SlidingDFT.h>
 #include <AP_Param/AP_Param.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
@@ -40,7 +41,8 @@ public:
 
     enum class Options : uint32_t {
         FFTPostFilter = 1 << 0,
-        ESCNoiseCheck = 1 << 1
+        ESCNoiseCheck = 1 << 1,
+        SlidingDFT = 1 << 2
     };
 
     AP_GyroFFT();
@@ -111,6 +113,8 @@ public:
     bool using_post_filter_samples() const { return (_options & uint32_t(Options::FFTPostFilter)) != 0; }
     // post filter mask of IMUs
     bool check_esc_noise() const { return (_options & uint32_t(Options::ESCNoiseCheck)) != 0; }
+    // update the configured band incrementally rather than transforming whole windows
+    bool using_sliding_dft() const { return (_options & uint32_t(Options::SlidingDFT)) != 0; }
     // look for a frequency in the detected noise
     float has_noise_at_frequency_hz(float freq) const;
     static float calculate_notch_frequency(float* freqs, uint16_t numpeaks, float harmonic_fit, uint8_t& harmonics);
@@ -215,14 +219,23 @@ private:
     // test frequency detection for all of the allowable bins
     float self_test_bin_frequencies();
     // detect the provided frequency
-    float self_test(float frequency, FloatBuffer& test_window);
+    float self_test(float frequency, FloatRing& test_window);
     // whether to run analysis or not
     bool analysis_enabled() const { return _initialized && _analysis_enabled && _thread_created; };
     // whether analysis can be run again or not
     bool start_analysis();
+    // reader for the gyro window being analysed on an axis
+    FloatRing::Reader& get_gyro_reader(uint8_t axis) {
+        return _sample_mode == 0 ? _gyro_window_reader[_ins->get_first_usable_gyro()][axis] : _downsampled_gyro_reader[axis];
+    }
     // return samples available in the gyro window
     uint16_t get_available_samples(uint8_t axis) {
-        return _sample_mode == 0 ?_ins->get_raw_gyro_window(axis).available() : _downsampled_gyro_data[axis].available();
+        const uint16_t available = get_gyro_reader(axis).available();
+        // the sliding DFT keeps a whole window in the buffer, so a frame is ready once there is a frame of samples behind it
+        if (_sliding_dft != nullptr) {
+            return available > _samples_per_frame ? available - _samples_per_frame : 0;
+        }
+        return available;
     }
     void update_parameters(bool force);
     // semaphore for access to shared FFT data
@@ -275,7 +288,12 @@ private:
     // last cycle time
     uint32_t _output_cycle_micros;
     // downsampled gyro data circular buffer for frequency analysis
-    FloatBuffer _downsampled_gyro_data[XYZ_AXIS_COUNT];
+    FloatRing _downsampled_gyro_data[XYZ_AXIS_COUNT];
+    FloatRing::Reader _downsampled_gyro_reader[XYZ_AXIS_COUNT];
+    // our cursors into the gyro windows of every IMU, so that switching IMU never reads stale samples
+    FloatRing::Reader _gyro_window_reader[INS_MAX_INSTANCES][XYZ_AXIS_COUNT];
+    // IMU last analysed on each axis
+    uint8_t _analysed_gyro[XYZ_AXIS_COUNT];
     // accumulator for sampled gyro data
     Vector3f _oversampled_gyro_accum;
     // count of oversamples
@@ -283,6 +301,8 @@ private:
 
     // state of the FFT engine
     AP_HAL::DSP::FFTWindowState* _state;
+    // incremental transform of the configured band, nullptr when using the FFT
+    SlidingDFT* _sliding_dft;
     // update state machine step information
     uint8_t _update_axis;
     // noise base of the gyros
@@ -259,6 +259,10 @@ public:
     // return true if init was called and successful
     virtual bool is_initialized() const = 0;
 
+    // return the nominal bitrate the interface was initialised
+    // with, 0 if unknown
+    uint32_t get_bitrate() const { return bitrate_; }
+
     FUNCTOR_TYPEDEF(FrameCb, void, uint8_t, const AP_HAL::CANFrame &);
 
     // register a frame callback function
@@ -18,6 +18,7 @@
 #include <AP_Math/AP_Math.h>
 #include "AP_HAL.h"
 #include "DSP.h"
+#include "utility/SlidingDFT.h"
 #ifndef HAL_NO_UARTDRIVER
 #include <GCS_MAVLink/GCS.h>
 #endif
@@ -139,6 +140,21 @@ void DSP::step_cmplx_mag(FFTWindowState* fft, uint16_t start_bin, uint16_t end_b
     }
 }
 
+// perform the analysis steps on the band of a sliding DFT instead of an FFT
+uint16_t DSP::sdft_analyse(FFTWindowState* fft, const SlidingDFT& sdft, uint8_t channel, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff)
+{
+    // only the bins around the band are available, everything else is treated as having no energy
+    memset(fft->_freq_bins, 0, sizeof(float) * fft->_num_stored_freqs);
+    sdft.calculate(channel, fft->_rfft_data);
+
+    for (uint16_t i = sdft.first_bin(), j = i * 2; i <= sdft.last_bin(); i++, j += 2) {
+        fft->_freq_bins[i] = sq(fft->_rfft_data[j]) + sq(fft->_rfft_data[j+1]);
+    }
+
+    step_cmplx_mag(fft, start_bin, end_bin, noise_att_cutoff);
+    return step_calc_frequencies(fft, start_bin, end_bin);
+}
+
 // calculate the noise width of a peak based on the input parameters
 // freq_bins can be scaled or unscaled for power
 float DSP::find_noise_width(float* freq_bins, uint16_t start_bin, uint16_t end_bin, uint16_t max_energy_bin, float cutoff, float bin_resolution, uint16_t& peak_top, uint16_t& peak_bottom) const
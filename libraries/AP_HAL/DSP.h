@@ -22,11 +22,14 @@
 #include <stdint.h>
 #include "AP_HAL_Namespace.h"
 #include <AP_HAL/utility/RingBuffer.h>
+#include <AP_HAL/utility/SampleRing.h>
 
 #define DSP_MEM_REGION AP_HAL::Util::MEM_FAST
 // Maximum tolerated number of cycles with missing signal
 #define FFT_MAX_MISSED_UPDATES 5
 
+class SlidingDFT;
+
 class AP_HAL::DSP {
 #if HAL_WITH_DSP
 public:
@@ -92,10 +95,12 @@ public:
     };
     // initialise an FFT instance
     virtual FFTWindowState* fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size = 0) = 0;
-    // start an FFT analysis with an ObjectBuffer
-    virtual void fft_start(FFTWindowState* state, FloatBuffer& samples, uint16_t advance) = 0;
+    // start an FFT analysis with a reader of a sample ring, returns false if a full window of samples could not be read
+    virtual bool fft_start(FFTWindowState* state, FloatRing::Reader& samples, uint16_t advance) = 0;
     // perform remaining steps of an FFT analysis
     virtual uint16_t fft_analyse(FFTWindowState* state, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff) = 0;
+    // perform the analysis steps on the band of a sliding DFT instead of an FFT
+    uint16_t sdft_analyse(FFTWindowState* state, const SlidingDFT& sdft, uint8_t channel, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff);
     // start averaging FFT data
     bool fft_start_average(FFTWindowState* fft);
     // finish the averaging process
@@ -0,0 +1,116 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_WITH_DSP
+
+#include <AP_HAL/utility/RealFFT.h>
+#include <AP_Math/AP_Math.h>
+#include <complex>
+
+typedef std::complex<float> complexf;
+
+/*
+  the complex radix-2 FFT previously used by the SITL DSP, kept here
+  as a baseline
+ */
+static void complex_fft(complexf *samples, uint16_t fftlen)
+{
+    uint16_t m = 0;
+    while ((1U << m) < fftlen) {
+        m++;
+    }
+    for (uint16_t k = 0; k < fftlen; k++) {
+        uint16_t ki = k, kr = 0;
+        for (uint16_t i=1; i<=m; i++) {
+            kr <<= 1;
+            if (ki % 2 == 1) {
+                kr++;
+            }
+            ki >>= 1;
+        }
+        if (kr > k) {
+            complexf t = samples[kr];
+            samples[kr] = samples[k];
+            samples[k] = t;
+        }
+    }
+
+    uint16_t istep = 2;
+    while (istep <= fftlen) {
+        uint16_t is2 = istep / 2;
+        uint16_t astep = fftlen / istep;
+        for (uint16_t km = 0; km < is2; km++) {
+            uint16_t a  = km * astep;
+            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
+            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) {
+                uint16_t i = km + ki;
+                uint16_t j = is2 + i;
+                complexf t = w * samples[j];
+                complexf q = samples[i];
+                samples[j] = q - t;
+                samples[i] = q + t;
+            }
+        }
+        istep <<= 1;
+    }
+}
+
+static void fill_gyro_window(float *samples, float *window, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        samples[i] = sinf(2 * M_PI * 37 * i / len) + 0.3f * sinf(2 * M_PI * 101 * i / len);
+        window[i] = 0.5f - 0.5f * cosf(2.0f * M_PI * i / ((float)len - 1));
+    }
+}
+
+static void BM_ComplexFFT(benchmark::State& state)
+{
+    const uint16_t len = state.range_x();
+    float *samples = new float[len];
+    float *window = new float[len];
+    complexf *buf = new complexf[len];
+    fill_gyro_window(samples, window, len);
+
+    while (state.KeepRunning()) {
+        for (uint16_t i = 0; i < len; i++) {
+            buf[i] = complexf(samples[i] * window[i], 0);
+        }
+        complex_fft(buf, len);
+        gbenchmark_escape(buf);
+    }
+
+    delete[] samples;
+    delete[] window;
+    delete[] buf;
+}
+
+static void BM_RealFFT(benchmark::State& state)
+{
+    const uint16_t len = state.range_x();
+    float *samples = new float[len];
+    float *window = new float[len];
+    float *output = new float[len + 2];
+    fill_gyro_window(samples, window, len);
+
+    RealFFT rfft;
+    const bool ok = rfft.init(len);
+
+    while (ok && state.KeepRunning()) {
+        rfft.calculate(samples, window, output);
+        gbenchmark_escape(output);
+    }
+
+    delete[] samples;
+    delete[] window;
+    delete[] output;
+}
+
+BENCHMARK(BM_ComplexFFT)->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Arg(512)->Arg(1024);
+BENCHMARK(BM_RealFFT)->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Arg(512)->Arg(1024);
+
+#endif // HAL_WITH_DSP
+
+BENCHMARK_MAIN();
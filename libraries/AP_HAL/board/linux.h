@@ -27,6 +27,7 @@
     #define HAL_BOARD_STORAGE_DIRECTORY "."
     #define HAL_INS_DEFAULT HAL_INS_NONE
     #define HAL_BARO_DEFAULT HAL_BARO_NONE
+    #define HAL_GYROFFT_ENABLED 1
 #elif CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_PXF || CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_ERLEBOARD
     #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_PXF
       #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_ROLL_180_YAW_270)
@@ -138,6 +139,7 @@
     #define HAL_MAG_PROBE2 PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
     #define HAL_MAG_PROBE_LIST HAL_MAG_PROBE1; HAL_MAG_PROBE2
     #define HAL_PROBE_EXTERNAL_I2C_COMPASSES
+    #define HAL_GYROFFT_ENABLED 1
 #elif CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_ERLEBRAIN2
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_YAW_270)
     #define HAL_BARO_PROBE_LIST PROBE_BARO_SPI(MS56XX, "ms5611")
@@ -185,6 +187,7 @@
     #define HAL_LINUX_I2C_EXTERNAL_BUS_MASK 1 << 6
     // We don't want any probing on the internal buses
     #define HAL_LINUX_I2C_INTERNAL_BUS_MASK 0
+    #define HAL_GYROFFT_ENABLED 1
 #elif CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BLUE
     #define HAL_GPIO_A_LED_PIN 66
     #define HAL_GPIO_B_LED_PIN 67
@@ -239,6 +242,7 @@
     #define HAL_MAG_PROBE_LIST HAL_MAG_PROBE1; HAL_MAG_PROBE2; HAL_MAG_PROBE3
     #define HAL_RCOUTPUT_TAP_DEVICE "/dev/ttyS1"
     #define HAL_NUM_CAN_IFACES 1
+    #define HAL_GYROFFT_ENABLED 1
 #elif CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_DARK
     #define HAL_INS_PROBE_LIST PROBE_IMU_SPI(Invensense, "mpu9250", ROTATION_NONE)
     #define HAL_MAG_PROBE_LIST PROBE_MAG_IMU(AK8963, mpu9250, 0, ROTATION_NONE)
@@ -391,6 +395,10 @@
 #define HAL_WITH_EKF_DOUBLE HAL_HAVE_HARDWARE_DOUBLE
 #endif
 
+// Linux::DSP provides the FFT backend for in-flight noise tracking,
+// it is enabled above on the boards with a multi-core processor that
+// has the CPU to spare (native builds, Navio2 and Navigator on a
+// Raspberry Pi 3/4, Intel Aero). Other boards keep it off.
 #ifndef HAL_GYROFFT_ENABLED
 #define HAL_GYROFFT_ENABLED 0
 #endif
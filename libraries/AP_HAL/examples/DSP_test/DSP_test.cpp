@@ -17,7 +17,8 @@ static const float frequency1 = 120;
 static const float frequency2 = 50;
 static const float frequency3 = 350;
 static float attenuation_cutoff;
-static FloatBuffer fft_window {WINDOW_SIZE};
+static FloatRing fft_window {WINDOW_SIZE};
+static FloatRing::Reader fft_reader {fft_window};
 
 static const uint16_t last_bin = MIN(ceilf(max_hz / ((float)SAMPLE_RATE/ WINDOW_SIZE)), WINDOW_SIZE/2);
 
@@ -41,7 +42,7 @@ public:
 class DSPTest : public AP_HAL::DSP {
 public:
     virtual FFTWindowState* fft_init(uint16_t w, uint16_t sample_rate, uint8_t sliding_window_size) override { return nullptr; }
-    virtual void fft_start(FFTWindowState* state, FloatBuffer& samples, uint16_t advance) override {}
+    virtual bool fft_start(FFTWindowState* state, FloatRing::Reader& samples, uint16_t advance) override { return false; }
     virtual uint16_t fft_analyse(FFTWindowState* state, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff) override { return 0; }
 protected:
     virtual void vector_max_float(const float* vin, uint16_t len, float* maxValue, uint16_t* maxIndex) const override {}
@@ -95,7 +96,7 @@ void DSPTest::run_tests() {
 void do_fft(const float* data)
 {
     fft_window.push(data, WINDOW_SIZE);
-    hal.dsp->fft_start(fft, fft_window, WINDOW_SIZE);
+    hal.dsp->fft_start(fft, fft_reader, WINDOW_SIZE);
     uint16_t max_bin = hal.dsp->fft_analyse(fft, 1, last_bin, attenuation_cutoff);
 
     if (max_bin <= 0) {
@@ -0,0 +1,134 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Code by Andy Piper
+ */
+
+#include <AP_HAL/AP_HAL.h>
+
+#if HAL_WITH_DSP
+
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS.h>
+#include "DSP_RealFFT.h"
+
+extern const AP_HAL::HAL& hal;
+
+// The algorithms originally came from betaflight but are now substantially modified based on theory and experiment.
+// https://holometer.fnal.gov/GH_FFT.pdf "Spectrum and spectral density estimation by the Discrete Fourier transform (DFT),
+// including a comprehensive list of window functions and some new flat-top windows." - Heinzel et. al is a great reference
+// for understanding the underlying theory although we do not use spectral density here since time resolution is equally
+// important as frequency resolution. Referred to as [Heinz] throughout the code.
+
+// initialize the FFT state machine
+AP_HAL::DSP::FFTWindowState* DSP_RealFFT::fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size)
+{
+    DSP_RealFFT::FFTWindowStateRealFFT* fft = NEW_NOTHROW DSP_RealFFT::FFTWindowStateRealFFT(window_size, sample_rate, sliding_window_size);
+    if (fft == nullptr || fft->_hanning_window == nullptr || fft->_rfft_data == nullptr || fft->_freq_bins == nullptr || fft->_derivative_freq_bins == nullptr
+        || fft->rfft.length() != window_size) {
+        delete fft;
+        return nullptr;
+    }
+    return fft;
+}
+
+// start an FFT analysis
+bool DSP_RealFFT::fft_start(AP_HAL::DSP::FFTWindowState* state, FloatRing::Reader& samples, uint16_t advance)
+{
+    return step_hanning((FFTWindowStateRealFFT*)state, samples, advance);
+}
+
+// perform remaining steps of an FFT analysis
+uint16_t DSP_RealFFT::fft_analyse(AP_HAL::DSP::FFTWindowState* state, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff)
+{
+    FFTWindowStateRealFFT* fft = (FFTWindowStateRealFFT*)state;
+    step_fft(fft);
+    step_cmplx_mag(fft, start_bin, end_bin, noise_att_cutoff);
+    return step_calc_frequencies(fft, start_bin, end_bin);
+}
+
+// create an instance of the FFT state machine
+DSP_RealFFT::FFTWindowStateRealFFT::FFTWindowStateRealFFT(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size)
+    : AP_HAL::DSP::FFTWindowState::FFTWindowState(window_size, sample_rate, sliding_window_size)
+{
+    if (_freq_bins == nullptr || _hanning_window == nullptr || _rfft_data == nullptr || _derivative_freq_bins == nullptr) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Failed to allocate window for DSP");
+        return;
+    }
+
+    rfft.init(window_size);
+}
+
+// step 1: copy the incoming samples, the Hanning window is applied as
+// part of the FFT
+bool DSP_RealFFT::step_hanning(FFTWindowStateRealFFT* fft, FloatRing::Reader& samples, uint16_t advance)
+{
+    // the producer may have overwritten the samples while they were
+    // being copied, in which case the caller skips this cycle
+    uint32_t read_window = samples.peek(&fft->_freq_bins[0], fft->_window_size);
+    if (read_window != fft->_window_size) {
+        return false;
+    }
+    samples.advance(advance);
+    return true;
+}
+
+// step 2: window the data and perform a real FFT on it
+void DSP_RealFFT::step_fft(FFTWindowStateRealFFT* fft)
+{
+    // the output includes the DC and Nyquist components, which are real only
+    fft->rfft.calculate(fft->_freq_bins, fft->_hanning_window, fft->_rfft_data);
+
+    for (uint16_t i = 0, j = 0; i < fft->_bin_count; i++, j += 2) {
+        fft->_freq_bins[i] = sq(fft->_rfft_data[j]) + sq(fft->_rfft_data[j+1]);
+    }
+}
+
+void DSP_RealFFT::vector_max_float(const float* vin, uint16_t len, float* maxValue, uint16_t* maxIndex) const
+{
+    *maxValue = vin[0];
+    *maxIndex = 0;
+    for (uint16_t i = 1; i < len; i++) {
+        if (vin[i] > *maxValue) {
+            *maxValue = vin[i];
+            *maxIndex = i;
+        }
+    }
+}
+
+void DSP_RealFFT::vector_scale_float(const float* vin, float scale, float* vout, uint16_t len) const
+{
+    for (uint16_t i = 0; i < len; i++) {
+        vout[i] = vin[i] * scale;
+    }
+}
+
+void DSP_RealFFT::vector_add_float(const float* vin1, const float* vin2, float* vout, uint16_t len) const
+{
+    for (uint16_t i = 0; i < len; i++) {
+        vout[i] = vin1[i] + vin2[i];
+    }
+}
+
+float DSP_RealFFT::vector_mean_float(const float* vin, uint16_t len) const
+{
+    float mean_value = 0.0f;
+    for (uint16_t i = 0; i < len; i++) {
+        mean_value += vin[i];
+    }
+    mean_value /= len;
+    return mean_value;
+}
+
+#endif // HAL_WITH_DSP
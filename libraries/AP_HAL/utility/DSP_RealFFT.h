@@ -0,0 +1,60 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Code by Andy Piper
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#if HAL_WITH_DSP
+
+#include <AP_HAL/DSP.h>
+#include "RealFFT.h"
+
+/*
+  generic implementation of FFT analysis using the portable RealFFT,
+  shared by the HALs that have no vendor DSP library (SITL and Linux)
+ */
+class DSP_RealFFT : public AP_HAL::DSP {
+public:
+    // initialise an FFT instance
+    virtual FFTWindowState* fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size) override;
+    // start an FFT analysis with an ObjectBuffer
+    virtual bool fft_start(FFTWindowState* state, FloatRing::Reader& samples, uint16_t advance) override;
+    // perform remaining steps of an FFT analysis
+    virtual uint16_t fft_analyse(FFTWindowState* state, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff) override;
+
+    // RealFFT-based FFT state
+    class FFTWindowStateRealFFT : public AP_HAL::DSP::FFTWindowState {
+        friend class DSP_RealFFT;
+
+    public:
+        FFTWindowStateRealFFT(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size);
+
+    private:
+        // real FFT with twiddle and bit-reverse tables for this window size
+        RealFFT rfft;
+    };
+
+private:
+    bool step_hanning(FFTWindowStateRealFFT* fft, FloatRing::Reader& samples, uint16_t advance);
+    void step_fft(FFTWindowStateRealFFT* fft);
+    void vector_max_float(const float* vin, uint16_t len, float* maxValue, uint16_t* maxIndex) const override;
+    void vector_scale_float(const float* vin, float scale, float* vout, uint16_t len) const override;
+    float vector_mean_float(const float* vin, uint16_t len) const override;
+    void vector_add_float(const float* vin1, const float* vin2, float* vout, uint16_t len) const override;
+};
+
+#endif // HAL_WITH_DSP
@@ -0,0 +1,132 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RealFFT.h"
+
+#if HAL_WITH_DSP
+
+#include <math.h>
+#include <new>
+
+RealFFT::~RealFFT()
+{
+    delete[] _twiddle;
+    delete[] _bitrev;
+    delete[] _work;
+}
+
+bool RealFFT::init(uint16_t fft_len)
+{
+    if (fft_len < 4 || (fft_len & (fft_len - 1)) != 0) {
+        return false;
+    }
+    const uint16_t half = fft_len / 2;
+
+    delete[] _twiddle;
+    delete[] _bitrev;
+    delete[] _work;
+    _len = 0;
+    _twiddle = NEW_NOTHROW float[fft_len];
+    _bitrev = NEW_NOTHROW uint16_t[half];
+    _work = NEW_NOTHROW float[fft_len];
+    if (_twiddle == nullptr || _bitrev == nullptr || _work == nullptr) {
+        return false;
+    }
+
+    for (uint16_t k = 0; k < half; k++) {
+        const double angle = 2.0 * M_PI * k / fft_len;
+        _twiddle[2*k] = cos(angle);
+        _twiddle[2*k+1] = -sin(angle);
+    }
+
+    uint8_t bits = 0;
+    while ((1U << bits) < half) {
+        bits++;
+    }
+    for (uint16_t k = 0; k < half; k++) {
+        uint16_t r = 0;
+        for (uint8_t b = 0; b < bits; b++) {
+            r |= ((k >> b) & 1U) << (bits - 1 - b);
+        }
+        _bitrev[k] = r;
+    }
+
+    _len = fft_len;
+    return true;
+}
+
+void RealFFT::calculate(const float *input, const float *window, float *output)
+{
+    const uint16_t half = _len / 2;
+    float *z = _work;
+
+    // window the input and pack pairs of real samples into complex
+    // points in bit reversed order, in a single pass
+    if (window != nullptr) {
+        for (uint16_t n = 0; n < half; n++) {
+            const uint16_t r = _bitrev[n];
+            z[2*r] = input[2*n] * window[2*n];
+            z[2*r+1] = input[2*n+1] * window[2*n+1];
+        }
+    } else {
+        for (uint16_t n = 0; n < half; n++) {
+            const uint16_t r = _bitrev[n];
+            z[2*r] = input[2*n];
+            z[2*r+1] = input[2*n+1];
+        }
+    }
+
+    // iterative radix-2 butterflies on the N/2 point complex sequence
+    for (uint16_t size = 2; size <= half; size <<= 1) {
+        const uint16_t step = size / 2;
+        const uint16_t tstride = _len / size;
+        for (uint16_t k = 0; k < step; k++) {
+            const float wr = _twiddle[2*k*tstride];
+            const float wi = _twiddle[2*k*tstride+1];
+            for (uint16_t i = k; i < half; i += size) {
+                float *a = &z[2*i];
+                float *b = &z[2*(i+step)];
+                const float tr = wr * b[0] - wi * b[1];
+                const float ti = wr * b[1] + wi * b[0];
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+
+    // split the packed spectrum into the spectrum of the real
+    // input. DC and Nyquist are real only
+    output[0] = z[0] + z[1];
+    output[1] = 0;
+    output[2*half] = z[0] - z[1];
+    output[2*half+1] = 0;
+    for (uint16_t k = 1; k < half; k++) {
+        const float *zk = &z[2*k];
+        const float *zm = &z[2*(half-k)];
+        const float even_r = 0.5f * (zk[0] + zm[0]);
+        const float even_i = 0.5f * (zk[1] - zm[1]);
+        const float odd_r = 0.5f * (zk[1] + zm[1]);
+        const float odd_i = -0.5f * (zk[0] - zm[0]);
+        const float wr = _twiddle[2*k];
+        const float wi = _twiddle[2*k+1];
+        output[2*k] = even_r + wr * odd_r - wi * odd_i;
+        // conjugate to match the exp(+j) convention
+        output[2*k+1] = -(even_i + wr * odd_i + wi * odd_r);
+    }
+}
+
+#endif // HAL_WITH_DSP
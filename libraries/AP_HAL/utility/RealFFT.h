@@ -0,0 +1,67 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#if HAL_WITH_DSP
+
+#include <stdint.h>
+#include <AP_Common/AP_Common.h>
+
+/*
+  portable real-input FFT for boards without a vendor DSP library
+
+  An N point real sequence is packed into an N/2 point complex
+  sequence (even samples in the real part, odd samples in the
+  imaginary part), transformed with an iterative radix-2 FFT and then
+  split into the N/2+1 unique bins of the real spectrum. Twiddle
+  factors and the bit-reverse permutation are calculated once in
+  init(), so an analysis only does table lookups and multiply-adds.
+ */
+class RealFFT {
+public:
+    RealFFT() {}
+    ~RealFFT();
+
+    CLASS_NO_COPY(RealFFT);
+
+    // allocate tables for an FFT of length fft_len, which must be a
+    // power of two of at least 4
+    bool init(uint16_t fft_len);
+
+    /*
+      calculate the spectrum of input multiplied by window (which may
+      be nullptr for a rectangular window). The N/2+1 bins from DC to
+      Nyquist are written to output as interleaved real and imaginary
+      parts, so output must have space for N+2 floats. The sign
+      convention matches the exp(+j) transform historically used by
+      the SITL DSP
+     */
+    void calculate(const float *input, const float *window, float *output);
+
+    uint16_t length() const { return _len; }
+
+private:
+    uint16_t _len = 0;
+    // cos/sin pairs for exp(-2*pi*j*k/N), k = 0..N/2-1
+    float *_twiddle = nullptr;
+    // bit reversed index for each of the N/2 complex points
+    uint16_t *_bitrev = nullptr;
+    // N/2 interleaved complex points
+    float *_work = nullptr;
+};
+
+#endif // HAL_WITH_DSP
@@ -0,0 +1,261 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_HAL/AP_HAL_Macros.h>
+#include <AP_Common/AP_Common.h>
+
+/*
+  lock free single producer, multiple consumer ring of samples
+
+  The producer always succeeds in pushing, overwriting the oldest
+  sample once the ring is full, and never waits for consumers. Each
+  consumer reads through its own Reader, which holds an independent
+  cursor into the ring, so any number of consumers can read the same
+  samples without copying them into separate buffers or taking a lock.
+
+  A reader that falls more than a ring behind the producer loses the
+  overwritten samples. This is detected when reading: the reader skips
+  forward to the oldest sample still held and records an overrun so
+  that consumers which depend on continuity can restart. One extra
+  slot is allocated so that the slot being written by the producer is
+  never one that a reader may be copying without that being detected.
+
+  Writes follow the seqlock pattern: the producer advances a claim
+  counter and issues a release fence before it writes a slot, and only
+  then publishes the new head. A reader that copied a slot the
+  producer was rewriting is guaranteed to see the advanced claim after
+  its acquire fence, and discards the copy.
+
+  The write counter wraps at a multiple of the ring size rather than
+  at 2^32 so that any ring size can be used without padding it to a
+  power of two.
+ */
+template <class T>
+class SampleRing {
+public:
+    SampleRing(uint32_t size = 0) {
+        set_size(size);
+    }
+
+    ~SampleRing(void) {
+        delete[] _buf;
+    }
+
+    CLASS_NO_COPY(SampleRing);
+
+    /*
+      set size of the ring, discarding any samples. Readers must be
+      attached after the size is set and must not be in use while it
+      changes
+     */
+    bool set_size(uint32_t size) {
+        delete[] _buf;
+        _buf = nullptr;
+        _size = 0;
+        _wrap = 0;
+        _head.store(0);
+        _claim.store(0);
+        if (size == 0) {
+            return true;
+        }
+        _buf = NEW_NOTHROW T[size+1];
+        if (_buf == nullptr) {
+            return false;
+        }
+        _size = size;
+        _wrap = (UINT32_MAX / (size+1)) * (size+1);
+        return true;
+    }
+
+    // return size of ring
+    uint32_t get_size(void) const { return _size; }
+
+    // discard all samples. Readers must be re-attached
+    void clear(void) {
+        _head.store(0);
+        _claim.store(0);
+    }
+
+    // push a sample, overwriting the oldest sample if the ring is full
+    void push(const T &object) {
+        if (_buf == nullptr) {
+            return;
+        }
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        const uint32_t new_head = next(head, 1);
+        _claim.store(new_head, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _buf[head % (_size+1)] = object;
+        _head.store(new_head, std::memory_order_release);
+    }
+
+    // push a block of samples
+    void push(const T *objects, uint32_t n) {
+        if (_buf == nullptr) {
+            return;
+        }
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        const uint32_t new_head = next(head, n);
+        _claim.store(new_head, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (uint32_t i = 0; i < n; i++) {
+            _buf[next(head, i) % (_size+1)] = objects[i];
+        }
+        _head.store(new_head, std::memory_order_release);
+    }
+
+    /*
+      consumer side of the ring. The cursor belongs to a single
+      consumer thread
+     */
+    class Reader {
+    public:
+        Reader() {}
+        Reader(SampleRing<T> &ring) {
+            attach(ring);
+        }
+
+        // start reading a ring from the oldest sample it holds
+        void attach(SampleRing<T> &ring) {
+            _ring = &ring;
+            const uint32_t head = ring._head.load(std::memory_order_acquire);
+            _pos = ring.prev(head, smaller(ring.distance(0, head), ring._size));
+            _overrun = false;
+        }
+
+        bool attached(void) const { return _ring != nullptr; }
+
+        // number of samples available to be read
+        uint32_t available(void) const {
+            if (_ring == nullptr) {
+                return 0;
+            }
+            return smaller(_ring->distance(_pos, _ring->_head.load(std::memory_order_acquire)), _ring->_size);
+        }
+
+        /*
+          copy up to len samples without advancing the cursor. Returns
+          zero if the producer overwrote the samples while they were
+          being copied
+         */
+        uint32_t peek(T *data, uint32_t len) {
+            catch_up();
+            len = smaller(len, available());
+            if (len == 0) {
+                return 0;
+            }
+            const uint32_t slots = _ring->_size + 1;
+            const uint32_t start = _pos % slots;
+            const uint32_t n1 = smaller(len, slots - start);
+            memcpy(data, &_ring->_buf[start], n1 * sizeof(T));
+            if (n1 < len) {
+                memcpy(&data[n1], &_ring->_buf[0], (len - n1) * sizeof(T));
+            }
+            /*
+              check that the producer has not claimed any of the
+              copied slots. The first slot is rewritten by the write
+              that advances the claim to _size+2 past it
+             */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_ring->distance(_pos, _ring->_claim.load(std::memory_order_relaxed)) > _ring->_size + 1) {
+                catch_up();
+                return 0;
+            }
+            return len;
+        }
+
+        // read one sample
+        bool pop(T &object) {
+            if (peek(&object, 1) != 1) {
+                return false;
+            }
+            return advance(1);
+        }
+
+        // advance the cursor (discarding samples)
+        bool advance(uint32_t n) {
+            catch_up();
+            if (n > available()) {
+                return false;
+            }
+            _pos = _ring->next(_pos, n);
+            return true;
+        }
+
+        /*
+          return true if samples have been lost since the last call,
+          clearing the flag
+         */
+        bool take_overrun(void) {
+            catch_up();
+            const bool ret = _overrun;
+            _overrun = false;
+            return ret;
+        }
+
+        // total number of times the reader has been lapped
+        uint32_t overrun_count(void) const { return _overrun_count; }
+
+    private:
+        // skip forward to the oldest sample if we have been lapped
+        void catch_up(void) {
+            if (_ring == nullptr) {
+                return;
+            }
+            const uint32_t head = _ring->_head.load(std::memory_order_acquire);
+            if (_ring->distance(_pos, head) > _ring->_size) {
+                _pos = _ring->prev(head, _ring->_size);
+                _overrun = true;
+                _overrun_count++;
+            }
+        }
+
+        SampleRing<T> *_ring = nullptr;
+        uint32_t _pos = 0;
+        uint32_t _overrun_count = 0;
+        bool _overrun = false;
+    };
+
+private:
+    uint32_t next(uint32_t pos, uint32_t n) const {
+        return pos >= _wrap - n ? pos + n - _wrap : pos + n;
+    }
+    uint32_t prev(uint32_t pos, uint32_t n) const {
+        return pos >= n ? pos - n : pos + _wrap - n;
+    }
+    // number of samples from pos up to head
+    uint32_t distance(uint32_t pos, uint32_t head) const {
+        return head >= pos ? head - pos : head + _wrap - pos;
+    }
+    static uint32_t smaller(uint32_t a, uint32_t b) {
+        return a < b ? a : b;
+    }
+
+    // _size + 1 slots
+    T *_buf = nullptr;
+    uint32_t _size = 0;
+    uint32_t _wrap = 0;
+    // write counter, modulo _wrap
+    std::atomic<uint32_t> _head{0};
+    // write counter including the write in progress
+    std::atomic<uint32_t> _claim{0};
+};
+
+typedef SampleRing<float> FloatRing;
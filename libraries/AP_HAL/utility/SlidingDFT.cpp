@@ -0,0 +1,190 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SlidingDFT.h"
+
+#if HAL_WITH_DSP
+
+#include <math.h>
+#include <new>
+#include <AP_Math/AP_Math.h>
+
+// number of windows of samples between recalculations of a channel
+#define SDFT_RESYNC_WINDOWS 16
+
+SlidingDFT::~SlidingDFT()
+{
+    delete[] _twiddle;
+    delete[] _bins;
+    delete[] _samples;
+    delete[] _samples_since_reset;
+}
+
+bool SlidingDFT::init(uint16_t fft_len, uint8_t num_channels)
+{
+    if (fft_len < 4 || num_channels == 0) {
+        return false;
+    }
+
+    delete[] _twiddle;
+    delete[] _bins;
+    delete[] _samples;
+    delete[] _samples_since_reset;
+    _len = 0;
+    _num_channels = 0;
+    _stored_bins = fft_len / 2 + 1;
+    _twiddle = NEW_NOTHROW float[6 * _stored_bins];
+    _bins = NEW_NOTHROW float[6 * _stored_bins * num_channels];
+    _samples = NEW_NOTHROW float[2 * fft_len];
+    _samples_since_reset = NEW_NOTHROW uint32_t[num_channels];
+    if (_twiddle == nullptr || _bins == nullptr || _samples == nullptr || _samples_since_reset == nullptr) {
+        return false;
+    }
+
+    // the window's cosine terms move the spectrum by N/(N-1) bins
+    const double shift = double(fft_len) / (fft_len - 1);
+    for (uint16_t k = 0; k < _stored_bins; k++) {
+        for (uint8_t t = 0; t < 3; t++) {
+            const double angle = 2.0 * M_PI * (k + (int8_t(t) - 1) * shift) / fft_len;
+            _twiddle[6*k+2*t] = cos(angle);
+            _twiddle[6*k+2*t+1] = sin(angle);
+        }
+    }
+    for (uint8_t t = 0; t < 3; t++) {
+        const double angle = -2.0 * M_PI * (int8_t(t) - 1) * shift;
+        _shift[t][0] = t == 1 ? 1 : cos(angle);
+        _shift[t][1] = t == 1 ? 0 : sin(angle);
+    }
+    for (uint8_t c = 0; c < num_channels; c++) {
+        _samples_since_reset[c] = UINT32_MAX;
+    }
+
+    _len = fft_len;
+    _num_channels = num_channels;
+    _first_bin = 0;
+    _last_bin = fft_len / 2;
+    return true;
+}
+
+void SlidingDFT::set_band(uint16_t start_bin, uint16_t end_bin)
+{
+    // peak interpolation needs the bin below the band and peak
+    // detection looks a few bins above it
+    const uint16_t first_bin = start_bin > 0 ? start_bin - 1 : 0;
+    const uint16_t last_bin = MIN(end_bin + 3, _len / 2);
+    if (first_bin == _first_bin && last_bin == _last_bin) {
+        return;
+    }
+    _first_bin = first_bin;
+    _last_bin = MAX(first_bin, last_bin);
+    for (uint8_t c = 0; c < _num_channels; c++) {
+        _samples_since_reset[c] = UINT32_MAX;
+    }
+}
+
+void SlidingDFT::update(uint8_t channel, FloatRing::Reader& samples)
+{
+    if (channel >= _num_channels) {
+        return;
+    }
+    // the oldest samples in the transform may have been overwritten
+    if (samples.take_overrun()) {
+        restart(channel);
+    }
+    uint32_t available = samples.available();
+    if (available < _len) {
+        return;
+    }
+
+    // samples we cannot add one at a time have to be dropped and the
+    // transform recalculated from the newest window
+    if (available > 2U * _len) {
+        samples.advance(available - _len);
+        available = _len;
+        restart(channel);
+    }
+    if (samples.peek(_samples, available) != available) {
+        return;
+    }
+    const uint16_t new_samples = available - _len;
+
+    if (_samples_since_reset[channel] >= uint32_t(_len) * SDFT_RESYNC_WINDOWS) {
+        reset(channel, &_samples[new_samples]);
+    } else {
+        float *bins = &_bins[6 * _stored_bins * channel];
+        const uint16_t first = 3 * _first_bin;
+        const uint16_t last = 3 * _last_bin + 2;
+        for (uint16_t n = 0; n < new_samples; n++) {
+            const float x_old = _samples[n];
+            const float x_new = _samples[_len + n];
+            for (uint16_t i = first; i <= last; i++) {
+                const float *shift = _shift[i % 3];
+                const float re = bins[2*i] - x_old + shift[0] * x_new;
+                const float im = bins[2*i+1] + shift[1] * x_new;
+                const float wr = _twiddle[2*i];
+                const float wi = _twiddle[2*i+1];
+                bins[2*i] = re * wr - im * wi;
+                bins[2*i+1] = re * wi + im * wr;
+            }
+        }
+        _samples_since_reset[channel] += new_samples;
+    }
+
+    samples.advance(new_samples);
+}
+
+// calculate the stored bins of a channel from a complete window using
+// the Goertzel algorithm
+void SlidingDFT::reset(uint8_t channel, const float *window)
+{
+    float *bins = &_bins[6 * _stored_bins * channel];
+    for (uint16_t i = 3 * _first_bin; i <= 3 * _last_bin + 2; i++) {
+        const float wr = _twiddle[2*i];
+        const float wi = _twiddle[2*i+1];
+        const float coeff = 2.0f * wr;
+        float s1 = 0, s2 = 0;
+        for (uint16_t n = 0; n < _len; n++) {
+            const float s0 = window[n] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        // the Goertzel result is rotated by exp(2*pi*j*f), undo it
+        // with the shift applied to new samples
+        const float *shift = _shift[i % 3];
+        const float re = wr * s1 - s2;
+        const float im = wi * s1;
+        bins[2*i] = re * shift[0] - im * shift[1];
+        bins[2*i+1] = re * shift[1] + im * shift[0];
+    }
+    _samples_since_reset[channel] = 0;
+}
+
+void SlidingDFT::calculate(uint8_t channel, float *output) const
+{
+    if (!valid(channel)) {
+        return;
+    }
+    const float *bins = &_bins[6 * _stored_bins * channel];
+    for (uint16_t k = _first_bin; k <= _last_bin; k++) {
+        const float *lower = &bins[6*k];
+        const float *centre = &bins[6*k+2];
+        const float *upper = &bins[6*k+4];
+        output[2*k] = 0.5f * centre[0] - 0.25f * (lower[0] + upper[0]);
+        // conjugate to match the exp(+j) convention
+        output[2*k+1] = -(0.5f * centre[1] - 0.25f * (lower[1] + upper[1]));
+    }
+}
+
+#endif // HAL_WITH_DSP
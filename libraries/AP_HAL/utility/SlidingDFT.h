@@ -0,0 +1,126 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#if HAL_WITH_DSP
+
+#include <stdint.h>
+#include <AP_Common/AP_Common.h>
+#include "SampleRing.h"
+
+/*
+  band limited sliding DFT
+
+  Rather than transforming a whole window each frame, the DFT bins in
+  the band of interest are updated once per incoming sample using the
+  recursion X[k] = (X[k] - x_old + x_new) * exp(2*pi*j*k/N). The cost
+  of a frame is proportional to the number of new samples times the
+  number of bins in the band, so frames can overlap heavily without
+  the cost of a full FFT per frame.
+
+  The FFT path uses a symmetric Hann window, 0.5 - 0.5*cos(2*pi*n/(N-1)),
+  which is not a combination of whole DFT bins. Instead the transform
+  is also tracked at the frequencies k -/+ N/(N-1) bins either side of
+  each bin k, where the window's cosine terms move the spectrum, and
+  the windowed bin is mixed from the three. The recursion for these
+  fractional frequencies needs the extra factor exp(-2*pi*j*f) on each
+  new sample.
+
+  The sample window itself is not copied, the N samples already in the
+  transform are kept at the front of the caller's reader and new
+  samples are appended behind them. Each channel is recalculated from
+  scratch with the Goertzel algorithm when it is first used, when
+  samples are dropped or overwritten and periodically to stop rounding
+  errors in the recursion from accumulating.
+ */
+class SlidingDFT {
+public:
+    SlidingDFT() {}
+    ~SlidingDFT();
+
+    CLASS_NO_COPY(SlidingDFT);
+
+    // allocate state for num_channels transforms of length fft_len
+    bool init(uint16_t fft_len, uint8_t num_channels);
+
+    /*
+      set the band that will be analysed. The bins written by
+      calculate() extend beyond the band far enough for peak detection
+      and interpolation at its edges. Changing the band restarts all
+      channels
+     */
+    void set_band(uint16_t start_bin, uint16_t end_bin);
+
+    /*
+      add the new samples in a reader to the transform of a
+      channel. The reader must hold at least fft_len samples and the
+      last fft_len samples are left in it for the next update
+     */
+    void update(uint8_t channel, FloatRing::Reader& samples);
+
+    // recalculate a channel from scratch on its next update, for
+    // instance because its samples now come from a different source
+    void restart(uint8_t channel) {
+        if (channel < _num_channels) {
+            _samples_since_reset[channel] = UINT32_MAX;
+        }
+    }
+
+    /*
+      write the Hann windowed spectrum of a channel for bins
+      first_bin() to last_bin() as interleaved real and imaginary parts
+      using the same layout, sign convention and window as RealFFT with
+      DSP::FFTWindowState::_hanning_window, so the FFT window scale
+      applies unchanged
+     */
+    void calculate(uint8_t channel, float *output) const;
+
+    // whether a channel holds a complete window
+    bool valid(uint8_t channel) const { return channel < _num_channels && _samples_since_reset[channel] != UINT32_MAX; }
+
+    uint16_t first_bin() const { return _first_bin; }
+    uint16_t last_bin() const { return _last_bin; }
+    uint16_t length() const { return _len; }
+
+private:
+    // recalculate a channel from a window of fft_len samples
+    void reset(uint8_t channel, const float *window);
+
+    uint16_t _len = 0;
+    uint8_t _num_channels = 0;
+    // bins written by calculate()
+    uint16_t _first_bin = 0;
+    uint16_t _last_bin = 0;
+    // bins stored for each channel, 0..N/2
+    uint16_t _stored_bins = 0;
+    // cos/sin pairs for exp(2*pi*j*f/N) at the three frequencies
+    // f = k - N/(N-1), k, k + N/(N-1) tracked for each bin k
+    float *_twiddle = nullptr;
+    // cos/sin pairs for exp(-2*pi*j*f) applied to new samples at each
+    // of the three frequencies, the same for every bin and 1 for the
+    // whole bin
+    float _shift[3][2];
+    // interleaved complex transforms at the three frequencies of each
+    // bin for each channel
+    float *_bins = nullptr;
+    // scratch space for the window plus up to a window of new samples
+    float *_samples = nullptr;
+    // samples added since each channel was last recalculated, UINT32_MAX if it needs recalculating
+    uint32_t *_samples_since_reset = nullptr;
+};
+
+#endif // HAL_WITH_DSP
@@ -11,3 +11,9 @@
 */
 uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n);
 
+/*
+  as above, for the packet starting ofs bytes into the buffer, with n
+  bytes available from there. Used to find several packets to send
+  in one batch
+*/
+uint16_t mavlink_packetise(const ByteBuffer &writebuf, uint32_t ofs, uint16_t n);
@@ -0,0 +1,71 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/utility/SampleRing.h>
+
+TEST(SampleRingTest, IndependentReaders)
+{
+    FloatRing ring{16};
+    FloatRing::Reader a{ring};
+    FloatRing::Reader b{ring};
+    EXPECT_EQ(ring.get_size(), 16U);
+    EXPECT_EQ(a.available(), 0U);
+
+    for (uint8_t i = 0; i < 10; i++) {
+        ring.push(i);
+    }
+    EXPECT_EQ(a.available(), 10U);
+    EXPECT_EQ(b.available(), 10U);
+
+    // advancing one reader leaves the other untouched
+    EXPECT_TRUE(a.advance(4));
+    EXPECT_EQ(a.available(), 6U);
+    EXPECT_EQ(b.available(), 10U);
+    EXPECT_FALSE(a.advance(7));
+
+    float buf[16] {};
+    EXPECT_EQ(a.peek(buf, 16), 6U);
+    EXPECT_FLOAT_EQ(buf[0], 4);
+    EXPECT_FLOAT_EQ(buf[5], 9);
+
+    float f;
+    EXPECT_TRUE(b.pop(f));
+    EXPECT_FLOAT_EQ(f, 0);
+    EXPECT_EQ(b.available(), 9U);
+
+    // a reader attached later starts from the oldest sample
+    FloatRing::Reader c{ring};
+    EXPECT_EQ(c.available(), 10U);
+}
+
+TEST(SampleRingTest, Overrun)
+{
+    FloatRing ring{8};
+    FloatRing::Reader r{ring};
+
+    // the producer never blocks, a slow reader loses the oldest samples
+    for (uint8_t i = 0; i < 20; i++) {
+        ring.push(i);
+    }
+    EXPECT_EQ(r.available(), 8U);
+    EXPECT_TRUE(r.take_overrun());
+    EXPECT_FALSE(r.take_overrun());
+    EXPECT_EQ(r.overrun_count(), 1U);
+
+    float buf[8] {};
+    EXPECT_EQ(r.peek(buf, 8), 8U);
+    EXPECT_FLOAT_EQ(buf[0], 12);
+    EXPECT_FLOAT_EQ(buf[7], 19);
+
+    // wraparound of the internal storage
+    EXPECT_TRUE(r.advance(5));
+    const float block[] { 20, 21, 22, 23, 24 };
+    ring.push(block, 5);
+    EXPECT_EQ(r.available(), 8U);
+    EXPECT_EQ(r.peek(buf, 8), 8U);
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_FLOAT_EQ(buf[i], 17 + i);
+    }
+    EXPECT_FALSE(r.take_overrun());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,135 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/utility/SlidingDFT.h>
+#include <AP_HAL/utility/RealFFT.h>
+#include <AP_Math/AP_Math.h>
+
+#if HAL_WITH_DSP
+
+#define TEST_DFT_LEN 64
+
+/*
+  a sine between bins, with some DC and a weaker second tone, so the
+  window leaks into the bins around the peak
+ */
+static float test_signal(uint32_t n)
+{
+    return 0.3f +
+        sinf(2 * M_PI * 10.3f * n / TEST_DFT_LEN) +
+        0.2f * cosf(2 * M_PI * 21.7f * n / TEST_DFT_LEN + 0.5f);
+}
+
+// the symmetric Hann window used by DSP::FFTWindowState
+static void hann_window(float *window)
+{
+    for (uint16_t i = 0; i < TEST_DFT_LEN; i++) {
+        window[i] = 0.5f - 0.5f * cosf(2.0f * M_PI * i / (TEST_DFT_LEN - 1.0f));
+    }
+}
+
+/*
+  compare the band of a sliding DFT against an FFT of the same window
+  of samples
+ */
+static void check_against_fft(SlidingDFT &sdft, RealFFT &rfft, const float *window, uint32_t first_sample)
+{
+    float input[TEST_DFT_LEN];
+    for (uint16_t i = 0; i < TEST_DFT_LEN; i++) {
+        input[i] = test_signal(first_sample + i);
+    }
+    float fft_out[TEST_DFT_LEN + 2];
+    float sdft_out[TEST_DFT_LEN + 2];
+    rfft.calculate(input, window, fft_out);
+    sdft.calculate(0, sdft_out);
+
+    uint16_t fft_peak = 0, sdft_peak = 0;
+    float fft_max = 0, sdft_max = 0;
+    for (uint16_t k = sdft.first_bin(); k <= sdft.last_bin(); k++) {
+        const float fft_mag = norm(fft_out[2*k], fft_out[2*k+1]);
+        const float sdft_mag = norm(sdft_out[2*k], sdft_out[2*k+1]);
+        EXPECT_NEAR(sdft_out[2*k], fft_out[2*k], 1e-3) << "bin " << k;
+        EXPECT_NEAR(sdft_out[2*k+1], fft_out[2*k+1], 1e-3) << "bin " << k;
+        if (fft_mag > fft_max) {
+            fft_max = fft_mag;
+            fft_peak = k;
+        }
+        if (sdft_mag > sdft_max) {
+            sdft_max = sdft_mag;
+            sdft_peak = k;
+        }
+    }
+    EXPECT_EQ(sdft_peak, fft_peak);
+    EXPECT_NEAR(sdft_max, fft_max, fft_max * 1e-4);
+}
+
+TEST(SlidingDFTTest, MatchesRealFFT)
+{
+    SlidingDFT sdft;
+    RealFFT rfft;
+    ASSERT_TRUE(sdft.init(TEST_DFT_LEN, 1));
+    ASSERT_TRUE(rfft.init(TEST_DFT_LEN));
+    sdft.set_band(2, 28);
+    EXPECT_EQ(sdft.first_bin(), 1U);
+    EXPECT_EQ(sdft.last_bin(), 31U);
+
+    float window[TEST_DFT_LEN];
+    hann_window(window);
+
+    FloatRing ring{4 * TEST_DFT_LEN};
+    FloatRing::Reader reader{ring};
+    uint32_t n = 0;
+
+    // the first full window is calculated directly
+    while (n < TEST_DFT_LEN) {
+        ring.push(test_signal(n++));
+    }
+    sdft.update(0, reader);
+    ASSERT_TRUE(sdft.valid(0));
+    check_against_fft(sdft, rfft, window, n - TEST_DFT_LEN);
+
+    // later windows come from the sliding recursion, in steps of
+    // different sizes
+    for (uint8_t step = 1; step < 24; step += 3) {
+        for (uint8_t i = 0; i < step; i++) {
+            ring.push(test_signal(n++));
+        }
+        sdft.update(0, reader);
+        EXPECT_EQ(reader.available(), uint32_t(TEST_DFT_LEN));
+        check_against_fft(sdft, rfft, window, n - TEST_DFT_LEN);
+    }
+}
+
+TEST(SlidingDFTTest, WholeSpectrum)
+{
+    SlidingDFT sdft;
+    RealFFT rfft;
+    ASSERT_TRUE(sdft.init(TEST_DFT_LEN, 2));
+    ASSERT_TRUE(rfft.init(TEST_DFT_LEN));
+    // the band can extend from DC to Nyquist
+    sdft.set_band(0, TEST_DFT_LEN / 2);
+    EXPECT_EQ(sdft.first_bin(), 0U);
+    EXPECT_EQ(sdft.last_bin(), uint16_t(TEST_DFT_LEN / 2));
+
+    float window[TEST_DFT_LEN];
+    hann_window(window);
+
+    FloatRing ring{4 * TEST_DFT_LEN};
+    FloatRing::Reader reader{ring};
+    uint32_t n = 0;
+    while (n < TEST_DFT_LEN + 5) {
+        ring.push(test_signal(n++));
+    }
+    // channels are not valid until they have been updated
+    EXPECT_FALSE(sdft.valid(1));
+    sdft.update(0, reader);
+    check_against_fft(sdft, rfft, window, n - TEST_DFT_LEN);
+    for (uint8_t i = 0; i < 7; i++) {
+        ring.push(test_signal(n++));
+    }
+    sdft.update(0, reader);
+    check_against_fft(sdft, rfft, window, n - TEST_DFT_LEN);
+}
+
+#endif // HAL_WITH_DSP
+
+AP_GTEST_MAIN()
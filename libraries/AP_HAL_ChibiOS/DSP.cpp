@@ -61,9 +61,9 @@ AP_HAL::DSP::FFTWindowState* DSP::fft_init(uint16_t window_size, uint16_t sample
 }
 
 // start an FFT analysis
-void DSP::fft_start(FFTWindowState* state, FloatBuffer& samples, uint16_t advance)
+bool DSP::fft_start(FFTWindowState* state, FloatRing::Reader& samples, uint16_t advance)
 {
-    step_hanning((FFTWindowStateARM*)state, samples, advance);
+    return step_hanning((FFTWindowStateARM*)state, samples, advance);
 }
 
 // perform remaining steps of an FFT analysis
@@ -127,18 +127,24 @@ extern "C" {
 }
 
 // step 1: filter the incoming samples through a Hanning window
-void DSP::step_hanning(FFTWindowStateARM* fft, FloatBuffer& samples, uint16_t advance)
+bool DSP::step_hanning(FFTWindowStateARM* fft, FloatRing::Reader& samples, uint16_t advance)
 {
     TIMER_START(_hanning_timer);
 
     // 5us
     // apply hanning window to gyro samples and store result in _freq_bins
     // hanning starts and ends with 0, could be skipped for minor speed improvement
-    samples.peek(&fft->_freq_bins[0], fft->_window_size); // the caller ensures we get a full buffer of samples
+    // the caller ensures there is a full buffer of samples, but the producer
+    // may overwrite them while they are copied in which case this cycle is skipped
+    if (samples.peek(&fft->_freq_bins[0], fft->_window_size) != fft->_window_size) {
+        TIMER_END(_hanning_timer);
+        return false;
+    }
     samples.advance(advance);
     arm_mult_f32(&fft->_freq_bins[0], &fft->_hanning_window[0], &fft->_freq_bins[0], fft->_window_size);
 
     TIMER_END(_hanning_timer);
+    return true;
 }
 
 // step 2: guts of complex fft processing
@@ -31,7 +31,7 @@ public:
     // initialise an FFT instance
     virtual FFTWindowState* fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size) override;
     // start an FFT analysis with an ObjectBuffer
-    virtual void fft_start(FFTWindowState* state, FloatBuffer& samples, uint16_t advance) override;
+    virtual bool fft_start(FFTWindowState* state, FloatRing::Reader& samples, uint16_t advance) override;
     // perform remaining steps of an FFT analysis
     virtual uint16_t fft_analyse(FFTWindowState* state, uint16_t start_bin, uint16_t end_bin, float noise_att_cutoff) override;
 
@@ -67,7 +67,7 @@ protected:
 
 private:
     // following are the six independent steps for calculating an FFT
-    void step_hanning(FFTWindowStateARM* fft, FloatBuffer& samples, uint16_t advance);
+    bool step_hanning(FFTWindowStateARM* fft, FloatRing::Reader& samples, uint16_t advance);
     void step_arm_cfft_f32(FFTWindowStateARM* fft);
     void step_bitreversal(FFTWindowStateARM* fft);
     void step_stage_rfft_f32(FFTWindowStateARM* fft);
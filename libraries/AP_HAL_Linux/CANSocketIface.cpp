@@ -37,9 +37,12 @@
 #include <net/if.h>
 #include <linux/can/raw.h>
 #include <cstring>
+#include <algorithm>
+#include <time.h>
 #include "Scheduler.h"
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -51,6 +54,10 @@ using namespace Linux;
 #define Debug(fmt, args...)
 #endif
 
+// kernel receive timestamps older than this are taken to come from a
+// step of the realtime clock, and the frame is stamped on reception
+#define CAN_RX_TIMESTAMP_MAX_AGE_US 1000000ULL
+
 static can_frame makeSocketCanFrame(const AP_HAL::CANFrame& uavcan_frame)
 {
     can_frame sockcan_frame { uavcan_frame.id& AP_HAL::CANFrame::MaskExtID, uavcan_frame.dlc, { } };
@@ -166,9 +173,12 @@ int16_t CANIface::send(const AP_HAL::CANFrame& frame, const uint64_t tx_deadline
     tx_item.index = _tx_frame_counter;
     tx_item.deadline = tx_deadline;
     WITH_SEMAPHORE(sem);
-    _tx_queue.emplace(tx_item);
-    _tx_frame_counter++;
     stats.tx_requests++;
+    if (!_txPush(tx_item)) {
+        stats.tx_queue_full++;
+        return 0;
+    }
+    _tx_frame_counter++;
     _pollRead();     // Read poll is necessary because it can release the pending TX flag
     _pollWrite();
     return AP_HAL::CANIface::send(frame, tx_deadline, flags);
@@ -178,19 +188,16 @@ int16_t CANIface::receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_u
                           CANIface::CanIOFlags& out_flags)
 {
     WITH_SEMAPHORE(sem);
-    if (_rx_queue.empty()) {
+    if (_rx_queue.is_empty()) {
         _pollRead();            // This allows to use the socket not calling poll() explicitly.
-        if (_rx_queue.empty()) {
-            return 0;
-        }
     }
-    {
-        const CanRxItem& rx = _rx_queue.front();
-        out_frame        = rx.frame;
-        out_timestamp_us = rx.timestamp_us;
-        out_flags        = rx.flags;
+    CanRxItem rx;
+    if (!_rx_queue.pop(rx)) {
+        return 0;
     }
-    (void)_rx_queue.pop();
+    out_frame        = rx.frame;
+    out_timestamp_us = rx.timestamp_us;
+    out_flags        = rx.flags;
     if (sem_handle != nullptr) {
         sem_handle->signal();
     }
@@ -200,13 +207,47 @@ int16_t CANIface::receive(AP_HAL::CANFrame& out_frame, uint64_t& out_timestamp_u
 bool CANIface::_hasReadyTx()
 {
     WITH_SEMAPHORE(sem);
-    return !_tx_queue.empty() && (_frames_in_socket_tx_queue < _max_frames_in_socket_tx_queue);
+    return _tx_queue_len > 0 && (_frames_in_socket_tx_queue < _max_frames_in_socket_tx_queue);
 }
 
 bool CANIface::_hasReadyRx()
 {
     WITH_SEMAPHORE(sem);
-    return !_rx_queue.empty();
+    return !_rx_queue.is_empty();
+}
+
+/*
+  add a frame to the transmit heap, false if the heap is full
+ */
+bool CANIface::_txPush(const CanTxItem &item)
+{
+    if (_tx_queue_len >= HAL_LINUX_CAN_TX_QUEUE_SIZE) {
+        return false;
+    }
+    _tx_queue[_tx_queue_len++] = item;
+    std::push_heap(_tx_queue, _tx_queue + _tx_queue_len);
+    stats.tx_queue_max = MAX(stats.tx_queue_max, _tx_queue_len);
+    return true;
+}
+
+/*
+  remove the highest priority frame from the transmit heap, which
+  must not be empty
+ */
+void CANIface::_txPop(CanTxItem &item)
+{
+    std::pop_heap(_tx_queue, _tx_queue + _tx_queue_len);
+    item = _tx_queue[--_tx_queue_len];
+}
+
+bool CANIface::add_to_rx_queue(const CanRxItem &rx_item)
+{
+    if (!_rx_queue.push(rx_item)) {
+        stats.rx_overflow++;
+        return false;
+    }
+    stats.rx_queue_max = MAX(stats.rx_queue_max, uint16_t(_rx_queue.available()));
+    return true;
 }
 
 void CANIface::_poll(bool read, bool write)
@@ -265,134 +306,234 @@ uint32_t CANIface::getErrorCount() const
     return ec;
 }
 
+/*
+  hand frames to the socket in priority order, in batches of up to
+  the number the in flight limit allows
+ */
 void CANIface::_pollWrite()
 {
+    WITH_SEMAPHORE(sem);
     while (_hasReadyTx()) {
-        WITH_SEMAPHORE(sem);
-        const CanTxItem tx = _tx_queue.top();
-        uint64_t curr_time = AP_HAL::micros64();
-        if (tx.deadline >= curr_time) {
-            // hal.console->printf("%x TDEAD: %lu CURRT: %lu DEL: %lu\n",tx.frame.id,  tx.deadline, curr_time, tx.deadline-curr_time);
-            const int res = _write(tx.frame);
-            if (res == 1) {                   // Transmitted successfully
+        CanTxItem batch[HAL_LINUX_CAN_IO_BATCH];
+        const uint8_t limit = MIN(unsigned(HAL_LINUX_CAN_IO_BATCH),
+                                  _max_frames_in_socket_tx_queue - _frames_in_socket_tx_queue);
+        const uint64_t curr_time = AP_HAL::micros64();
+        uint8_t n = 0;
+        while (n < limit && _tx_queue_len > 0) {
+            _txPop(batch[n]);
+            if (batch[n].deadline >= curr_time) {
+                n++;
+            } else {
+                stats.tx_timedout++;
+            }
+        }
+        if (n == 0) {
+            continue;
+        }
+
+        const int res = _write(batch, n);
+        uint8_t done;
+        if (res > 0) {                        // Transmitted successfully
+            done = res;
+            for (uint8_t i = 0; i < done; i++) {
                 _incrementNumFramesInSocketTxQueue();
-                if (tx.loopback) {
-                    _pending_loopback_ids.insert(tx.frame.id);
+                if (batch[i].loopback) {
+                    // the oldest entry is dropped if its loopback was lost
+                    if (_num_pending_loopback == ARRAY_SIZE(_pending_loopback_ids)) {
+                        memmove(&_pending_loopback_ids[0], &_pending_loopback_ids[1],
+                                sizeof(_pending_loopback_ids[0]) * (_num_pending_loopback - 1));
+                        _num_pending_loopback--;
+                    }
+                    _pending_loopback_ids[_num_pending_loopback++] = batch[i].frame.id;
                 }
-                stats.tx_success++;
-                stats.last_transmit_us = curr_time;
-            } else if (res == 0) {            // Not transmitted, nor is it an error
-                stats.tx_overflow++;
-                break;                        // Leaving the loop, the frame remains enqueued for the next retry
-            } else {                          // Transmission error
-                stats.tx_rejected++;
             }
-        } else {
-            // hal.console->printf("TDEAD: %lu CURRT: %lu DEL: %lu\n", tx.deadline, curr_time, curr_time-tx.deadline);
-            stats.tx_timedout++;
+            stats.tx_success += done;
+            stats.last_transmit_us = curr_time;
+            stats.num_tx_batches++;
+            stats.tx_batch_max = MAX(stats.tx_batch_max, uint16_t(done));
+        } else if (res == 0) {                // Not transmitted, nor is it an error
+            stats.tx_overflow++;
+            done = 0;
+        } else {                              // Transmission error, the first frame is dropped
+            stats.tx_rejected++;
+            done = 1;
         }
 
-        // Removing the frame from the queue even if transmission failed
-        (void)_tx_queue.pop();
+        // frames the socket did not take remain enqueued for the next retry
+        for (uint8_t i = done; i < n; i++) {
+            _txPush(batch[i]);
+        }
+        if (res == 0 || (res > 0 && done < n)) {
+            break;
+        }
     }
 }
 
+/*
+  move all frames waiting in the socket to the receive queue, a batch
+  at a time
+ */
 bool CANIface::_pollRead()
 {
+    bool received = false;
     uint8_t iterations_count = 0;
     while (iterations_count < CAN_MAX_POLL_ITERATIONS_COUNT)
     {
         iterations_count++;
-        CanRxItem rx;
-        rx.timestamp_us = AP_HAL::micros64();  // Monotonic timestamp is not required to be precise (unlike UTC)
-        bool loopback = false;
-        const int res = _read(rx.frame, rx.timestamp_us, loopback);
-        if (res == 1) {
+        CanRxItem rx[HAL_LINUX_CAN_IO_BATCH];
+        bool loopback[HAL_LINUX_CAN_IO_BATCH];
+        const int res = _read(rx, loopback, HAL_LINUX_CAN_IO_BATCH);
+        if (res < 0) {
+            stats.rx_errors++;
+            break;
+        }
+        if (res == 0) {
+            break;
+        }
+        WITH_SEMAPHORE(sem);
+        const uint64_t now_us = AP_HAL::micros64();
+        stats.num_rx_batches++;
+        stats.rx_batch_max = MAX(stats.rx_batch_max, uint16_t(res));
+        for (uint8_t i = 0; i < res; i++) {
+            stats.rx_delay_max_us = MAX(stats.rx_delay_max_us, uint32_t(now_us - rx[i].timestamp_us));
             bool accept = true;
-            if (loopback) {           // We receive loopback for all CAN frames
+            if (loopback[i]) {        // We receive loopback for all CAN frames
                 _confirmSentFrame();
-                rx.flags |= Loopback;
-                accept = _wasInPendingLoopbackSet(rx.frame);
+                rx[i].flags |= Loopback;
+                accept = _wasInPendingLoopbackSet(rx[i].frame);
                 stats.tx_confirmed++;
             }
-            if (accept) {
-                WITH_SEMAPHORE(sem);
-                _rx_queue.push(rx);
+            if (accept && add_to_rx_queue(rx[i])) {
                 stats.rx_received++;
-                return true;
+                received = true;
             }
-        } else if (res == 0) {
-            break;
-        } else {
-            stats.rx_errors++;
+        }
+        if (res < HAL_LINUX_CAN_IO_BATCH) {
+            // the socket is empty, or the rest of its frames were
+            // filtered and are read on the next poll
             break;
         }
     }
-    return false;
+    return received;
 }
 
-int CANIface::_write(const AP_HAL::CANFrame& frame) const
+/*
+  send frames with one system call. Returns the number of frames the
+  socket took, 0 if it could take none and -1 if the first frame
+  failed
+ */
+int CANIface::_write(const CanTxItem *items, uint8_t count) const
 {
     if (_fd < 0) {
         return -1;
     }
     errno = 0;
 
-    const can_frame sockcan_frame = makeSocketCanFrame(frame);
+    can_frame sockcan_frames[HAL_LINUX_CAN_IO_BATCH];
+    iovec iov[HAL_LINUX_CAN_IO_BATCH];
+    mmsghdr msgs[HAL_LINUX_CAN_IO_BATCH] {};
+    count = MIN(count, uint8_t(HAL_LINUX_CAN_IO_BATCH));
+    for (uint8_t i = 0; i < count; i++) {
+        sockcan_frames[i] = makeSocketCanFrame(items[i].frame);
+        iov[i].iov_base = &sockcan_frames[i];
+        iov[i].iov_len = sizeof(sockcan_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
 
-    const int res = write(_fd, &sockcan_frame, sizeof(sockcan_frame));
+    const int res = sendmmsg(_fd, msgs, count, MSG_DONTWAIT);
     if (res <= 0) {
-        if (errno == ENOBUFS || errno == EAGAIN) {  // Writing is not possible atm, not an error
+        if (res == 0 || errno == ENOBUFS || errno == EAGAIN) {  // Writing is not possible atm, not an error
             return 0;
         }
-        return res;
-    }
-    if (res != sizeof(sockcan_frame)) {
         return -1;
     }
-    return 1;
+    return res;
 }
 
+/*
+  convert a SO_TIMESTAMP receive time, which is on the realtime clock,
+  to the monotonic time base
+ */
+static uint64_t rx_timestamp_monotonic(const msghdr &msg, uint64_t now_us, uint64_t now_realtime_us)
+{
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(const_cast<msghdr *>(&msg), cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_TIMESTAMP) {
+            continue;
+        }
+        ::timeval tv;
+        memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+        const uint64_t rx_realtime_us = uint64_t(tv.tv_sec) * 1000000ULL + tv.tv_usec;
+        if (rx_realtime_us <= now_realtime_us &&
+            now_realtime_us - rx_realtime_us < CAN_RX_TIMESTAMP_MAX_AGE_US) {
+            return now_us - (now_realtime_us - rx_realtime_us);
+        }
+        break;
+    }
+    return now_us;
+}
 
-int CANIface::_read(AP_HAL::CANFrame& frame, uint64_t& timestamp_us, bool& loopback) const
+/*
+  receive up to max_count frames with one system call, stamped with
+  the time the kernel received them. Returns the number of frames
+  passing the filters, 0 if none were waiting or -1 on error
+ */
+int CANIface::_read(CanRxItem *items, bool *loopback, uint8_t max_count) const
 {
     if (_fd < 0) {
         return -1;
     }
-    auto iov = iovec();
-    auto sockcan_frame = can_frame();
-    iov.iov_base = &sockcan_frame;
-    iov.iov_len  = sizeof(sockcan_frame);
+    max_count = MIN(max_count, uint8_t(HAL_LINUX_CAN_IO_BATCH));
+
+    can_frame sockcan_frames[HAL_LINUX_CAN_IO_BATCH];
+    iovec iov[HAL_LINUX_CAN_IO_BATCH];
     union {
         uint8_t data[CMSG_SPACE(sizeof(::timeval))];
         struct cmsghdr align;
-    } control;
-
-    auto msg = msghdr();
-    msg.msg_iov    = &iov;
-    msg.msg_iovlen = 1;
-    msg.msg_control = control.data;
-    msg.msg_controllen = sizeof(control.data);
-
-    const int res = recvmsg(_fd, &msg, MSG_DONTWAIT);
+    } control[HAL_LINUX_CAN_IO_BATCH];
+    mmsghdr msgs[HAL_LINUX_CAN_IO_BATCH] {};
+    for (uint8_t i = 0; i < max_count; i++) {
+        iov[i].iov_base = &sockcan_frames[i];
+        iov[i].iov_len  = sizeof(sockcan_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i].data;
+        msgs[i].msg_hdr.msg_controllen = sizeof(control[i].data);
+    }
+
+    const int res = recvmmsg(_fd, msgs, max_count, MSG_DONTWAIT, nullptr);
     if (res <= 0) {
         return (res < 0 && errno == EWOULDBLOCK) ? 0 : res;
     }
-    /*
-     * Flags
-     */
-    loopback = (msg.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
 
-    if (!loopback && !_checkHWFilters(sockcan_frame)) {
-        return 0;
-    }
+    const uint64_t now_us = AP_HAL::micros64();
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const uint64_t now_realtime_us = uint64_t(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000U;
+
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < res; i++) {
+        if (msgs[i].msg_len != sizeof(can_frame)) {
+            continue;
+        }
+        /*
+         * Flags
+         */
+        loopback[n] = (msgs[i].msg_hdr.msg_flags & static_cast<int>(MSG_CONFIRM)) != 0;
 
-    frame = makeUavcanFrame(sockcan_frame);
-    /*
-     * Timestamp
-     */
-    timestamp_us = AP_HAL::micros64();
-    return 1;
+        if (!loopback[n] && !_checkHWFilters(sockcan_frames[i])) {
+            continue;
+        }
+
+        items[n] = CanRxItem();
+        items[n].frame = makeUavcanFrame(sockcan_frames[i]);
+        /*
+         * Timestamp
+         */
+        items[n].timestamp_us = rx_timestamp_monotonic(msgs[i].msg_hdr, now_us, now_realtime_us);
+        n++;
+    }
+    return n;
 }
 
 // Might block forever, only to be used for testing
@@ -402,15 +543,14 @@ void CANIface::flush_tx()
     do {
         _updateDownStatusFromPollResult(_pollfd);
         _poll(true, true);
-    } while(!_tx_queue.empty() && !_down);
+    } while(_tx_queue_len > 0 && !_down);
 }
 
 void CANIface::clear_rx()
 {
     WITH_SEMAPHORE(sem);
     // Clean Rx Queue
-    std::queue<CanRxItem> empty;
-    std::swap( _rx_queue, empty );
+    _rx_queue.clear();
 }
 
 void CANIface::_incrementNumFramesInSocketTxQueue()
@@ -427,9 +567,13 @@ void CANIface::_confirmSentFrame()
 
 bool CANIface::_wasInPendingLoopbackSet(const AP_HAL::CANFrame& frame)
 {
-    if (_pending_loopback_ids.count(frame.id) > 0) {
-        _pending_loopback_ids.erase(frame.id);
-        return true;
+    for (uint8_t i = 0; i < _num_pending_loopback; i++) {
+        if (_pending_loopback_ids[i] == frame.id) {
+            _num_pending_loopback--;
+            memmove(&_pending_loopback_ids[i], &_pending_loopback_ids[i+1],
+                    sizeof(_pending_loopback_ids[0]) * (_num_pending_loopback - i));
+            return true;
+        }
     }
     return false;
 }
@@ -552,7 +696,16 @@ void CANIface::get_stats(ExpandingString &str)
                "num_tx_poll_req:  %u\n"
                "num_poll_waits:   %u\n"
                "num_poll_tx_events: %u\n"
-               "num_poll_rx_events: %u\n",
+               "num_poll_rx_events: %u\n"
+               "tx_queue_full:  %u\n"
+               "tx_queue_max:   %u/%u\n"
+               "rx_overflow:    %u\n"
+               "rx_queue_max:   %u/%u\n"
+               "num_tx_batches: %u\n"
+               "tx_batch_max:   %u\n"
+               "num_rx_batches: %u\n"
+               "rx_batch_max:   %u\n"
+               "rx_delay_max_us: %u\n",
                stats.tx_requests,
                stats.tx_rejected,
                stats.tx_overflow,
@@ -566,7 +719,16 @@ void CANIface::get_stats(ExpandingString &str)
                stats.num_tx_poll_req,
                stats.num_poll_waits,
                stats.num_poll_tx_events,
-               stats.num_poll_rx_events);
+               stats.num_poll_rx_events,
+               stats.tx_queue_full,
+               stats.tx_queue_max, unsigned(HAL_LINUX_CAN_TX_QUEUE_SIZE),
+               stats.rx_overflow,
+               stats.rx_queue_max, unsigned(HAL_LINUX_CAN_RX_QUEUE_SIZE),
+               stats.num_tx_batches,
+               stats.tx_batch_max,
+               stats.num_rx_batches,
+               stats.rx_batch_max,
+               stats.rx_delay_max_us);
 }
 
 #endif
@@ -31,14 +31,14 @@
 #if HAL_NUM_CAN_IFACES
 
 #include <AP_HAL/CANIface.h>
+#include <AP_HAL/utility/RingBuffer.h>
 
 #include <linux/can.h>
 
 #include <string>
-#include <queue>
 #include <memory>
 #include <map>
-#include <unordered_set>
+#include <vector>
 #include <poll.h>
 
 namespace Linux {
@@ -54,12 +54,40 @@ enum class SocketCanError
 #define CAN_MAX_INIT_TRIES_COUNT 100
 #define CAN_FILTER_NUMBER 8
 
+// number of received frames buffered per interface
+#ifndef HAL_LINUX_CAN_RX_QUEUE_SIZE
+#define HAL_LINUX_CAN_RX_QUEUE_SIZE 256
+#endif
+
+// number of frames waiting for transmission per interface
+#ifndef HAL_LINUX_CAN_TX_QUEUE_SIZE
+#define HAL_LINUX_CAN_TX_QUEUE_SIZE 128
+#endif
+
+// most frames moved in a single recvmmsg or sendmmsg call
+#ifndef HAL_LINUX_CAN_IO_BATCH
+#define HAL_LINUX_CAN_IO_BATCH 16
+#endif
+
+// most frames handed to the socket and not yet looped back. The
+// socket queue is FIFO, so a frame may wait behind this many frames
+// of lower priority
+#ifndef HAL_LINUX_CAN_MAX_TX_IN_FLIGHT
+#define HAL_LINUX_CAN_MAX_TX_IN_FLIGHT 8
+#endif
+
+static_assert(HAL_LINUX_CAN_IO_BATCH <= 255, "Invalid CAN batch size");
+static_assert(HAL_LINUX_CAN_MAX_TX_IN_FLIGHT <= HAL_LINUX_CAN_TX_QUEUE_SIZE, "Invalid CAN Tx in flight count");
+
 class CANIface: public AP_HAL::CANIface {
 public:
     CANIface(int index)
       : _self_index(index)
+      , _max_frames_in_socket_tx_queue(HAL_LINUX_CAN_MAX_TX_IN_FLIGHT)
       , _frames_in_socket_tx_queue(0)
-      , _max_frames_in_socket_tx_queue(2)
+      , _tx_queue_len(0)
+      , _rx_queue(HAL_LINUX_CAN_RX_QUEUE_SIZE)
+      , _num_pending_loopback(0)
     { }
 
     ~CANIface() { }
@@ -120,9 +148,13 @@ private:
 
     bool _pollRead();
 
-    int _write(const AP_HAL::CANFrame& frame) const;
+    int _write(const CanTxItem *items, uint8_t count) const;
+
+    int _read(CanRxItem *items, bool *loopback, uint8_t max_count) const;
 
-    int _read(AP_HAL::CANFrame& frame, uint64_t& ts_usec, bool& loopback) const;
+    bool _txPush(const CanTxItem &item);
+
+    void _txPop(CanTxItem &item);
 
     void _incrementNumFramesInSocketTxQueue();
 
@@ -158,9 +190,18 @@ private:
 
     pollfd _pollfd;
     std::map<SocketCanError, uint64_t> _errors;
-    std::priority_queue<CanTxItem> _tx_queue;
-    std::queue<CanRxItem> _rx_queue;
-    std::unordered_multiset<uint32_t> _pending_loopback_ids;
+
+    // frames waiting for transmission, kept as a heap with the
+    // highest priority frame first
+    CanTxItem _tx_queue[HAL_LINUX_CAN_TX_QUEUE_SIZE];
+    uint16_t _tx_queue_len;
+
+    ObjectBuffer<CanRxItem> _rx_queue;
+
+    // ids of sent frames whose loopback was requested by the caller
+    uint32_t _pending_loopback_ids[HAL_LINUX_CAN_MAX_TX_IN_FLIGHT];
+    uint8_t _num_pending_loopback;
+
     std::vector<can_filter> _hw_filters_container;
 
     struct bus_stats : public AP_HAL::CANIface::bus_stats_t {
@@ -171,13 +212,18 @@ private:
         uint32_t num_poll_waits;
         uint32_t num_poll_tx_events;
         uint32_t num_poll_rx_events;
+        uint32_t tx_queue_full;
+        uint32_t num_tx_batches;
+        uint32_t num_rx_batches;
+        uint16_t tx_batch_max;
+        uint16_t rx_batch_max;
+        uint16_t tx_queue_max;
+        uint16_t rx_queue_max;
+        uint32_t rx_delay_max_us;
     } stats;
 
 protected:
-    bool add_to_rx_queue(const CanRxItem &rx_item) override {
-        _rx_queue.push(rx_item);
-        return true;
-    }
+    bool add_to_rx_queue(const CanRxItem &rx_item) override;
 
     int8_t get_iface_num(void) const override {
         return _self_index;
@@ -5,6 +5,7 @@
 #include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
@@ -46,6 +47,7 @@
 #include "Util.h"
 #include "Util_RPI.h"
 #include "CANSocketIface.h"
+#include "DSP.h"
 
 using namespace Linux;
 
@@ -252,7 +254,7 @@ static Empty::OpticalFlow opticalFlow;
 #endif
 
 #if HAL_WITH_DSP
-static Empty::DSP dspDriver;
+static DSP dspDriver;
 #endif
 static Empty::Flash flashDriver;
 static Empty::WSPIDeviceManager wspi_mgr_instance;
@@ -340,6 +342,8 @@ void _usage(void)
     printf("\tcpu affinity:\n");
     printf("\t                   --cpu-affinity 1 (single cpu) or 1,3 (multiple cpus) or 1-3 (range of cpus)\n");
     printf("\t                   -c 1 (single cpu) or 1,3 (multiple cpus) or 1-3 (range of cpus)\n");
+    printf("\tthread cpu affinity:\n");
+    printf("\t                   --thread-affinity apm_fft:3 (run the FFT thread on cpu 3)\n");
 }
 
 void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
@@ -359,6 +363,7 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         CMDLINE_SERIAL7,
         CMDLINE_SERIAL8,
         CMDLINE_SERIAL9,
+        CMDLINE_THREAD_AFFINITY,
     };
 
     int opt;
@@ -389,6 +394,7 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"module-directory",    true,  0, 'M'},
         {"defaults",            true,  0, 'd'},
         {"cpu-affinity",        true,  0, 'c'},
+        {"thread-affinity",     true,  0, CMDLINE_THREAD_AFFINITY},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
@@ -458,6 +464,24 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
             }
             Linux::Scheduler::from(scheduler)->set_cpu_affinity(cpu_affinity);
             break;
+        case CMDLINE_THREAD_AFFINITY: {
+            // NAME:CPUS
+            char thread_name[16];
+            const char *sep = strchr(gopt.optarg, ':');
+            cpu_set_t thread_affinity;
+            if (sep == nullptr || size_t(sep - gopt.optarg) >= sizeof(thread_name)) {
+                fprintf(stderr, "Thread affinity must be NAME:CPUS: %s\n", gopt.optarg);
+                exit(1);
+            }
+            strncpy(thread_name, gopt.optarg, sep - gopt.optarg);
+            thread_name[sep - gopt.optarg] = 0;
+            if (!utilInstance.parse_cpu_set(sep+1, &thread_affinity) ||
+                !Linux::Scheduler::from(scheduler)->set_thread_cpu_affinity(thread_name, thread_affinity)) {
+                fprintf(stderr, "Could not set thread affinity: %s\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+        }
         case 'h':
             _usage();
             exit(0);
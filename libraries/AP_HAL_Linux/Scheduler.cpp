@@ -5,6 +5,7 @@
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -403,6 +404,18 @@ uint8_t Scheduler::calculate_thread_priority(priority_base base, int8_t priority
     return thread_priority;
 }
 
+bool Scheduler::set_thread_cpu_affinity(const char *name, const cpu_set_t &cpu_affinity)
+{
+    if (_num_thread_affinity >= max_thread_affinity ||
+        strlen(name) >= sizeof(_thread_affinity[0].name)) {
+        return false;
+    }
+    strncpy(_thread_affinity[_num_thread_affinity].name, name, sizeof(_thread_affinity[0].name));
+    _thread_affinity[_num_thread_affinity].cpu_affinity = cpu_affinity;
+    _num_thread_affinity++;
+    return true;
+}
+
 /*
   create a new thread
 */
@@ -424,6 +437,13 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
      */
     thread->set_auto_free(true);
 
+    for (uint8_t i=0; i<_num_thread_affinity; i++) {
+        if (name != nullptr && strncmp(name, _thread_affinity[i].name, sizeof(_thread_affinity[i].name)) == 0) {
+            thread->set_cpu_affinity(_thread_affinity[i].cpu_affinity);
+            break;
+        }
+    }
+
     if (!thread->start(name, SCHED_FIFO, thread_priority)) {
         delete thread;
         return false;
@@ -60,6 +60,13 @@ public:
      */
     void set_cpu_affinity(const cpu_set_t &cpu_affinity) { _cpu_affinity = cpu_affinity; }
 
+    /*
+      set cpu affinity for threads with the given name created later
+      with thread_create(). This allows a compute heavy thread such as
+      the FFT analysis to run on a core of its own
+     */
+    bool set_thread_cpu_affinity(const char *name, const cpu_set_t &cpu_affinity);
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -117,6 +124,13 @@ private:
 
     Semaphore _io_semaphore;
     cpu_set_t _cpu_affinity;
+
+    static constexpr uint8_t max_thread_affinity = 4;
+    struct {
+        char name[16];
+        cpu_set_t cpu_affinity;
+    } _thread_affinity[max_thread_affinity];
+    uint8_t _num_thread_affinity;
 };
 
 }
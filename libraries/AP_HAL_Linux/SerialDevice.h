@@ -3,8 +3,15 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <AP_HAL/utility/RingBuffer.h>
+
 #include "AP_HAL_Linux.h"
 
+// most datagrams moved by one write_datagrams() call
+#ifndef HAL_LINUX_DATAGRAM_BATCH
+#define HAL_LINUX_DATAGRAM_BATCH 16
+#endif
+
 class SerialDevice {
 public: 
     virtual ~SerialDevice() {}
@@ -23,4 +30,21 @@ public:
 
     /* Depends on lower level to implement, most devices are fine with defaults */
     virtual void set_parity(int v) { }
+
+    /*
+      datagram devices can move several datagrams per system call. A
+      datagram is given as up to two pieces of a ring buffer, so it can
+      be sent without copying
+     */
+    struct Datagram {
+        ByteBuffer::IoVec vec[2];
+        uint8_t n_vec;
+    };
+    virtual bool supports_datagram_batch() const { return false; }
+
+    /* returns the number of datagrams written, or -1 on error */
+    virtual int write_datagrams(const Datagram *dgrams, uint8_t count) { return -1; }
+
+    /* returns the number of bytes added to buf, or -1 on error */
+    virtual ssize_t read_datagrams(ByteBuffer &buf) { return -1; }
 };
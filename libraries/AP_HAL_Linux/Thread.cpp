@@ -190,6 +190,12 @@ bool Thread::start(const char *name, int policy, int prio)
         }
     }
 
+    if (_has_cpu_affinity &&
+        (r = pthread_attr_setaffinity_np(&attr, sizeof(_cpu_affinity), &_cpu_affinity)) != 0) {
+        AP_HAL::panic("Failed to set affinity for thread '%s': %s",
+                      name, strerror(r));
+    }
+
     r = pthread_create(&_ctx, &attr, &Thread::_run_trampoline, this);
     if (r != 0) {
         AP_HAL::panic("Failed to create thread '%s': %s",
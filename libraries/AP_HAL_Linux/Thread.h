@@ -17,6 +17,7 @@
 #pragma once
 
 #include <pthread.h>
+#include <sched.h>
 #include <inttypes.h>
 #include <stdlib.h>
 
@@ -47,6 +48,12 @@ public:
 
     void set_auto_free(bool auto_free) { _auto_free = auto_free; }
 
+    // restrict the thread to a set of cpus, must be called before start()
+    void set_cpu_affinity(const cpu_set_t &cpu_affinity) {
+        _cpu_affinity = cpu_affinity;
+        _has_cpu_affinity = true;
+    }
+
     virtual bool stop() { return false; }
 
     bool join();
@@ -75,6 +82,9 @@ protected:
     } _stack_debug;
 
     size_t _stack_size = 0;
+
+    cpu_set_t _cpu_affinity;
+    bool _has_cpu_affinity = false;
 };
 
 class PeriodicThread : public Thread {
@@ -326,6 +326,77 @@ int UARTDriver::_read_fd(uint8_t *buf, uint16_t n)
 }
 
 
+#if HAL_GCS_ENABLED
+/*
+  find the part of a peeked ring buffer holding len bytes from ofs
+ */
+static void slice_iovec(const ByteBuffer::IoVec vec[2], uint8_t n_vec, uint32_t ofs, uint32_t len,
+                        SerialDevice::Datagram &dgram)
+{
+    dgram.n_vec = 0;
+    for (uint8_t i = 0; i < n_vec && len > 0; i++) {
+        if (ofs >= vec[i].len) {
+            ofs -= vec[i].len;
+            continue;
+        }
+        const uint32_t n = MIN(len, vec[i].len - ofs);
+        dgram.vec[dgram.n_vec].data = vec[i].data + ofs;
+        dgram.vec[dgram.n_vec].len = n;
+        dgram.n_vec++;
+        len -= n;
+        ofs = 0;
+    }
+}
+
+/*
+  push out up to HAL_LINUX_DATAGRAM_BATCH MAVLink packets, one per
+  datagram, with a single system call
+  return true if progress is made
+ */
+bool UARTDriver::_write_pending_datagrams(void)
+{
+    if (!_connected) {
+        _connected = _device->open();
+    }
+    if (!_connected) {
+        return false;
+    }
+
+    ByteBuffer::IoVec vec[2];
+    const uint32_t available_bytes = _writebuf.available();
+    const uint8_t n_vec = _writebuf.peekiovec(vec, available_bytes);
+
+    SerialDevice::Datagram dgrams[HAL_LINUX_DATAGRAM_BATCH];
+    uint16_t lens[HAL_LINUX_DATAGRAM_BATCH];
+    uint8_t count = 0;
+    uint32_t ofs = 0;
+    while (count < HAL_LINUX_DATAGRAM_BATCH && ofs < available_bytes) {
+        const uint16_t n = mavlink_packetise(_writebuf, ofs, MIN(available_bytes - ofs, uint32_t(UINT16_MAX)));
+        if (n == 0) {
+            // wait for the rest of the packet
+            break;
+        }
+        slice_iovec(vec, n_vec, ofs, n, dgrams[count]);
+        lens[count++] = n;
+        ofs += n;
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    const int ret = _device->write_datagrams(dgrams, count);
+    if (ret <= 0) {
+        return false;
+    }
+    uint32_t sent = 0;
+    for (int i = 0; i < ret; i++) {
+        sent += lens[i];
+    }
+    _writebuf.advance(sent);
+    return true;
+}
+#endif // HAL_GCS_ENABLED
+
 /*
   try to push out one lump of pending bytes
   return true if progress is made
@@ -337,6 +408,9 @@ bool UARTDriver::_write_pending_bytes(void)
     uint16_t n = available_bytes;
 
 #if HAL_GCS_ENABLED
+    if (_packetise && _device->supports_datagram_batch()) {
+        return n > 0 && _write_pending_datagrams();
+    }
     if (_packetise && n > 0) {
         // send on MAVLink packet boundaries if possible
         n = mavlink_packetise(_writebuf, n);
@@ -391,6 +465,16 @@ void UARTDriver::_timer_tick(void)
     }
 
     // try to fill the read buffer
+    if (_device->supports_datagram_batch()) {
+        // drain all pending datagrams in one system call
+        if (_device->read_datagrams(_readbuf) > 0) {
+            _receive_timestamp[_receive_timestamp_idx^1] = AP_HAL::micros64();
+            _receive_timestamp_idx ^= 1;
+        }
+        _in_timer = false;
+        return;
+    }
+
     int ret;
     ByteBuffer::IoVec vec[2];
 
@@ -25,6 +25,7 @@ public:
     void set_device_path(const char *path);
 
     bool _write_pending_bytes(void);
+    bool _write_pending_datagrams(void);
     virtual void _timer_tick(void) override;
 
     virtual enum flow_control get_flow_control(void) override
@@ -1,10 +1,14 @@
 #include "UDPDevice.h"
 
+#include <arpa/inet.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
 
 UDPDevice::UDPDevice(const char *ip, uint16_t port, bool bcast, bool input):
     _ip(ip),
@@ -12,6 +16,10 @@ UDPDevice::UDPDevice(const char *ip, uint16_t port, bool bcast, bool input):
     _bcast(bcast),
     _input(input)
 {
+    memset(&_dest, 0, sizeof(_dest));
+    _dest.sin_family = AF_INET;
+    _dest.sin_port = htons(port);
+    _dest.sin_addr.s_addr = inet_addr(ip);
 }
 
 UDPDevice::~UDPDevice()
@@ -45,6 +53,86 @@ ssize_t UDPDevice::read(uint8_t *buf, uint16_t n)
     return ret;
 }
 
+/*
+  send up to count datagrams with one system call. Datagrams are sent
+  straight from the caller's ring buffer
+ */
+int UDPDevice::write_datagrams(const Datagram *dgrams, uint8_t count)
+{
+    if (!_connected && _input) {
+        // can't send yet
+        return -1;
+    }
+    count = MIN(count, HAL_LINUX_DATAGRAM_BATCH);
+
+    struct mmsghdr msgs[HAL_LINUX_DATAGRAM_BATCH];
+    struct iovec iov[HAL_LINUX_DATAGRAM_BATCH][2];
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint8_t j = 0; j < dgrams[i].n_vec; j++) {
+            iov[i][j].iov_base = dgrams[i].vec[j].data;
+            iov[i][j].iov_len = dgrams[i].vec[j].len;
+        }
+        msgs[i].msg_hdr.msg_iov = iov[i];
+        msgs[i].msg_hdr.msg_iovlen = dgrams[i].n_vec;
+        if (!_connected) {
+            msgs[i].msg_hdr.msg_name = &_dest;
+            msgs[i].msg_hdr.msg_namelen = sizeof(_dest);
+        }
+    }
+    return sendmmsg(socket.get_write_fd(), msgs, count, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+/*
+  receive all pending datagrams, up to HAL_LINUX_UDP_RX_BATCH, with
+  one system call and add them to buf
+ */
+ssize_t UDPDevice::read_datagrams(ByteBuffer &buf)
+{
+    const uint32_t space = buf.space();
+    if (space == 0) {
+        return 0;
+    }
+    // only receive as many datagrams as are sure to fit
+    const uint8_t count = MAX(1U, MIN(space / HAL_LINUX_UDP_RX_SLOT_SIZE, uint32_t(HAL_LINUX_UDP_RX_BATCH)));
+    const uint32_t slot_size = MIN(space, uint32_t(HAL_LINUX_UDP_RX_SLOT_SIZE));
+
+    struct mmsghdr msgs[HAL_LINUX_UDP_RX_BATCH];
+    struct iovec iov[HAL_LINUX_UDP_RX_BATCH];
+    struct sockaddr_in from;
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (uint8_t i = 0; i < count; i++) {
+        iov[i].iov_base = _rx_slots[i];
+        iov[i].iov_len = slot_size;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    if (!_connected) {
+        // the first datagram gives the peer to connect to
+        memset(&from, 0, sizeof(from));
+        msgs[0].msg_hdr.msg_name = &from;
+        msgs[0].msg_hdr.msg_namelen = sizeof(from);
+    }
+
+    const int n = recvmmsg(socket.get_read_fd(), msgs, count, MSG_DONTWAIT, nullptr);
+    if (n <= 0) {
+        return n;
+    }
+
+    ssize_t ret = 0;
+    for (int i = 0; i < n; i++) {
+        ret += buf.write(_rx_slots[i], msgs[i].msg_len);
+    }
+
+    if (!_connected && from.sin_family == AF_INET) {
+        char ip[INET_ADDRSTRLEN];
+        if (inet_ntop(AF_INET, &from.sin_addr, ip, sizeof(ip)) != nullptr) {
+            _connected = socket.connect(ip, ntohs(from.sin_port));
+        }
+    }
+    return ret;
+}
+
 bool UDPDevice::open()
 {
     if (_input) {
@@ -1,8 +1,20 @@
 #pragma once
 
+#include <netinet/in.h>
+
 #include <AP_HAL/utility/Socket_native.h>
 #include "SerialDevice.h"
 
+// datagrams received per recvmmsg() call, and the largest datagram
+// received in a batch
+#ifndef HAL_LINUX_UDP_RX_BATCH
+#define HAL_LINUX_UDP_RX_BATCH 8
+#endif
+
+#ifndef HAL_LINUX_UDP_RX_SLOT_SIZE
+#define HAL_LINUX_UDP_RX_SLOT_SIZE 2048
+#endif
+
 class UDPDevice: public SerialDevice {
 public:
     UDPDevice(const char *ip, uint16_t port, bool bcast, bool input);
@@ -14,6 +26,10 @@ public:
     virtual void set_speed(uint32_t speed) override;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
     virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+
+    bool supports_datagram_batch() const override { return true; }
+    int write_datagrams(const Datagram *dgrams, uint8_t count) override;
+    ssize_t read_datagrams(ByteBuffer &buf) override;
 private:
     SocketAPM_native socket{true};
     const char *_ip;
@@ -21,4 +37,10 @@ private:
     bool _bcast;
     bool _input;
     bool _connected = false;
+
+    // destination before a broadcast link is connected
+    struct sockaddr_in _dest;
+
+    // receive buffers for recvmmsg()
+    uint8_t _rx_slots[HAL_LINUX_UDP_RX_BATCH][HAL_LINUX_UDP_RX_SLOT_SIZE];
 };
@@ -0,0 +1,223 @@
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+
+#include <AP_HAL_Linux/UDPDevice.h>
+#include <AP_Math/AP_Math.h>
+#include <atomic>
+#include <thread>
+
+#define BENCHMARK_UDP_PORT 14999
+#define BENCHMARK_UDP_ECHO_PORT 14998
+#define BENCHMARK_UDP_PACKET_LEN 64
+
+/*
+  move state.range_x() packets over loopback, one system call per
+  packet in each direction
+ */
+static void BM_UDPSingle(benchmark::State& state)
+{
+    UDPDevice rx("127.0.0.1", BENCHMARK_UDP_PORT, false, true);
+    UDPDevice tx("127.0.0.1", BENCHMARK_UDP_PORT, false, false);
+    rx.open();
+    rx.set_blocking(false);
+    tx.open();
+    tx.set_blocking(false);
+
+    uint8_t pkt[BENCHMARK_UDP_PACKET_LEN] {};
+    uint8_t buf[BENCHMARK_UDP_PACKET_LEN];
+    const int count = state.range_x();
+
+    while (state.KeepRunning()) {
+        for (int i = 0; i < count; i++) {
+            tx.write(pkt, sizeof(pkt));
+        }
+        for (int i = 0; i < count; i++) {
+            rx.read(buf, sizeof(buf));
+        }
+    }
+}
+
+/*
+  move state.range_x() packets over loopback with batched system calls
+ */
+static void BM_UDPBatch(benchmark::State& state)
+{
+    UDPDevice rx("127.0.0.1", BENCHMARK_UDP_PORT, false, true);
+    UDPDevice tx("127.0.0.1", BENCHMARK_UDP_PORT, false, false);
+    rx.open();
+    rx.set_blocking(false);
+    tx.open();
+    tx.set_blocking(false);
+
+    uint8_t pkt[BENCHMARK_UDP_PACKET_LEN] {};
+    ByteBuffer rxbuf(HAL_LINUX_UDP_RX_BATCH * HAL_LINUX_UDP_RX_SLOT_SIZE);
+    const int count = state.range_x();
+
+    SerialDevice::Datagram dgrams[HAL_LINUX_DATAGRAM_BATCH];
+    for (uint8_t i = 0; i < HAL_LINUX_DATAGRAM_BATCH; i++) {
+        dgrams[i].vec[0].data = pkt;
+        dgrams[i].vec[0].len = sizeof(pkt);
+        dgrams[i].n_vec = 1;
+    }
+
+    while (state.KeepRunning()) {
+        for (int i = 0; i < count; i += HAL_LINUX_DATAGRAM_BATCH) {
+            tx.write_datagrams(dgrams, MIN(count - i, HAL_LINUX_DATAGRAM_BATCH));
+        }
+        while (rx.read_datagrams(rxbuf) > 0) {
+            rxbuf.clear();
+        }
+    }
+}
+
+/*
+  end-to-end latency: each iteration sends state.range_x() packets of
+  state.range_y() bytes through a second thread that echoes them back,
+  and waits for all the replies, as a GCS link sees requests and their
+  replies. UDPDevice::read() does not block, so both ends poll it and
+  yield between attempts, which lets the other end run straight away
+  on a single core machine
+ */
+static void BM_UDPRoundTrip(benchmark::State& state)
+{
+    UDPDevice rx("127.0.0.1", BENCHMARK_UDP_ECHO_PORT, false, true);
+    UDPDevice tx("127.0.0.1", BENCHMARK_UDP_PORT, false, false);
+    UDPDevice echo_rx("127.0.0.1", BENCHMARK_UDP_PORT, false, true);
+    UDPDevice echo_tx("127.0.0.1", BENCHMARK_UDP_ECHO_PORT, false, false);
+    rx.open();
+    rx.set_blocking(false);
+    tx.open();
+    tx.set_blocking(false);
+    echo_rx.open();
+    echo_rx.set_blocking(false);
+    echo_tx.open();
+    echo_tx.set_blocking(false);
+
+    const int count = state.range_x();
+    const uint16_t len = state.range_y();
+
+    // a zero length packet stops the echo thread
+    std::thread echo([&echo_rx, &echo_tx]() {
+        uint8_t buf[HAL_LINUX_UDP_RX_SLOT_SIZE];
+        while (true) {
+            const ssize_t n = echo_rx.read(buf, sizeof(buf));
+            if (n == 0) {
+                break;
+            }
+            if (n > 0) {
+                echo_tx.write(buf, n);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint8_t pkt[HAL_LINUX_UDP_RX_SLOT_SIZE] {};
+    uint8_t buf[HAL_LINUX_UDP_RX_SLOT_SIZE];
+    while (state.KeepRunning()) {
+        for (int i = 0; i < count; i++) {
+            tx.write(pkt, len);
+        }
+        for (int i = 0; i < count; i++) {
+            while (rx.read(buf, sizeof(buf)) < 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    tx.write(pkt, 0);
+    echo.join();
+}
+
+/*
+  the same round trip as BM_UDPRoundTrip, with both ends using the
+  batched write_datagrams()/read_datagrams() calls that
+  UARTDriver::_write_pending_datagrams() and the receive path use
+ */
+static void BM_UDPRoundTripBatch(benchmark::State& state)
+{
+    UDPDevice rx("127.0.0.1", BENCHMARK_UDP_ECHO_PORT, false, true);
+    UDPDevice tx("127.0.0.1", BENCHMARK_UDP_PORT, false, false);
+    UDPDevice echo_rx("127.0.0.1", BENCHMARK_UDP_PORT, false, true);
+    UDPDevice echo_tx("127.0.0.1", BENCHMARK_UDP_ECHO_PORT, false, false);
+    rx.open();
+    rx.set_blocking(false);
+    tx.open();
+    tx.set_blocking(false);
+    echo_rx.open();
+    echo_rx.set_blocking(false);
+    echo_tx.open();
+    echo_tx.set_blocking(false);
+
+    const int count = state.range_x();
+    const uint16_t len = state.range_y();
+
+    // queue up to count datagrams of len bytes from data
+    auto write_all = [len](UDPDevice &dev, uint8_t *data, int n) {
+        SerialDevice::Datagram dgrams[HAL_LINUX_DATAGRAM_BATCH];
+        int sent = 0;
+        while (sent < n) {
+            const uint8_t batch = MIN(n - sent, HAL_LINUX_DATAGRAM_BATCH);
+            for (uint8_t i = 0; i < batch; i++) {
+                dgrams[i].vec[0].data = &data[(sent + i) * len];
+                dgrams[i].vec[0].len = len;
+                dgrams[i].n_vec = 1;
+            }
+            const int ret = dev.write_datagrams(dgrams, batch);
+            if (ret > 0) {
+                sent += ret;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    // datagrams are all len bytes, so the echo can split what it receives
+    std::atomic<bool> stop {false};
+    std::thread echo([&echo_rx, &echo_tx, &stop, &write_all, len]() {
+        ByteBuffer rxbuf(HAL_LINUX_UDP_RX_BATCH * HAL_LINUX_UDP_RX_SLOT_SIZE);
+        uint8_t buf[HAL_LINUX_UDP_RX_BATCH * HAL_LINUX_UDP_RX_SLOT_SIZE];
+        while (!stop) {
+            if (echo_rx.read_datagrams(rxbuf) <= 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            const uint32_t n = rxbuf.read(buf, rxbuf.available());
+            write_all(echo_tx, buf, n / len);
+        }
+    });
+
+    uint8_t *pkts = NEW_NOTHROW uint8_t[count * len] {};
+    ByteBuffer rxbuf(HAL_LINUX_UDP_RX_BATCH * HAL_LINUX_UDP_RX_SLOT_SIZE);
+    while (state.KeepRunning()) {
+        write_all(tx, pkts, count);
+        uint32_t received = 0;
+        while (received < uint32_t(count * len)) {
+            const ssize_t n = rx.read_datagrams(rxbuf);
+            if (n > 0) {
+                received += n;
+                rxbuf.clear();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    stop = true;
+    echo.join();
+    delete[] pkts;
+}
+
+BENCHMARK(BM_UDPSingle)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_UDPBatch)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_UDPRoundTrip)
+    ->ArgPair(1, BENCHMARK_UDP_PACKET_LEN)->ArgPair(16, BENCHMARK_UDP_PACKET_LEN)
+    ->ArgPair(64, BENCHMARK_UDP_PACKET_LEN)->ArgPair(1, 1024)->UseRealTime();
+BENCHMARK(BM_UDPRoundTripBatch)
+    ->ArgPair(1, BENCHMARK_UDP_PACKET_LEN)->ArgPair(16, BENCHMARK_UDP_PACKET_LEN)
+    ->ArgPair(64, BENCHMARK_UDP_PACKET_LEN)->ArgPair(1, 1024)->UseRealTime();
+#endif
+
+BENCHMARK_MAIN();
@@ -236,6 +236,8 @@ bool CANIface::init(const uint32_t bitrate, const OperatingMode mode)
     if (sem_handle != nullptr) {
         transport->set_event_handle(sem_handle);
     }
+    bitrate_ = bitrate;
+    mode_ = mode;
     return true;
 }
 
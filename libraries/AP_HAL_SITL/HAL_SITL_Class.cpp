@@ -242,6 +242,14 @@ void HAL_SITL::run(int argc, char * const argv[], Callbacks* callbacks) const
             // don't wipe params on reboot
             continue;
         }
+        // don't restore a checkpoint over current state on reboot
+        if (!strcmp(argv[i], "--restore")) {
+            i++;
+            continue;
+        }
+        if (!strncmp(argv[i], "--restore=", 10)) {
+            continue;
+        }
         new_argv[new_argv_offset++] = argv[i];
     }
     
@@ -108,6 +108,10 @@ void SITL_State::_sitl_setup()
         // start with non-zero clock
         hal.scheduler->stop_clock(1);
     }
+
+    if (_restore_path != nullptr && !checkpoint_restore(_restore_path)) {
+        exit(1);
+    }
 }
 
 
@@ -116,6 +120,11 @@ void SITL_State::_sitl_setup()
  */
 void SITL_State::_fdm_input_step(void)
 {
+    if (_checkpoint_requested) {
+        _checkpoint_requested = false;
+        checkpoint_save(_checkpoint_path);
+    }
+
     _fdm_input_local();
 
     /* make sure we die if our parent dies */
@@ -75,6 +75,14 @@ private:
 
     void wait_clock(uint64_t wait_time_usec);
 
+    // checkpoint save/restore of simulation state
+    static void _sig_checkpoint(int signum);
+    static volatile bool _checkpoint_requested;
+    const char *_checkpoint_path = "sitl_checkpoint.bin";
+    const char *_restore_path;
+    bool checkpoint_save(const char *path);
+    bool checkpoint_restore(const char *path);
+
     // internal state
     uint8_t _instance;
     uint16_t _base_port;
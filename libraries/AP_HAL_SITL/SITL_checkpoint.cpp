@@ -0,0 +1,178 @@
+/*
+  SITL checkpoint support
+
+  A checkpoint captures the simulated clock, the vehicle storage image
+  (parameters, missions, fences, rally points etc) and the kinematic
+  state of the simulated aircraft. A running simulation writes a
+  checkpoint when it receives SIGUSR1, and a new simulation can be
+  started from a checkpoint with --restore, allowing test suites to
+  fork many scenarios from a single saved state.
+
+  In-memory vehicle state, including the EKF and arming state, is not
+  part of a checkpoint. A restored vehicle boots normally and its
+  estimator converges again from the restored physics, so checkpoints
+  are only taken while the vehicle is disarmed and on the ground.
+ */
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL && !defined(HAL_BUILD_AP_PERIPH)
+
+#include "AP_HAL_SITL.h"
+#include "AP_HAL_SITL_Namespace.h"
+#include "HAL_SITL_Class.h"
+#include "Storage.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+extern const AP_HAL::HAL& hal;
+
+using namespace HALSITL;
+
+#define SITL_CHECKPOINT_MAGIC   0x4B435053  // "SPCK"
+#define SITL_CHECKPOINT_VERSION 1
+
+struct PACKED checkpoint_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t aircraft_state_size;
+    uint32_t storage_size;
+    uint64_t clock_usec;
+};
+
+volatile bool SITL_State::_checkpoint_requested;
+
+/*
+  signal handler requesting a checkpoint. The checkpoint itself is
+  written from the main thread between simulation steps
+ */
+void SITL_State::_sig_checkpoint(int signum)
+{
+    _checkpoint_requested = true;
+}
+
+/*
+  write a checkpoint file. The file is written to a temporary name and
+  renamed into place so a reader never sees a partial checkpoint
+ */
+bool SITL_State::checkpoint_save(const char *path)
+{
+    void *storage_ptr;
+    size_t storage_size;
+    if (sitl_model == nullptr ||
+        !hal.storage->get_storage_ptr(storage_ptr, storage_size)) {
+        ::printf("Checkpoint: no state to save\n");
+        return false;
+    }
+    if (hal.util->get_soft_armed() || !sitl_model->on_ground()) {
+        ::printf("Checkpoint: vehicle must be disarmed and landed, not saved\n");
+        return false;
+    }
+
+    SITL::Aircraft::CheckpointState state {};
+    sitl_model->get_checkpoint_state(state);
+
+    checkpoint_header hdr {};
+    hdr.magic = SITL_CHECKPOINT_MAGIC;
+    hdr.version = SITL_CHECKPOINT_VERSION;
+    hdr.aircraft_state_size = sizeof(state);
+    hdr.storage_size = storage_size;
+    hdr.clock_usec = AP_HAL::micros64();
+
+    char *tmp_path = nullptr;
+    if (asprintf(&tmp_path, "%s.tmp", path) <= 0) {
+        return false;
+    }
+    const int fd = ::open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+    if (fd == -1) {
+        ::printf("Checkpoint: open failed for %s\n", tmp_path);
+        free(tmp_path);
+        return false;
+    }
+    const bool ok =
+        ::write(fd, &hdr, sizeof(hdr)) == ssize_t(sizeof(hdr)) &&
+        ::write(fd, storage_ptr, storage_size) == ssize_t(storage_size) &&
+        ::write(fd, &state, sizeof(state)) == ssize_t(sizeof(state));
+    ::close(fd);
+    if (!ok || ::rename(tmp_path, path) != 0) {
+        ::printf("Checkpoint: write failed for %s\n", path);
+        ::unlink(tmp_path);
+        free(tmp_path);
+        return false;
+    }
+    free(tmp_path);
+
+    ::printf("Checkpoint: saved %s at %.3fs\n", path, hdr.clock_usec*1.0e-6);
+    return true;
+}
+
+/*
+  restore a checkpoint file. This must be called before the vehicle
+  loads its parameters from storage
+ */
+bool SITL_State::checkpoint_restore(const char *path)
+{
+    const int fd = ::open(path, O_RDONLY|O_CLOEXEC);
+    if (fd == -1) {
+        ::printf("Checkpoint: open failed for %s\n", path);
+        return false;
+    }
+
+    checkpoint_header hdr;
+    SITL::Aircraft::CheckpointState state;
+    if (::read(fd, &hdr, sizeof(hdr)) != ssize_t(sizeof(hdr)) ||
+        hdr.magic != SITL_CHECKPOINT_MAGIC ||
+        hdr.version != SITL_CHECKPOINT_VERSION ||
+        hdr.aircraft_state_size != sizeof(state) ||
+        hdr.storage_size != HAL_STORAGE_SIZE) {
+        ::printf("Checkpoint: %s is not a compatible checkpoint\n", path);
+        ::close(fd);
+        return false;
+    }
+
+    uint8_t *storage = NEW_NOTHROW uint8_t[hdr.storage_size];
+    if (storage == nullptr) {
+        ::close(fd);
+        return false;
+    }
+    const bool ok =
+        ::read(fd, storage, hdr.storage_size) == ssize_t(hdr.storage_size) &&
+        ::read(fd, &state, sizeof(state)) == ssize_t(sizeof(state));
+    ::close(fd);
+    if (!ok) {
+        ::printf("Checkpoint: short read from %s\n", path);
+        delete[] storage;
+        return false;
+    }
+
+    /*
+      the vehicle and EKF start afresh, so an airborne checkpoint would
+      restore an aircraft in flight under a vehicle that believes it
+      is on the ground and disarmed
+     */
+    sitl_model->set_checkpoint_state(state);
+    if (!sitl_model->on_ground()) {
+        ::printf("Checkpoint: %s was not taken on the ground, only landed checkpoints can be restored\n", path);
+        delete[] storage;
+        return false;
+    }
+
+    if (!static_cast<HALSITL::Storage*>(hal.storage)->load_image(storage, hdr.storage_size)) {
+        ::printf("Checkpoint: failed to load storage image\n");
+        delete[] storage;
+        return false;
+    }
+    delete[] storage;
+
+    if (_synthetic_clock_mode) {
+        hal.scheduler->stop_clock(hdr.clock_usec);
+    } else {
+        ::printf("Checkpoint: clock not restored without a synthetic clock\n");
+    }
+
+    ::printf("Checkpoint: restored %s at %.3fs\n", path, hdr.clock_usec*1.0e-6);
+    return true;
+}
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_SITL && !defined(HAL_BUILD_AP_PERIPH)
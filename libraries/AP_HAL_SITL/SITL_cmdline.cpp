@@ -117,6 +117,11 @@ void SITL_State::_usage(void)
            "\t--start-time TIMESTR     set simulation start time in UNIX timestamp\n"
            "\t--sysid ID               set SYSID_THISMAV\n"
            "\t--slave number           set the number of JSON slaves\n"
+           "\t--checkpoint FILE        set file written on SIGUSR1 while disarmed and landed\n"
+           "\t                         (default sitl_checkpoint.bin)\n"
+           "\t--restore FILE           start simulation from a checkpoint file. Only the clock,\n"
+           "\t                         storage and aircraft physics are restored, the vehicle\n"
+           "\t                         and EKF start afresh from that state\n"
         );
 }
 
@@ -201,6 +206,11 @@ void SITL_State::_set_signal_handlers(void) const
     sa_segv.sa_handler = _sig_segv;
     sigaction(SIGSEGV, &sa_segv, nullptr);
 
+    struct sigaction sa_checkpoint = {};
+    sigemptyset(&sa_checkpoint.sa_mask);
+    sa_checkpoint.sa_handler = _sig_checkpoint;
+    sigaction(SIGUSR1, &sa_checkpoint, nullptr);
+
 }
 
 void SITL_State::_parse_command_line(int argc, char * const argv[])
@@ -277,6 +287,8 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         CMDLINE_START_TIME,
         CMDLINE_SYSID,
         CMDLINE_SLAVE,
+        CMDLINE_CHECKPOINT,
+        CMDLINE_RESTORE,
 #if STORAGE_USE_FLASH
         CMDLINE_SET_STORAGE_FLASH_ENABLED,
 #endif
@@ -337,6 +349,8 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
         {"start-time",      true,   0, CMDLINE_START_TIME},
         {"sysid",           true,   0, CMDLINE_SYSID},
         {"slave",           true,   0, CMDLINE_SLAVE},
+        {"checkpoint",      true,   0, CMDLINE_CHECKPOINT},
+        {"restore",         true,   0, CMDLINE_RESTORE},
 #if STORAGE_USE_FLASH
         {"set-storage-flash-enabled", true,   0, CMDLINE_SET_STORAGE_FLASH_ENABLED},
 #endif
@@ -544,6 +558,12 @@ void SITL_State::_parse_command_line(int argc, char * const argv[])
 #endif
             break;
         }
+        case CMDLINE_CHECKPOINT:
+            _checkpoint_path = gopt.optarg;
+            break;
+        case CMDLINE_RESTORE:
+            _restore_path = gopt.optarg;
+            break;
         default:
             _usage();
             exit(1);
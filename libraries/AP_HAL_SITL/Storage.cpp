@@ -400,3 +400,21 @@ bool Storage::get_storage_ptr(void *&ptr, size_t &size)
     size = sizeof(_buffer);
     return true;
 }
+
+/*
+  replace the whole storage image. All lines are marked dirty so the
+  new image is written through to the active storage backend
+ */
+bool Storage::load_image(const void *data, size_t size)
+{
+    if (size != sizeof(_buffer)) {
+        return false;
+    }
+    _storage_open();
+    if (_initialisedType == StorageBackend::None) {
+        return false;
+    }
+    memcpy(_buffer, data, size);
+    _mark_dirty(0, sizeof(_buffer));
+    return true;
+}
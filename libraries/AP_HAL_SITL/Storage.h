@@ -33,6 +33,9 @@ public:
     void _timer_tick(void) override;
     bool healthy(void) override;
 
+    // replace the whole storage image, used by SITL checkpoints
+    bool load_image(const void *data, size_t size);
+
 private:
     enum class StorageBackend: uint8_t {
         None,
@@ -61,14 +61,14 @@ void AP_InertialSensor_Backend::_set_gyro_oversampling(uint8_t instance, uint8_t
   sensor may vary slightly from the system clock. This slowly adjusts
   the rate to the observed rate
 */
-void AP_InertialSensor_Backend::_update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz) const
+void AP_InertialSensor_Backend::_update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz, uint16_t n) const
 {
     uint32_t now = AP_HAL::micros();
     if (start_us == 0) {
         count = 0;
         start_us = now;
     } else {
-        count++;
+        count += n;
         if (now - start_us > 1000000UL) {
             float observed_rate_hz = count * 1.0e6f / (now - start_us);
 #if 0
@@ -92,19 +92,31 @@ void AP_InertialSensor_Backend::_update_sensor_rate(uint16_t &count, uint32_t &s
 }
 
 void AP_InertialSensor_Backend::_rotate_and_correct_accel(uint8_t instance, Vector3f &accel) 
+{
+    _rotate_and_correct_accel(instance, &accel, 1);
+}
+
+void AP_InertialSensor_Backend::_rotate_and_correct_accel(uint8_t instance, Vector3f *accel, uint16_t n)
 {
     /*
       accel calibration is always done in sensor frame with this
       version of the code. That means we apply the rotation after the
       offsets and scaling.
      */
+    const enum Rotation sensor_rotation = _imu._accel_orientation[instance];
+    const enum Rotation board_rotation = _imu._board_orientation;
 
     // rotate for sensor orientation
-    accel.rotate(_imu._accel_orientation[instance]);
+    for (uint16_t i=0; i<n; i++) {
+        accel[i].rotate(sensor_rotation);
+    }
 
 #if HAL_INS_TEMPERATURE_CAL_ENABLE
     if (_imu.tcal_learning) {
-        _imu.tcal(instance).update_accel_learning(accel, _imu.get_temperature(instance));
+        const float temperature = _imu.get_temperature(instance);
+        for (uint16_t i=0; i<n; i++) {
+            _imu.tcal(instance).update_accel_learning(accel[i], temperature);
+        }
     }
 #endif
 
@@ -114,49 +126,74 @@ void AP_InertialSensor_Backend::_rotate_and_correct_accel(uint8_t instance, Vect
 #endif
     )) {
 
+        // the temperature correction is additive and the same for
+        // every sample in the burst, so fold it into the offset
+        Vector3f offset = _imu._accel_offset(instance);
 #if HAL_INS_TEMPERATURE_CAL_ENABLE
-        // apply temperature corrections
-        _imu.tcal(instance).correct_accel(_imu.get_temperature(instance), _imu.caltemp_accel(instance), accel);
+        Vector3f tcal_correction;
+        _imu.tcal(instance).correct_accel(_imu.get_temperature(instance), _imu.caltemp_accel(instance), tcal_correction);
+        offset -= tcal_correction;
 #endif
-
-        // apply offsets
-        accel -= _imu._accel_offset(instance);
-
-
-        // apply scaling
-        const Vector3f &accel_scale = _imu._accel_scale(instance).get();
-        accel.x *= accel_scale.x;
-        accel.y *= accel_scale.y;
-        accel.z *= accel_scale.z;
+        const Vector3f accel_scale = _imu._accel_scale(instance).get();
+
+        // apply offsets and scaling
+        for (uint16_t i=0; i<n; i++) {
+            accel[i] -= offset;
+            accel[i].x *= accel_scale.x;
+            accel[i].y *= accel_scale.y;
+            accel[i].z *= accel_scale.z;
+        }
     }
 
     // rotate to body frame
-    accel.rotate(_imu._board_orientation);
+    for (uint16_t i=0; i<n; i++) {
+        accel[i].rotate(board_rotation);
+    }
 }
 
 void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro) 
 {
+    _rotate_and_correct_gyro(instance, &gyro, 1);
+}
+
+void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vector3f *gyro, uint16_t n)
+{
+    const enum Rotation sensor_rotation = _imu._gyro_orientation[instance];
+    const enum Rotation board_rotation = _imu._board_orientation;
+
     // rotate for sensor orientation
-    gyro.rotate(_imu._gyro_orientation[instance]);
+    for (uint16_t i=0; i<n; i++) {
+        gyro[i].rotate(sensor_rotation);
+    }
 
 #if HAL_INS_TEMPERATURE_CAL_ENABLE
     if (_imu.tcal_learning) {
-        _imu.tcal(instance).update_gyro_learning(gyro, _imu.get_temperature(instance));
+        const float temperature = _imu.get_temperature(instance);
+        for (uint16_t i=0; i<n; i++) {
+            _imu.tcal(instance).update_gyro_learning(gyro[i], temperature);
+        }
     }
 #endif
     
     if (!_imu._calibrating_gyro) {
 
+        // gyro calibration is always assumed to have been done in
+        // sensor frame. The temperature correction is additive so is
+        // folded into the offset
+        Vector3f offset = _imu._gyro_offset(instance);
 #if HAL_INS_TEMPERATURE_CAL_ENABLE
-        // apply temperature corrections
-        _imu.tcal(instance).correct_gyro(_imu.get_temperature(instance), _imu.caltemp_gyro(instance), gyro);
+        Vector3f tcal_correction;
+        _imu.tcal(instance).correct_gyro(_imu.get_temperature(instance), _imu.caltemp_gyro(instance), tcal_correction);
+        offset -= tcal_correction;
 #endif
-
-        // gyro calibration is always assumed to have been done in sensor frame
-        gyro -= _imu._gyro_offset(instance);
+        for (uint16_t i=0; i<n; i++) {
+            gyro[i] -= offset;
+        }
     }
 
-    gyro.rotate(_imu._board_orientation);
+    for (uint16_t i=0; i<n; i++) {
+        gyro[i].rotate(board_rotation);
+    }
 }
 
 /*
@@ -263,13 +300,21 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
                                                             const Vector3f &gyro,
                                                             uint64_t sample_us)
 {
-    if ((1U<<instance) & _imu.imu_kill_mask) {
+    _notify_new_gyro_raw_samples(instance, &gyro, 1, sample_us);
+}
+
+void AP_InertialSensor_Backend::_notify_new_gyro_raw_samples(uint8_t instance,
+                                                             const Vector3f *gyro,
+                                                             uint16_t n,
+                                                             uint64_t sample_us)
+{
+    if (n == 0 || ((1U<<instance) & _imu.imu_kill_mask)) {
         return;
     }
     float dt;
 
     _update_sensor_rate(_imu._sample_gyro_count[instance], _imu._sample_gyro_start_us[instance],
-                        _imu._gyro_raw_sample_rates[instance]);
+                        _imu._gyro_raw_sample_rates[instance], n);
 
     uint64_t last_sample_us = _imu._gyro_last_sample_us[instance];
 
@@ -282,7 +327,7 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
       difference between the two is whether sample_us is provided.
      */
     if (sample_us != 0 && _imu._gyro_last_sample_us[instance] != 0) {
-        dt = (sample_us - _imu._gyro_last_sample_us[instance]) * 1.0e-6f;
+        dt = (sample_us - _imu._gyro_last_sample_us[instance]) * 1.0e-6f / n;
         _imu._gyro_last_sample_us[instance] = sample_us;
     } else {
         // don't accept below 40Hz
@@ -295,60 +340,82 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
         sample_us = _imu._gyro_last_sample_us[instance];
     }
 
+    for (uint16_t i=0; i<n; i++) {
 #if AP_MODULE_SUPPORTED
-    // call gyro_sample hook if any
-    AP_Module::call_hook_gyro_sample(instance, dt, gyro);
+        // call gyro_sample hook if any
+        AP_Module::call_hook_gyro_sample(instance, dt, gyro[i]);
 #endif
 
-    // push gyros if optical flow present
-    if (hal.opticalflow) {
-        hal.opticalflow->push_gyro(gyro.x, gyro.y, dt);
+        // push gyros if optical flow present
+        if (hal.opticalflow) {
+            hal.opticalflow->push_gyro(gyro[i].x, gyro[i].y, dt);
+        }
     }
-    
-    // compute delta angle
-    Vector3f delta_angle = (gyro + _imu._last_raw_gyro[instance]) * 0.5f * dt;
 
-    // compute coning correction
-    // see page 26 of:
-    // Tian et al (2010) Three-loop Integration of GPS and Strapdown INS with Coning and Sculling Compensation
-    // Available: http://www.sage.unsw.edu.au/snap/publications/tian_etal2010b.pdf
-    // see also examples/coning.py
-    Vector3f delta_coning = (_imu._delta_angle_acc[instance] +
-                             _imu._last_delta_angle[instance] * (1.0f / 6.0f));
-    delta_coning = delta_coning % delta_angle;
-    delta_coning *= 0.5f;
+    bool check_gap = true;
+    while (n > 0) {
+        const uint8_t burst = MIN(n, uint16_t(max_notify_burst));
+        Vector3f filtered[max_notify_burst];
+        {
+            WITH_SEMAPHORE(_sem);
+            bool gap = false;
+            if (check_gap) {
+                // zero accumulator if sensor was unhealthy for 0.1s
+                gap = AP_HAL::micros64() - last_sample_us > 100000U;
+                check_gap = false;
+            }
 
-    {
-        WITH_SEMAPHORE(_sem);
-        uint64_t now = AP_HAL::micros64();
+            for (uint8_t i=0; i<burst; i++) {
+                float sample_dt = dt;
+
+                // compute delta angle
+                Vector3f delta_angle = (gyro[i] + _imu._last_raw_gyro[instance]) * 0.5f * sample_dt;
+
+                // compute coning correction
+                // see page 26 of:
+                // Tian et al (2010) Three-loop Integration of GPS and Strapdown INS with Coning and Sculling Compensation
+                // Available: http://www.sage.unsw.edu.au/snap/publications/tian_etal2010b.pdf
+                // see also examples/coning.py
+                Vector3f delta_coning = (_imu._delta_angle_acc[instance] +
+                                         _imu._last_delta_angle[instance] * (1.0f / 6.0f));
+                delta_coning = delta_coning % delta_angle;
+                delta_coning *= 0.5f;
+
+                if (gap) {
+                    _imu._delta_angle_acc[instance].zero();
+                    _imu._delta_angle_acc_dt[instance] = 0;
+                    sample_dt = 0;
+                    delta_angle.zero();
+                    gap = false;
+                }
+
+                // integrate delta angle accumulator
+                // the angles and coning corrections are accumulated separately in the
+                // referenced paper, but in simulation little difference was found between
+                // integrating together and integrating separately (see examples/coning.py)
+                _imu._delta_angle_acc[instance] += delta_angle + delta_coning;
+                _imu._delta_angle_acc_dt[instance] += sample_dt;
+
+                // save previous delta angle for coning correction
+                _imu._last_delta_angle[instance] = delta_angle;
+                _imu._last_raw_gyro[instance] = gyro[i];
+
+                // apply gyro filters and sample for FFT
+                apply_gyro_filters(instance, gyro[i]);
+                filtered[i] = _imu._gyro_filtered[instance];
+            }
 
-        if (now - last_sample_us > 100000U) {
-            // zero accumulator if sensor was unhealthy for 0.1s
-            _imu._delta_angle_acc[instance].zero();
-            _imu._delta_angle_acc_dt[instance] = 0;
-            dt = 0;
-            delta_angle.zero();
+            _imu._new_gyro_data[instance] = true;
         }
 
-        // integrate delta angle accumulator
-        // the angles and coning corrections are accumulated separately in the
-        // referenced paper, but in simulation little difference was found between
-        // integrating together and integrating separately (see examples/coning.py)
-        _imu._delta_angle_acc[instance] += delta_angle + delta_coning;
-        _imu._delta_angle_acc_dt[instance] += dt;
-
-        // save previous delta angle for coning correction
-        _imu._last_delta_angle[instance] = delta_angle;
-        _imu._last_raw_gyro[instance] = gyro;
-
-        // apply gyro filters and sample for FFT
-        apply_gyro_filters(instance, gyro);
+        // 5us per sample
+        for (uint8_t i=0; i<burst; i++) {
+            log_gyro_raw(instance, sample_us, gyro[i], filtered[i]);
+        }
 
-        _imu._new_gyro_data[instance] = true;
+        gyro += burst;
+        n -= burst;
     }
-
-    // 5us
-    log_gyro_raw(instance, sample_us, gyro, _imu._gyro_filtered[instance]);
 }
 
 /*
@@ -517,13 +584,22 @@ void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
                                                              uint64_t sample_us,
                                                              bool fsync_set)
 {
-    if ((1U<<instance) & _imu.imu_kill_mask) {
+    _notify_new_accel_raw_samples(instance, &accel, 1, sample_us, fsync_set);
+}
+
+void AP_InertialSensor_Backend::_notify_new_accel_raw_samples(uint8_t instance,
+                                                              const Vector3f *accel,
+                                                              uint16_t n,
+                                                              uint64_t sample_us,
+                                                              bool fsync_set)
+{
+    if (n == 0 || ((1U<<instance) & _imu.imu_kill_mask)) {
         return;
     }
     float dt;
 
     _update_sensor_rate(_imu._sample_accel_count[instance], _imu._sample_accel_start_us[instance],
-                        _imu._accel_raw_sample_rates[instance]);
+                        _imu._accel_raw_sample_rates[instance], n);
 
     uint64_t last_sample_us = _imu._accel_last_sample_us[instance];
 
@@ -536,7 +612,7 @@ void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
       difference between the two is whether sample_us is provided.
      */
     if (sample_us != 0 && _imu._accel_last_sample_us[instance] != 0) {
-        dt = (sample_us - _imu._accel_last_sample_us[instance]) * 1.0e-6f;
+        dt = (sample_us - _imu._accel_last_sample_us[instance]) * 1.0e-6f / n;
         _imu._accel_last_sample_us[instance] = sample_us;
     } else {
         // don't accept below 40Hz
@@ -549,50 +625,66 @@ void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
         sample_us = _imu._accel_last_sample_us[instance];
     }
 
+    for (uint16_t i=0; i<n; i++) {
 #if AP_MODULE_SUPPORTED
-    // call accel_sample hook if any
-    AP_Module::call_hook_accel_sample(instance, dt, accel, fsync_set);
+        // call accel_sample hook if any
+        AP_Module::call_hook_accel_sample(instance, dt, accel[i], fsync_set && i == n-1);
 #endif    
-    
-    _imu.calc_vibration_and_clipping(instance, accel, dt);
 
-    {
-        WITH_SEMAPHORE(_sem);
+        _imu.calc_vibration_and_clipping(instance, accel[i], dt);
+    }
 
-        uint64_t now = AP_HAL::micros64();
+#if AP_INERTIALSENSOR_BATCHSAMPLER_ENABLED
+    const bool log_filtered = _imu.batchsampler.doing_post_filter_logging();
+#else
+    // assume we're doing pre-filter logging
+    const bool log_filtered = false;
+#endif
 
-        if (now - last_sample_us > 100000U) {
-            // zero accumulator if sensor was unhealthy for 0.1s
-            _imu._delta_velocity_acc[instance].zero();
-            _imu._delta_velocity_acc_dt[instance] = 0;
-            dt = 0;
-        }
-        
-        // delta velocity
-        _imu._delta_velocity_acc[instance] += accel * dt;
-        _imu._delta_velocity_acc_dt[instance] += dt;
+    bool check_gap = true;
+    while (n > 0) {
+        const uint8_t burst = MIN(n, uint16_t(max_notify_burst));
+        Vector3f filtered[max_notify_burst];
+        {
+            WITH_SEMAPHORE(_sem);
+
+            float sample_dt = dt;
+            if (check_gap) {
+                if (AP_HAL::micros64() - last_sample_us > 100000U) {
+                    // zero accumulator if sensor was unhealthy for 0.1s
+                    _imu._delta_velocity_acc[instance].zero();
+                    _imu._delta_velocity_acc_dt[instance] = 0;
+                    sample_dt = 0;
+                }
+                check_gap = false;
+            }
 
-        _imu._accel_filtered[instance] = _imu._accel_filter[instance].apply(accel);
-        if (_imu._accel_filtered[instance].is_nan() || _imu._accel_filtered[instance].is_inf()) {
-            _imu._accel_filter[instance].reset();
-        }
+            for (uint8_t i=0; i<burst; i++) {
+                // delta velocity
+                _imu._delta_velocity_acc[instance] += accel[i] * sample_dt;
+                _imu._delta_velocity_acc_dt[instance] += sample_dt;
+                sample_dt = dt;
 
-        _imu.set_accel_peak_hold(instance, _imu._accel_filtered[instance]);
+                _imu._accel_filtered[instance] = _imu._accel_filter[instance].apply(accel[i]);
+                if (_imu._accel_filtered[instance].is_nan() || _imu._accel_filtered[instance].is_inf()) {
+                    _imu._accel_filter[instance].reset();
+                }
 
-        _imu._new_accel_data[instance] = true;
-    }
+                _imu.set_accel_peak_hold(instance, _imu._accel_filtered[instance]);
+                filtered[i] = _imu._accel_filtered[instance];
+            }
 
-    // 5us
-#if AP_INERTIALSENSOR_BATCHSAMPLER_ENABLED
-    if (!_imu.batchsampler.doing_post_filter_logging()) {
-        log_accel_raw(instance, sample_us, accel);
-    } else {
-        log_accel_raw(instance, sample_us, _imu._accel_filtered[instance]);
+            _imu._new_accel_data[instance] = true;
+        }
+
+        // 5us per sample
+        for (uint8_t i=0; i<burst; i++) {
+            log_accel_raw(instance, sample_us, log_filtered ? filtered[i] : accel[i]);
+        }
+
+        accel += burst;
+        n -= burst;
     }
-#else
-    // assume we're doing pre-filter logging:
-    log_accel_raw(instance, sample_us, accel);
-#endif
 }
 
 /*
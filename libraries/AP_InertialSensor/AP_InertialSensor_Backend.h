@@ -148,6 +148,15 @@ protected:
     void _rotate_and_correct_accel(uint8_t instance, Vector3f &accel) __RAMFUNC__;
     void _rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro) __RAMFUNC__;
 
+    // rotate and correct a burst of samples in place. Calibration
+    // state is looked up once for the whole burst
+    void _rotate_and_correct_accel(uint8_t instance, Vector3f *accel, uint16_t n) __RAMFUNC__;
+    void _rotate_and_correct_gyro(uint8_t instance, Vector3f *gyro, uint16_t n) __RAMFUNC__;
+
+    // maximum number of samples processed under one hold of the
+    // backend semaphore by the burst notify functions
+    static constexpr uint8_t max_notify_burst = 16;
+
     // rotate gyro vector, offset and publish
     void _publish_gyro(uint8_t instance, const Vector3f &gyro) __RAMFUNC__; /* front end */
 
@@ -163,6 +172,11 @@ protected:
     // sensors, and should be set to zero for FIFO based sensors
     void _notify_new_gyro_raw_sample(uint8_t instance, const Vector3f &accel, uint64_t sample_us=0) __RAMFUNC__;
 
+    // notify a burst of n gyro samples read from a FIFO, oldest
+    // first. The samples must already be rotated and corrected. If
+    // sample_us is provided it is the time of the last sample
+    void _notify_new_gyro_raw_samples(uint8_t instance, const Vector3f *gyro, uint16_t n, uint64_t sample_us=0) __RAMFUNC__;
+
     // alternative interface using delta-angles. Rotation and correction is handled inside this function
     void _notify_new_delta_angle(uint8_t instance, const Vector3f &dangle);
     
@@ -177,6 +191,12 @@ protected:
     // sensors, and should be set to zero for FIFO based sensors
     void _notify_new_accel_raw_sample(uint8_t instance, const Vector3f &accel, uint64_t sample_us=0, bool fsync_set=false) __RAMFUNC__;
 
+    // notify a burst of n accel samples read from a FIFO, oldest
+    // first. The samples must already be rotated and corrected. If
+    // sample_us is provided it is the time of the last sample, and
+    // fsync_set applies to the last sample
+    void _notify_new_accel_raw_samples(uint8_t instance, const Vector3f *accel, uint16_t n, uint64_t sample_us=0, bool fsync_set=false) __RAMFUNC__;
+
     // alternative interface using delta-velocities. Rotation and correction is handled inside this function
     void _notify_new_delta_velocity(uint8_t instance, const Vector3f &dvelocity);
     
@@ -213,7 +233,7 @@ protected:
     }
 
     // update the sensor rate for FIFO sensors
-    void _update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz) const __RAMFUNC__;
+    void _update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz, uint16_t n=1) const __RAMFUNC__;
 
     // return true if the sensors are still converging and sampling rates could change significantly
     bool sensors_converging() const { return AP_HAL::millis() < HAL_INS_CONVERGANCE_MS; }
@@ -405,11 +405,30 @@ void AP_InertialSensor_Invensensev3::accumulate()
     // nothing to do
 }
 
+/*
+  rotate, correct and notify a burst of decoded FIFO samples. This
+  takes the backend semaphore once per burst rather than once per
+  sample
+ */
+void AP_InertialSensor_Invensensev3::notify_samples(Vector3f *accel, Vector3f *gyro, uint8_t n)
+{
+    _rotate_and_correct_accel(accel_instance, accel, n);
+    _rotate_and_correct_gyro(gyro_instance, gyro, n);
+
+    _notify_new_accel_raw_samples(accel_instance, accel, n);
+    _notify_new_gyro_raw_samples(gyro_instance, gyro, n);
+}
+
 bool AP_InertialSensor_Invensensev3::accumulate_samples(const FIFOData *data, uint8_t n_samples)
 {
 #if INV3_ENABLE_FIFO_LOGGING
     const uint64_t tstart = AP_HAL::micros64();
 #endif
+    Vector3f accel_burst[INV3_FIFO_BUFFER_LEN];
+    Vector3f gyro_burst[INV3_FIFO_BUFFER_LEN];
+    uint8_t n_good = 0;
+    bool ret = true;
+    n_samples = MIN(n_samples, INV3_FIFO_BUFFER_LEN);
     for (uint8_t i = 0; i < n_samples; i++) {
         const FIFOData &d = data[i];
 
@@ -418,8 +437,9 @@ bool AP_InertialSensor_Invensensev3::accumulate_samples(const FIFOData *data, ui
         // ICM45686 - TMST_FIELD_EN bit 3 : 1
         // ICM42688 - HEADER_TIMESTAMP_FSYNC bit 2-3 : 10
         if ((d.header & 0xFC) != 0x68) { // ACCEL_EN | GYRO_EN | TMST_FIELD_EN
-            // no or bad data
-            return false;
+            // no or bad data, still use the samples before it
+            ret = false;
+            break;
         }
 
         Vector3f accel{float(d.accel[0]), float(d.accel[1]), float(d.accel[2])};
@@ -433,17 +453,14 @@ bool AP_InertialSensor_Invensensev3::accumulate_samples(const FIFOData *data, ui
 #endif
 
         const float temp = d.temperature * temp_sensitivity + temp_zero;
-
-        // these four calls are about 40us
-        _rotate_and_correct_accel(accel_instance, accel);
-        _rotate_and_correct_gyro(gyro_instance, gyro);
-
-        _notify_new_accel_raw_sample(accel_instance, accel, 0);
-        _notify_new_gyro_raw_sample(gyro_instance, gyro);
-
         temp_filtered = temp_filter.apply(temp);
+
+        accel_burst[n_good] = accel;
+        gyro_burst[n_good] = gyro;
+        n_good++;
     }
-    return true;
+    notify_samples(accel_burst, gyro_burst, n_good);
+    return ret;
 }
 
 #if HAL_INS_HIGHRES_SAMPLE
@@ -471,14 +488,20 @@ bool AP_InertialSensor_Invensensev3::accumulate_highres_samples(const FIFODataHi
 #if INV3_ENABLE_FIFO_LOGGING
     const uint64_t tstart = AP_HAL::micros64();
 #endif
+    Vector3f accel_burst[INV3_FIFO_BUFFER_LEN];
+    Vector3f gyro_burst[INV3_FIFO_BUFFER_LEN];
+    uint8_t n_good = 0;
+    bool ret = true;
+    n_samples = MIN(n_samples, INV3_FIFO_BUFFER_LEN);
     for (uint8_t i = 0; i < n_samples; i++) {
         const FIFODataHighRes &d = data[i];
 
         // we have a header to confirm we don't have FIFO corruption! no more mucking
         // about with the temperature registers
         if ((d.header & 0xFC) != 0x78) { // ACCEL_EN | GYRO_EN | HIRES_EN | TMST_FIELD_EN
-            // no or bad data
-            return false;
+            // no or bad data, still use the samples before it
+            ret = false;
+            break;
         }
 
         Vector3f accel{uint20_to_float(d.accel[1], d.accel[0], d.ax),
@@ -495,17 +518,14 @@ bool AP_InertialSensor_Invensensev3::accumulate_highres_samples(const FIFODataHi
         Write_GYR(gyro_instance, tstart+(i*backend_period_us), gyro, true);
 #endif
         const float temp = d.temperature * temp_sensitivity + temp_zero;
-
-        // these four calls are about 40us
-        _rotate_and_correct_accel(accel_instance, accel);
-        _rotate_and_correct_gyro(gyro_instance, gyro);
-
-        _notify_new_accel_raw_sample(accel_instance, accel, 0);
-        _notify_new_gyro_raw_sample(gyro_instance, gyro);
-
         temp_filtered = temp_filter.apply(temp);
+
+        accel_burst[n_good] = accel;
+        gyro_burst[n_good] = gyro;
+        n_good++;
     }
-    return true;
+    notify_samples(accel_burst, gyro_burst, n_good);
+    return ret;
 }
 #endif
 
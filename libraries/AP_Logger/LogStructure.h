@@ -312,6 +312,8 @@ struct PACKED log_MAV {
     uint8_t flags;
     uint16_t stream_slowdown_ms;
     uint16_t times_full;
+    uint32_t rx_bytes;
+    uint32_t rx_bytes_skipped;
 };
 
 struct PACKED log_RSSI {
@@ -636,6 +638,7 @@ struct PACKED log_Scripting {
     uint32_t run_time;
     int32_t total_mem;
     int32_t run_mem;
+    uint32_t gc_time;
 };
 
 struct PACKED log_MotBatt {
@@ -833,6 +836,8 @@ struct PACKED log_VER {
 // @FieldBitmaskEnum: flags: GCS_MAVLINK::Flags
 // @Field: ss: stream slowdown is the number of ms being added to each message to fit within bandwidth
 // @Field: tf: times buffer was full when a message was going to be sent
+// @Field: rxb: bytes received
+// @Field: rxs: bytes received and skipped while searching for the start of a packet
 
 // @LoggerMessage: MAVC
 // @Description: MAVLink command we have just executed
@@ -1159,6 +1164,7 @@ struct PACKED log_VER {
 // @Field: Runtime: run time
 // @Field: Total_mem: total memory usage of all scripts
 // @Field: Run_mem: run memory usage
+// @Field: GC_time: garbage collection time after the run
 
 // @LoggerMessage: VER
 // @Description: Ardupilot version
@@ -1280,7 +1286,7 @@ LOG_STRUCTURE_FROM_FENCE \
     { LOG_RALLY_MSG, sizeof(log_Rally), \
       "RALY", "QBBLLhB", "TimeUS,Tot,Seq,Lat,Lng,Alt,Flags", "s--DUm-", "F--GGB-" },  \
     { LOG_MAV_MSG, sizeof(log_MAV),   \
-      "MAV", "QBHHHBHH",   "TimeUS,chan,txp,rxp,rxdp,flags,ss,tf", "s#----s-", "F-000-C-" },   \
+      "MAV", "QBHHHBHHII",   "TimeUS,chan,txp,rxp,rxdp,flags,ss,tf,rxb,rxs", "s#----s---", "F-000-C---" },   \
 LOG_STRUCTURE_FROM_VISUALODOM \
     { LOG_OPTFLOW_MSG, sizeof(log_Optflow), \
       "OF",   "QBffff",   "TimeUS,Qual,flowX,flowY,bodyX,bodyY", "s-EEnn", "F-0000" , true }, \
@@ -1303,7 +1309,7 @@ LOG_STRUCTURE_FROM_VISUALODOM \
       "FILE",   "NIBZ",       "FileName,Offset,Length,Data", "----", "----" }, \
 LOG_STRUCTURE_FROM_AIS \
     { LOG_SCRIPTING_MSG, sizeof(log_Scripting), \
-      "SCR",   "QNIii", "TimeUS,Name,Runtime,Total_mem,Run_mem", "s#sbb", "F-F--", true }, \
+      "SCR",   "QNIiiI", "TimeUS,Name,Runtime,Total_mem,Run_mem,GC_time", "s#sbbs", "F-F--F", true }, \
     { LOG_VER_MSG, sizeof(log_VER), \
       "VER",   "QBHBBBBIZHBB", "TimeUS,BT,BST,Maj,Min,Pat,FWT,GH,FWS,APJ,BU,FV", "s-----------", "F-----------", false }, \
     { LOG_MOTBATT_MSG, sizeof(log_MotBatt), \
@@ -19,6 +19,7 @@
 #include "spline5.h"
 #include "location.h"
 #include "control.h"
+#include "fast_math.h"
 
 #if HAL_WITH_EKF_DOUBLE
 typedef Vector2<double> Vector2F;
@@ -0,0 +1,61 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// angles spread over the range the attitude controllers use
+static float bm_angle(uint32_t i)
+{
+    return (int32_t(i % 629) - 314) * 0.01f;
+}
+
+static void BM_SinCosLibm(benchmark::State& state)
+{
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        const float x = bm_angle(i++);
+        float s = sinf(x);
+        float c = cosf(x);
+        gbenchmark_escape(&s);
+        gbenchmark_escape(&c);
+    }
+}
+
+static void BM_SinCosFast(benchmark::State& state)
+{
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        float s, c;
+        fast_sincosf(bm_angle(i++), s, c);
+        gbenchmark_escape(&s);
+        gbenchmark_escape(&c);
+    }
+}
+
+static void BM_Atan2Libm(benchmark::State& state)
+{
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        const float x = bm_angle(i++);
+        float a = atan2f(x, 1.3f - x);
+        gbenchmark_escape(&a);
+    }
+}
+
+static void BM_Atan2Fast(benchmark::State& state)
+{
+    uint32_t i = 0;
+    while (state.KeepRunning()) {
+        const float x = bm_angle(i++);
+        float a = fast_atan2f(x, 1.3f - x);
+        gbenchmark_escape(&a);
+    }
+}
+
+BENCHMARK(BM_SinCosLibm);
+BENCHMARK(BM_SinCosFast);
+BENCHMARK(BM_Atan2Libm);
+BENCHMARK(BM_Atan2Fast);
+
+BENCHMARK_MAIN();
@@ -1,6 +1,7 @@
 #include <AP_gbenchmark.h>
 
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/matrixN.h>
 
 const AP_HAL::HAL& hal = AP_HAL::get_HAL();
 
@@ -21,4 +22,123 @@ static void BM_MatrixMultiplication(benchmark::State& state)
 
 BENCHMARK(BM_MatrixMultiplication);
 
+// symmetric positive definite test matrix as used by least squares fits
+template <uint8_t N>
+static void fill_spd(MatrixN<float,N> &m)
+{
+    for (uint8_t k = 0; k < 2*N; k++) {
+        VectorN<float,N> x;
+        for (uint8_t i = 0; i < N; i++) {
+            x[i] = sinf(k * 0.7f + i * 1.3f) + (i == k % N ? 1.0f : 0.0f);
+        }
+        m.add_outer_lower(x);
+    }
+    m.copy_lower_to_upper();
+}
+
+template <uint8_t N>
+static void BM_MatInverseRuntime(benchmark::State& state)
+{
+    MatrixN<float,N> m;
+    fill_spd(m);
+    float a[N*N];
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = 0; j < N; j++) {
+            a[i*N+j] = m(i, j);
+        }
+    }
+
+    while (state.KeepRunning()) {
+        float inv[N*N];
+        bool ok = mat_inverse(a, inv, N);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(inv);
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixNInverseSPD(benchmark::State& state)
+{
+    MatrixN<float,N> m;
+    fill_spd(m);
+
+    while (state.KeepRunning()) {
+        MatrixN<float,N> inv;
+        bool ok = m.inverse_spd(inv);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&inv);
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixNInverse(benchmark::State& state)
+{
+    MatrixN<float,N> m;
+    fill_spd(m);
+
+    while (state.KeepRunning()) {
+        MatrixN<float,N> inv;
+        bool ok = m.inverse(inv);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&inv);
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixNSolveSPD(benchmark::State& state)
+{
+    MatrixN<float,N> m;
+    fill_spd(m);
+    VectorN<float,N> b;
+    for (uint8_t i = 0; i < N; i++) {
+        b[i] = i + 1;
+    }
+
+    while (state.KeepRunning()) {
+        VectorN<float,N> x;
+        bool ok = m.solve_spd(b, x);
+        gbenchmark_escape(&ok);
+        gbenchmark_escape(&x);
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixNQuadraticForm(benchmark::State& state)
+{
+    MatrixN<float,N> m;
+    fill_spd(m);
+    VectorN<float,N> x;
+    for (uint8_t i = 0; i < N; i++) {
+        x[i] = i + 1;
+    }
+
+    while (state.KeepRunning()) {
+        float q = m.quadratic_form(x);
+        gbenchmark_escape(&q);
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixNMultiplication(benchmark::State& state)
+{
+    MatrixN<float,N> m1;
+    fill_spd(m1);
+    MatrixN<float,N> m2 = m1;
+
+    while (state.KeepRunning()) {
+        MatrixN<float,N> m3 = m1 * m2;
+        gbenchmark_escape(&m3);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_MatInverseRuntime, 4);
+BENCHMARK_TEMPLATE(BM_MatInverseRuntime, 9);
+BENCHMARK_TEMPLATE(BM_MatrixNInverseSPD, 4);
+BENCHMARK_TEMPLATE(BM_MatrixNInverseSPD, 9);
+BENCHMARK_TEMPLATE(BM_MatrixNInverse, 4);
+BENCHMARK_TEMPLATE(BM_MatrixNInverse, 9);
+BENCHMARK_TEMPLATE(BM_MatrixNSolveSPD, 9);
+BENCHMARK_TEMPLATE(BM_MatrixNQuadraticForm, 9);
+BENCHMARK_TEMPLATE(BM_MatrixNMultiplication, 9);
+
 BENCHMARK_MAIN();
@@ -561,8 +561,10 @@ void rc_input_to_roll_pitch(float roll_in_unit, float pitch_in_unit, float angle
     thrust.limit_length(thrust_limit);
 
     // Conversion from angular thrust vector to euler angles.
-    float pitch_rad = - atanf(thrust.x);
-    float roll_rad = atanf(cosf(pitch_rad) * thrust.y);
+    float pitch_rad = - ctrl_atan2f(thrust.x, 1.0f);
+    float sin_pitch, cos_pitch;
+    ctrl_sincosf(pitch_rad, sin_pitch, cos_pitch);
+    float roll_rad = ctrl_atan2f(cos_pitch * thrust.y, 1.0f);
 
     // Convert to degrees
     roll_out_deg = degrees(roll_rad);
@@ -0,0 +1,136 @@
+#pragma once
+
+/*
+  approximate single precision trig functions for control loop hot paths
+
+  These are minimax polynomials evaluated with Horner's rule after a
+  Cody-Waite range reduction, so they use only multiply-adds and one
+  conversion to an integer. On FPU-limited boards they are several
+  times faster than the C library, which has to handle every input to
+  full precision.
+
+  Maximum absolute errors measured against double precision, for
+  |x| <= 1.0e5 (larger inputs fall back to the C library) and for
+  atan2 over every float ratio and magnitudes from 1e-30 to 1e30. The
+  atan2 bound allows for the rounding of the quadrant adjustment,
+  which varies a little with how the compiler contracts multiply-adds:
+    fast_sinf, fast_cosf, fast_sincosf: 2.5e-7
+    fast_atan2f:                        5.3e-7 radians
+
+  sqrt is deliberately not approximated: boards with an FPU have a
+  single hardware instruction for it which no approximation can beat.
+
+  Setting AP_MATH_FAST_TRIG_ENABLED routes the ctrl_ functions, which
+  selected control hot paths use, through these approximations.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <AP_HAL/AP_HAL_Boards.h>
+
+#ifndef AP_MATH_FAST_TRIG_ENABLED
+#define AP_MATH_FAST_TRIG_ENABLED 0
+#endif
+
+// above this the reduction loses accuracy, use the C library instead
+#define AP_MATH_FAST_TRIG_MAX_ARG 1.0e5f
+
+// reduce x to r in [-pi/2, pi/2] with x = r + n*pi, returning whether n is odd
+static inline bool fast_trig_reduce(float x, float &r)
+{
+    // pi split into parts with short mantissas, so that n times each
+    // of the first two is exact for the largest n, and the remainder
+    const float PI_HI = 3.140625f;
+    const float PI_MID = 9.670257568359e-04f;
+    const float PI_LO = 6.278329573e-07f;
+    // round to nearest with a conversion rather than roundf(), which
+    // is a library call on boards without a rounding instruction
+    const float q = x * (float)M_1_PI;
+    const int32_t k = int32_t(q < 0 ? q - 0.5f : q + 0.5f);
+    const float n = float(k);
+    r = ((x - n * PI_HI) - n * PI_MID) - n * PI_LO;
+    return (k & 1) != 0;
+}
+
+// sin and cos of r in [-pi/2, pi/2]
+static inline float fast_sin_poly(float r)
+{
+    const float r2 = r * r;
+    return r * (9.999999766e-01f + r2 * (-1.666664763e-01f + r2 * (8.332899818e-03f + r2 * (-1.980089746e-04f + r2 * 2.590487888e-06f))));
+}
+
+static inline float fast_cos_poly(float r)
+{
+    const float r2 = r * r;
+    return 9.999999535e-01f + r2 * (-4.999990535e-01f + r2 * (4.166358465e-02f + r2 * (-1.385370401e-03f + r2 * 2.315392487e-05f)));
+}
+
+static inline float fast_sinf(float x)
+{
+    if (!(fabsf(x) <= AP_MATH_FAST_TRIG_MAX_ARG)) {
+        return sinf(x);
+    }
+    float r;
+    return fast_trig_reduce(x, r) ? -fast_sin_poly(r) : fast_sin_poly(r);
+}
+
+static inline float fast_cosf(float x)
+{
+    if (!(fabsf(x) <= AP_MATH_FAST_TRIG_MAX_ARG)) {
+        return cosf(x);
+    }
+    float r;
+    return fast_trig_reduce(x, r) ? -fast_cos_poly(r) : fast_cos_poly(r);
+}
+
+// sin and cos of the same angle, sharing the range reduction
+static inline void fast_sincosf(float x, float &s, float &c)
+{
+    if (!(fabsf(x) <= AP_MATH_FAST_TRIG_MAX_ARG)) {
+        s = sinf(x);
+        c = cosf(x);
+        return;
+    }
+    float r;
+    const bool odd = fast_trig_reduce(x, r);
+    s = fast_sin_poly(r);
+    c = fast_cos_poly(r);
+    if (odd) {
+        s = -s;
+        c = -c;
+    }
+}
+
+static inline float fast_atan2f(float y, float x)
+{
+    const float ax = fabsf(x);
+    const float ay = fabsf(y);
+    const bool steep = ay > ax;
+    const float mx = steep ? ay : ax;
+    if (!(mx > 0) || isinf(mx)) {
+        // zeros, infinities and NaN
+        return atan2f(y, x);
+    }
+    // atan of t in [0, 1]
+    const float t = (steep ? ax : ay) / mx;
+    const float t2 = t * t;
+    float a = t * (9.999961113e-01f + t2 * (-3.331736719e-01f + t2 * (1.980780830e-01f + t2 * (-1.323331600e-01f + t2 * (7.962321920e-02f + t2 * (-3.360384423e-02f + t2 * 6.811673447e-03f))))));
+    if (steep) {
+        a = (float)M_PI_2 - a;
+    }
+    if (x < 0) {
+        a = (float)M_PI - a;
+    }
+    return signbit(y) ? -a : a;
+}
+
+/*
+  trig for the control hot paths that may use the approximations
+ */
+#if AP_MATH_FAST_TRIG_ENABLED
+static inline void ctrl_sincosf(float x, float &s, float &c) { fast_sincosf(x, s, c); }
+static inline float ctrl_atan2f(float y, float x) { return fast_atan2f(y, x); }
+#else
+static inline void ctrl_sincosf(float x, float &s, float &c) { s = sinf(x); c = cosf(x); }
+static inline float ctrl_atan2f(float y, float x) { return atan2f(y, x); }
+#endif
@@ -5,7 +5,9 @@
 #pragma once
 
 #include "math.h"
+#include <cmath>
 #include <stdint.h>
+#include <AP_Common/AP_Common.h>
 #include "vectorN.h"
 
 template <typename T, uint8_t N>
@@ -43,6 +45,271 @@ public:
     // Matrix symmetry routine
     void force_symmetry(void);
 
+    // element access
+    T &operator()(uint8_t i, uint8_t j) { return v[i][j]; }
+    const T &operator()(uint8_t i, uint8_t j) const { return v[i][j]; }
+
+    // set to the identity matrix
+    void identity(void);
+
+    // multiplication by another matrix
+    MatrixN<T,N> operator *(const MatrixN<T,N> &B) const;
+
+    // multiplication by a vector
+    VectorN<T,N> operator *(const VectorN<T,N> &x) const;
+
+    /*
+      kernels for symmetric matrices. These only read the lower
+      triangle, so only the lower triangle needs to be kept up to date
+      while accumulating, halving the work
+     */
+
+    // add scale * x * x^T to the lower triangle
+    void add_outer_lower(const VectorN<T,N> &x, T scale = 1);
+
+    // copy the lower triangle into the upper triangle
+    void copy_lower_to_upper(void);
+
+    // x^T * M * x
+    T quadratic_form(const VectorN<T,N> &x) const;
+
+    // lower triangular L such that M = L * L^T. Returns false if the
+    // matrix is not positive definite
+    bool cholesky(MatrixN<T,N> &L) const WARN_IF_UNUSED;
+
+    // solve M * x = b for a symmetric positive definite M
+    bool solve_spd(const VectorN<T,N> &b, VectorN<T,N> &x) const WARN_IF_UNUSED;
+
+    // inverse of a symmetric positive definite matrix using its
+    // Cholesky factor. inv may be this matrix
+    bool inverse_spd(MatrixN<T,N> &inv) const WARN_IF_UNUSED;
+
+    // inverse of a general matrix by Gauss-Jordan elimination with
+    // partial pivoting. inv may be this matrix
+    bool inverse(MatrixN<T,N> &inv) const WARN_IF_UNUSED;
+
 private:
     T v[N][N];
 };
+
+/*
+  the dimension is a template parameter so every loop below has a
+  constant trip count, which lets the compiler fully unroll the small
+  sizes we use, and no temporaries are allocated from the heap
+ */
+
+template <typename T, uint8_t N>
+void MatrixN<T,N>::identity(void)
+{
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = 0; j < N; j++) {
+            v[i][j] = (i == j) ? 1 : 0;
+        }
+    }
+}
+
+template <typename T, uint8_t N>
+MatrixN<T,N> MatrixN<T,N>::operator *(const MatrixN<T,N> &B) const
+{
+    MatrixN<T,N> ret;
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t k = 0; k < N; k++) {
+            const T a = v[i][k];
+            for (uint8_t j = 0; j < N; j++) {
+                ret.v[i][j] += a * B.v[k][j];
+            }
+        }
+    }
+    return ret;
+}
+
+template <typename T, uint8_t N>
+VectorN<T,N> MatrixN<T,N>::operator *(const VectorN<T,N> &x) const
+{
+    VectorN<T,N> ret;
+    for (uint8_t i = 0; i < N; i++) {
+        T sum = 0;
+        for (uint8_t j = 0; j < N; j++) {
+            sum += v[i][j] * x[j];
+        }
+        ret[i] = sum;
+    }
+    return ret;
+}
+
+template <typename T, uint8_t N>
+void MatrixN<T,N>::add_outer_lower(const VectorN<T,N> &x, T scale)
+{
+    for (uint8_t i = 0; i < N; i++) {
+        const T xi = x[i] * scale;
+        for (uint8_t j = 0; j <= i; j++) {
+            v[i][j] += xi * x[j];
+        }
+    }
+}
+
+template <typename T, uint8_t N>
+void MatrixN<T,N>::copy_lower_to_upper(void)
+{
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = i + 1; j < N; j++) {
+            v[i][j] = v[j][i];
+        }
+    }
+}
+
+template <typename T, uint8_t N>
+T MatrixN<T,N>::quadratic_form(const VectorN<T,N> &x) const
+{
+    T diag = 0;
+    T off_diag = 0;
+    for (uint8_t i = 0; i < N; i++) {
+        diag += v[i][i] * x[i] * x[i];
+        for (uint8_t j = 0; j < i; j++) {
+            off_diag += v[i][j] * x[i] * x[j];
+        }
+    }
+    return diag + 2 * off_diag;
+}
+
+template <typename T, uint8_t N>
+bool MatrixN<T,N>::cholesky(MatrixN<T,N> &L) const
+{
+    for (uint8_t j = 0; j < N; j++) {
+        T d = v[j][j];
+        for (uint8_t k = 0; k < j; k++) {
+            d -= L.v[j][k] * L.v[j][k];
+        }
+        // also catches NaN
+        if (!(d > 0)) {
+            return false;
+        }
+        const T ljj = std::sqrt(d);
+        const T inv_ljj = 1 / ljj;
+        L.v[j][j] = ljj;
+        for (uint8_t i = j + 1; i < N; i++) {
+            T sum = v[i][j];
+            for (uint8_t k = 0; k < j; k++) {
+                sum -= L.v[i][k] * L.v[j][k];
+            }
+            L.v[i][j] = sum * inv_ljj;
+            L.v[j][i] = 0;
+        }
+    }
+    return true;
+}
+
+template <typename T, uint8_t N>
+bool MatrixN<T,N>::solve_spd(const VectorN<T,N> &b, VectorN<T,N> &x) const
+{
+    MatrixN<T,N> L;
+    if (!cholesky(L)) {
+        return false;
+    }
+    // forward substitution L * y = b
+    VectorN<T,N> y;
+    for (uint8_t i = 0; i < N; i++) {
+        T sum = b[i];
+        for (uint8_t k = 0; k < i; k++) {
+            sum -= L.v[i][k] * y[k];
+        }
+        y[i] = sum / L.v[i][i];
+    }
+    // back substitution L^T * x = y
+    for (int8_t i = N - 1; i >= 0; i--) {
+        T sum = y[i];
+        for (uint8_t k = i + 1; k < N; k++) {
+            sum -= L.v[k][i] * x[k];
+        }
+        x[i] = sum / L.v[i][i];
+    }
+    return true;
+}
+
+template <typename T, uint8_t N>
+bool MatrixN<T,N>::inverse_spd(MatrixN<T,N> &inv) const
+{
+    MatrixN<T,N> L;
+    if (!cholesky(L)) {
+        return false;
+    }
+    // invert L in place, it stays lower triangular
+    for (uint8_t i = 0; i < N; i++) {
+        const T inv_lii = 1 / L.v[i][i];
+        for (uint8_t j = 0; j < i; j++) {
+            T sum = 0;
+            for (uint8_t k = j; k < i; k++) {
+                sum -= L.v[i][k] * L.v[k][j];
+            }
+            L.v[i][j] = sum * inv_lii;
+        }
+        L.v[i][i] = inv_lii;
+    }
+    // inv = L^-T * L^-1, which is symmetric
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = 0; j <= i; j++) {
+            T sum = 0;
+            for (uint8_t k = i; k < N; k++) {
+                sum += L.v[k][i] * L.v[k][j];
+            }
+            if (!std::isfinite(sum)) {
+                return false;
+            }
+            inv.v[i][j] = sum;
+            inv.v[j][i] = sum;
+        }
+    }
+    return true;
+}
+
+template <typename T, uint8_t N>
+bool MatrixN<T,N>::inverse(MatrixN<T,N> &inv) const
+{
+    MatrixN<T,N> a = *this;
+    inv.identity();
+    for (uint8_t c = 0; c < N; c++) {
+        // pick the largest pivot in this column
+        uint8_t p = c;
+        for (uint8_t r = c + 1; r < N; r++) {
+            if (std::fabs(a.v[r][c]) > std::fabs(a.v[p][c])) {
+                p = r;
+            }
+        }
+        if (!(std::fabs(a.v[p][c]) > 0)) {
+            return false;
+        }
+        if (p != c) {
+            for (uint8_t j = 0; j < N; j++) {
+                const T t1 = a.v[c][j];
+                a.v[c][j] = a.v[p][j];
+                a.v[p][j] = t1;
+                const T t2 = inv.v[c][j];
+                inv.v[c][j] = inv.v[p][j];
+                inv.v[p][j] = t2;
+            }
+        }
+        const T inv_pivot = 1 / a.v[c][c];
+        for (uint8_t j = 0; j < N; j++) {
+            a.v[c][j] *= inv_pivot;
+            inv.v[c][j] *= inv_pivot;
+        }
+        for (uint8_t r = 0; r < N; r++) {
+            if (r == c) {
+                continue;
+            }
+            const T f = a.v[r][c];
+            for (uint8_t j = 0; j < N; j++) {
+                a.v[r][j] -= f * a.v[c][j];
+                inv.v[r][j] -= f * inv.v[c][j];
+            }
+        }
+    }
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = 0; j < N; j++) {
+            if (!std::isfinite(inv.v[i][j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -15,7 +15,7 @@ void PolyFit<order,xtype,vtype>::update(xtype x, vtype y)
     for (int8_t i = 2*(order-1); i >= 0; i--) {
         int8_t k = (i<order)?0:i - order + 1;
         for (int8_t j = i - k; j >= k; j--) {
-            mat[j][i-j] += temp;
+            mat(j, i-j) += temp;
         }
         temp *= x;
     }
@@ -30,13 +30,11 @@ void PolyFit<order,xtype,vtype>::update(xtype x, vtype y)
 template <uint8_t order, typename xtype, typename vtype>
 bool PolyFit<order,xtype,vtype>::get_polynomial(vtype res[order]) const
 {
-    // we dynamically allocate the inverse matrix to keep stack usage low
-    xtype *inv_mat = NEW_NOTHROW xtype[order*order];
-    if (inv_mat == nullptr) {
-        return false;
-    }
-    if (!mat_inverse(&mat[0][0], inv_mat, order)) {
-        delete[] inv_mat;
+    // the accumulated matrix is symmetric positive definite once
+    // there are enough distinct points, so invert it via its Cholesky
+    // factor without any heap allocation
+    MatrixN<xtype,order> inv_mat;
+    if (!mat.inverse_spd(inv_mat)) {
         return false;
     }
     // the summation must be done with double precision to get
@@ -44,9 +42,9 @@ bool PolyFit<order,xtype,vtype>::get_polynomial(vtype res[order]) const
     Vector3d resd[order] {};
     for (uint8_t i = 0; i < order; i++) {
         for (uint8_t j = 0; j < order; j++) {
-            resd[i].x += vec[j].x * inv_mat[i*order+j];
-            resd[i].y += vec[j].y * inv_mat[i*order+j];
-            resd[i].z += vec[j].z * inv_mat[i*order+j];
+            resd[i].x += vec[j].x * inv_mat(i, j);
+            resd[i].y += vec[j].y * inv_mat(i, j);
+            resd[i].z += vec[j].z * inv_mat(i, j);
         }
     }
     for (uint8_t j = 0; j < order; j++) {
@@ -54,7 +52,6 @@ bool PolyFit<order,xtype,vtype>::get_polynomial(vtype res[order]) const
         res[j].y = resd[j].y;
         res[j].z = resd[j].z;
     }
-    delete[] inv_mat;
     return true;
 }
 
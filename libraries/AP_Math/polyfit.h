@@ -9,6 +9,7 @@
 #pragma once
 
 #include <stdint.h>
+#include "matrixN.h"
 
 /*
   polynomial fit with X axis type xtype and yaxis type vtype (must be a vector)
@@ -21,7 +22,7 @@ public:
     bool get_polynomial(vtype res[order]) const;
 
 private:
-    xtype mat[order][order];
+    MatrixN<xtype,order> mat;
     vtype vec[order];
 };
 
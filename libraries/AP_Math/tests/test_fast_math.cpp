@@ -0,0 +1,79 @@
+#include "math_test.h"
+
+#include <AP_Math/fast_math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// the error bounds documented in fast_math.h
+#define SINCOS_MAX_ERROR 2.5e-7
+#define ATAN2_MAX_ERROR 5.3e-7
+
+static void check_sincos(float x)
+{
+    const double xd = x;
+    float s, c;
+    fast_sincosf(x, s, c);
+    EXPECT_NEAR(s, sin(xd), SINCOS_MAX_ERROR) << "x=" << x;
+    EXPECT_NEAR(c, cos(xd), SINCOS_MAX_ERROR) << "x=" << x;
+    EXPECT_NEAR(fast_sinf(x), sin(xd), SINCOS_MAX_ERROR) << "x=" << x;
+    EXPECT_NEAR(fast_cosf(x), cos(xd), SINCOS_MAX_ERROR) << "x=" << x;
+}
+
+TEST(FastMathTest, SinCos)
+{
+    // the range control loops use
+    for (float x = -10.0f; x <= 10.0f; x += 1.0e-4f) {
+        check_sincos(x);
+    }
+    // range reduction over the whole supported range
+    for (float x = -AP_MATH_FAST_TRIG_MAX_ARG; x <= AP_MATH_FAST_TRIG_MAX_ARG; x += 0.37f) {
+        check_sincos(x);
+    }
+    // exact multiples of pi/2 and the fallback outside the range
+    for (int8_t i = -8; i <= 8; i++) {
+        check_sincos(i * M_PI_2);
+    }
+    check_sincos(1.0e7f);
+    EXPECT_TRUE(isnan(fast_sinf(NAN)));
+    EXPECT_TRUE(isnan(fast_cosf(INFINITY)));
+}
+
+static void check_atan2(float y, float x)
+{
+    EXPECT_NEAR(fast_atan2f(y, x), atan2(double(y), double(x)), ATAN2_MAX_ERROR) << "y=" << y << " x=" << x;
+}
+
+TEST(FastMathTest, Atan2)
+{
+    // angles around the circle at radii from 1e-30 to 1e30
+    for (double r = 1.0e-30; r < 1.0e30; r *= 3.7) {
+        for (double a = -M_PI; a <= M_PI; a += 1.3e-3) {
+            check_atan2(r * sin(a), r * cos(a));
+        }
+    }
+    // a fine sweep of the ratio in every octant, where the error peaks
+    // close to a ratio of 1
+    for (float t = 0; t <= 1.0f; t += 1.0e-6f) {
+        check_atan2(t, 1.0f);
+        check_atan2(1.0f, t);
+        check_atan2(t, -1.0f);
+        check_atan2(-1.0f, -t);
+    }
+    // independent magnitudes, so the ratio is rounded from unrelated x and y
+    srand(1);
+    for (uint32_t i = 0; i < 1000000; i++) {
+        const float y = ldexpf(float(rand()) / RAND_MAX - 0.5f, rand() % 200 - 100);
+        const float x = ldexpf(float(rand()) / RAND_MAX - 0.5f, rand() % 200 - 100);
+        check_atan2(y, x);
+    }
+    // signed zeros, axes and infinities behave as atan2f()
+    const float specials[] { 0.0f, -0.0f, 1.0f, -1.0f, INFINITY, -INFINITY };
+    for (const float y : specials) {
+        for (const float x : specials) {
+            EXPECT_FLOAT_EQ(fast_atan2f(y, x), atan2f(y, x)) << "y=" << y << " x=" << x;
+        }
+    }
+    EXPECT_TRUE(isnan(fast_atan2f(NAN, 1.0f)));
+}
+
+AP_GTEST_MAIN()
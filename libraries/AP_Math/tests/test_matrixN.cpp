@@ -0,0 +1,82 @@
+#include "math_test.h"
+
+#include <AP_Math/matrixN.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// symmetric positive definite matrix built from outer products, the
+// way least squares fits accumulate J^T * J
+template <typename T, uint8_t N>
+static MatrixN<T,N> make_spd()
+{
+    MatrixN<T,N> m;
+    for (uint8_t k = 0; k < 2*N; k++) {
+        VectorN<T,N> x;
+        for (uint8_t i = 0; i < N; i++) {
+            x[i] = sin(k * 0.7 + i * 1.3) + (i == k % N ? 1.0 : 0.0);
+        }
+        m.add_outer_lower(x);
+    }
+    m.copy_lower_to_upper();
+    return m;
+}
+
+TEST(MatrixNTest, InverseSPD)
+{
+    const MatrixN<double,9> m = make_spd<double,9>();
+    MatrixN<double,9> inv;
+    EXPECT_TRUE(m.inverse_spd(inv));
+    const MatrixN<double,9> prod = m * inv;
+    for (uint8_t i = 0; i < 9; i++) {
+        for (uint8_t j = 0; j < 9; j++) {
+            EXPECT_NEAR(prod(i, j), i == j ? 1.0 : 0.0, 1.0e-9);
+        }
+    }
+
+    // in place inversion and the general inverse agree
+    MatrixN<double,9> inv2 = m;
+    EXPECT_TRUE(inv2.inverse_spd(inv2));
+    MatrixN<double,9> inv3;
+    EXPECT_TRUE(m.inverse(inv3));
+    for (uint8_t i = 0; i < 9; i++) {
+        for (uint8_t j = 0; j < 9; j++) {
+            EXPECT_NEAR(inv(i, j), inv2(i, j), 1.0e-9);
+            EXPECT_NEAR(inv(i, j), inv3(i, j), 1.0e-9);
+        }
+    }
+}
+
+TEST(MatrixNTest, SolveSPD)
+{
+    const MatrixN<float,4> m = make_spd<float,4>();
+    VectorN<float,4> x;
+    for (uint8_t i = 0; i < 4; i++) {
+        x[i] = i - 1.5f;
+    }
+    const VectorN<float,4> b = m * x;
+    VectorN<float,4> x2;
+    EXPECT_TRUE(m.solve_spd(b, x2));
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_NEAR(x[i], x2[i], 1.0e-4);
+    }
+    EXPECT_NEAR(m.quadratic_form(x), x * b, 1.0e-4);
+}
+
+TEST(MatrixNTest, NotPositiveDefinite)
+{
+    MatrixN<float,4> m;
+    m.identity();
+    m(2, 2) = -1;
+    MatrixN<float,4> L;
+    EXPECT_FALSE(m.cholesky(L));
+    MatrixN<float,4> inv;
+    EXPECT_FALSE(m.inverse_spd(inv));
+    // a general inverse still exists
+    EXPECT_TRUE(m.inverse(inv));
+    EXPECT_FLOAT_EQ(inv(2, 2), -1);
+
+    m = MatrixN<float,4>();
+    EXPECT_FALSE(m.inverse(inv));
+}
+
+AP_GTEST_MAIN()
@@ -85,6 +85,9 @@ void AP_Mission::init()
         _cmd_total.set(0);
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    init_cache();
+#endif
 
     // check_eeprom_version - checks version of missions stored in eeprom matches this library
     // command list will be cleared if they do not match
@@ -300,7 +303,165 @@ void AP_Mission::truncate(uint16_t index)
     if ((unsigned)_cmd_total > index) {
         _cmd_total.set_and_save(index);
         _last_change_time_ms = AP_HAL::millis();
+#if AP_MISSION_LEG_INDEX_ENABLED
+        _leg_index_built = false;
+#endif
+#if AP_MISSION_CACHE_ENABLED
+        // free the cache of a cleared mission straight away
+        resize_cache(index);
+#endif
+    }
+}
+
+#if AP_MISSION_CACHE_ENABLED
+/*
+  work out how many commands the RAM budget allows the cache to
+  hold. The cache itself is allocated when a mission is searched
+ */
+void AP_Mission::init_cache()
+{
+    _cache_max = MIN(uint32_t(_commands_max),
+                     AP_MISSION_CACHE_MAX_BYTES / (sizeof(Mission_Command) + sizeof(cache_index)));
+}
+
+/*
+  size the command cache and search index to a mission of total
+  commands, rounded up so a mission growing one command at a time is
+  not reallocated on every command. The cache is freed when there is
+  no mission, and if allocation fails commands are read from storage
+ */
+void AP_Mission::resize_cache(uint16_t total) const
+{
+    WITH_SEMAPHORE(_rsem);
+
+    uint16_t entries = 0;
+    if (total > 1) {
+        entries = MIN(uint32_t(_cache_max),
+                      (uint32_t(total) + AP_MISSION_CACHE_CHUNK - 1) / AP_MISSION_CACHE_CHUNK * AP_MISSION_CACHE_CHUNK);
+    }
+    if (entries == _cache_size) {
+        return;
+    }
+    delete[] _cache;
+    delete[] _cache_index;
+    _cache = nullptr;
+    _cache_index = nullptr;
+    _cache_size = 0;
+    _cache_index_valid = false;
+    if (entries < 2) {
+        return;
+    }
+    _cache = NEW_NOTHROW Mission_Command[entries];
+    _cache_index = NEW_NOTHROW cache_index[entries];
+    if (_cache == nullptr || _cache_index == nullptr) {
+        delete[] _cache;
+        delete[] _cache_index;
+        _cache = nullptr;
+        _cache_index = nullptr;
+        return;
+    }
+    for (uint16_t i = 0; i < entries; i++) {
+        _cache[i].index = AP_MISSION_CMD_INDEX_NONE;
+    }
+    _cache_size = entries;
+}
+
+/*
+  rebuild the search index after the mission has changed. This reads
+  every command, so it also fills the cache
+ */
+bool AP_Mission::update_cache_index() const
+{
+    WITH_SEMAPHORE(_rsem);
+
+    const uint16_t total = _cmd_total;
+    resize_cache(total);
+    if (total > _cache_size) {
+        // searches fall back to reading storage, say so once per mission size
+        if (_cache_index_skipped_total != total) {
+            _cache_index_skipped_total = total;
+            GCS_SEND_TEXT(MAV_SEVERITY_INFO, "Mission: %u cmds exceed cache of %u, not indexed", unsigned(total), unsigned(_cache_size));
+        }
+        return false;
+    }
+    if (_cache_index_valid && _cache_index_cmd_total == total) {
+        return true;
+    }
+
+    uint16_t next_nav_or_jump = total;
+    uint16_t next_indexed = total;
+    for (int32_t i = total-1; i >= 0; i--) {
+        Mission_Command cmd;
+        if (!read_cmd_from_storage(i, cmd)) {
+            return false;
+        }
+        if (is_nav_cmd(cmd) || cmd.id == MAV_CMD_DO_JUMP || cmd.id == MAV_CMD_DO_JUMP_TAG) {
+            next_nav_or_jump = i;
+        }
+        if (is_indexed_cmd(cmd.id)) {
+            next_indexed = i;
+        }
+        _cache_index[i].next_nav_or_jump = next_nav_or_jump;
+        _cache_index[i].next_indexed = next_indexed;
     }
+
+    _cache_index_cmd_total = total;
+    _cache_index_valid = true;
+    return true;
+}
+#endif // AP_MISSION_CACHE_ENABLED
+
+// true for commands find_cmd() can locate through the cache index
+bool AP_Mission::is_indexed_cmd(uint16_t id)
+{
+    switch (id) {
+    case MAV_CMD_DO_LAND_START:
+    case MAV_CMD_DO_RETURN_PATH_START:
+    case MAV_CMD_DO_GO_AROUND:
+    case MAV_CMD_JUMP_TAG:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*
+  find the first command with this id at or after start_index. Returns
+  0 if there is none
+ */
+uint16_t AP_Mission::find_cmd(uint16_t start_index, uint16_t id) const
+{
+    const uint16_t count = num_commands();
+#if AP_MISSION_CACHE_ENABLED
+    if (is_indexed_cmd(id)) {
+        WITH_SEMAPHORE(_rsem);
+        if (update_cache_index()) {
+            uint16_t i = start_index;
+            while (i < count) {
+                i = _cache_index[i].next_indexed;
+                if (i >= count) {
+                    break;
+                }
+                if (_cache[i].id == id) {
+                    return i;
+                }
+                i++;
+            }
+            return 0;
+        }
+    }
+#endif
+    for (uint16_t i = start_index; i < count; i++) {
+        if (get_command_id(i) != id) {
+            continue;
+        }
+        // confirm with full read
+        Mission_Command tmp;
+        if (read_cmd_from_storage(i, tmp) && tmp.id == id) {
+            return i;
+        }
+    }
+    return 0;
 }
 
 /// update - ensures the command queues are loaded with the next command and calls main programs command_init and command_verify functions to progress the mission
@@ -520,6 +681,19 @@ bool AP_Mission::get_next_nav_cmd(uint16_t start_index, Mission_Command& cmd)
 {
     // search until the end of the mission command list
     for (uint16_t cmd_index = start_index; cmd_index < (unsigned)_cmd_total; cmd_index++) {
+#if AP_MISSION_CACHE_ENABLED
+        // skip straight past do commands, get_next_cmd() would return
+        // them and they are not what we are looking for
+        {
+            WITH_SEMAPHORE(_rsem);
+            if (update_cache_index()) {
+                cmd_index = _cache_index[cmd_index].next_nav_or_jump;
+                if (cmd_index >= (unsigned)_cmd_total) {
+                    break;
+                }
+            }
+        }
+#endif
         // get next command
         if (!get_next_cmd(cmd_index, cmd, false)) {
             // no more commands so return failure
@@ -795,6 +969,26 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    if (index < _cache_size) {
+        Mission_Command &cached = _cache[index];
+        if (cached.index != index) {
+            decode_cmd_from_storage(index, cached);
+        }
+        cmd = cached;
+        return true;
+    }
+#endif
+
+    decode_cmd_from_storage(index, cmd);
+
+    // return success
+    return true;
+}
+
+/// decode_cmd_from_storage - decode the command at index from storage
+void AP_Mission::decode_cmd_from_storage(uint16_t index, Mission_Command& cmd) const
+{
     // ensure all bytes of cmd are zeroed
     cmd = {};
 
@@ -852,9 +1046,6 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
 
     // set command's index to it's position in eeprom
     cmd.index = index;
-
-    // return success
-    return true;
 }
 
 bool AP_Mission::stored_in_location(uint16_t id)
@@ -940,6 +1131,18 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         _storage.write_block(pos_in_storage+5, packed.bytes, 10);
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    // keep the cache in step with storage, decoding the stored form
+    // so the cached copy is exactly what a read would return
+    if (index != 0 && index < _cache_size) {
+        decode_cmd_from_storage(index, _cache[index]);
+    }
+    _cache_index_valid = false;
+#endif
+#if AP_MISSION_LEG_INDEX_ENABLED
+    _leg_index_built = false;
+#endif
+
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
 
@@ -2223,16 +2426,9 @@ bool AP_Mission::jump_to_tag(const uint16_t tag)
 // Returns 0 if no appropriate JUMP_TAG match can be found.
 uint16_t AP_Mission::get_index_of_jump_tag(const uint16_t tag) const
 {
-    const auto count = num_commands();
-    for (uint16_t i = 1; i < count; i++) {
-        if (get_command_id(i) != uint16_t(MAV_CMD_JUMP_TAG)) {
-            continue;
-        }
+    for (uint16_t i = find_cmd(1, MAV_CMD_JUMP_TAG); i != 0; i = find_cmd(i+1, MAV_CMD_JUMP_TAG)) {
         Mission_Command tmp;
-        if (!read_cmd_from_storage(i, tmp)) {
-            continue;
-        }
-        if (tmp.id == MAV_CMD_JUMP_TAG && tmp.content.jump.target == tag) {
+        if (read_cmd_from_storage(i, tmp) && tmp.content.jump.target == tag) {
             return i;
         }
     }
@@ -2340,14 +2536,14 @@ void AP_Mission::check_eeprom_version()
 uint16_t AP_Mission::get_landing_sequence_start(const Location &current_loc)
 {
     uint16_t landing_start_index = 0;
+    if (landing_sequence_start_from_index(current_loc, landing_start_index)) {
+        return landing_start_index;
+    }
+
     float min_distance = -1;
 
     // Go through mission looking for nearest landing start command
-    const auto count = num_commands();
-    for (uint16_t i = 1; i < count; i++) {
-        if (get_command_id(i) != uint16_t(MAV_CMD_DO_LAND_START)) {
-            continue;
-        }
+    for (uint16_t i = find_cmd(1, MAV_CMD_DO_LAND_START); i != 0; i = find_cmd(i+1, MAV_CMD_DO_LAND_START)) {
         Mission_Command tmp;
         if (!read_cmd_from_storage(i, tmp)) {
             continue;
@@ -2410,17 +2606,19 @@ bool AP_Mission::jump_to_closest_mission_leg(const Location &current_loc)
     }
 
     uint16_t landing_start_index = 0;
-    float min_distance = -1;
-
-    // Go through mission and check each DO_RETURN_PATH_START
-    for (uint16_t i = 1; i < num_commands(); i++) {
-        Mission_Command tmp;
-        if (read_cmd_from_storage(i, tmp) && (tmp.id == MAV_CMD_DO_RETURN_PATH_START)) {
-            uint16_t tmp_index;
-            float tmp_distance;
-            if (distance_to_mission_leg(i, tmp_distance, tmp_index, current_loc) && (min_distance < 0 || tmp_distance <= min_distance)){
-                min_distance = tmp_distance;
-                landing_start_index = tmp_index;
+    if (!closest_mission_leg_from_index(current_loc, landing_start_index)) {
+        float min_distance = -1;
+
+        // Go through mission and check each DO_RETURN_PATH_START
+        for (uint16_t i = find_cmd(1, MAV_CMD_DO_RETURN_PATH_START); i != 0; i = find_cmd(i+1, MAV_CMD_DO_RETURN_PATH_START)) {
+            Mission_Command tmp;
+            if (read_cmd_from_storage(i, tmp) && (tmp.id == MAV_CMD_DO_RETURN_PATH_START)) {
+                uint16_t tmp_index;
+                float tmp_distance;
+                if (distance_to_mission_leg(i, tmp_distance, tmp_index, current_loc) && (min_distance < 0 || tmp_distance <= min_distance)){
+                    min_distance = tmp_distance;
+                    landing_start_index = tmp_index;
+                }
             }
         }
     }
@@ -2447,11 +2645,7 @@ bool AP_Mission::jump_to_abort_landing_sequence(const Location &current_loc)
     uint16_t abort_index = 0;
     float min_distance = FLT_MAX;
 
-    const auto count = num_commands();
-    for (uint16_t i = 1; i < count; i++) {
-        if (get_command_id(i) != uint16_t(MAV_CMD_DO_GO_AROUND)) {
-            continue;
-        }
+    for (uint16_t i = find_cmd(1, MAV_CMD_DO_GO_AROUND); i != 0; i = find_cmd(i+1, MAV_CMD_DO_GO_AROUND)) {
         Mission_Command tmp;
         if (!read_cmd_from_storage(i, tmp)) {
             continue;
@@ -2674,6 +2868,185 @@ reset_do_jump_tracking:
     return ret;
 }
 
+#if AP_MISSION_LEG_INDEX_ENABLED
+/*
+  rebuild the spatial indexes if the mission has changed
+ */
+void AP_Mission::update_leg_indexes()
+{
+    WITH_SEMAPHORE(_rsem);
+
+    if (_leg_index_built && _leg_index_cmd_total == _cmd_total) {
+        return;
+    }
+    _return_path_index_ok = build_return_path_index();
+    _landing_start_index_ok = build_landing_start_index();
+    _leg_index_cmd_total = _cmd_total;
+    _leg_index_built = true;
+}
+
+/*
+  index the legs distance_to_mission_leg() would measure from each
+  DO_RETURN_PATH_START, walking the mission the same way it does. A
+  walk through a jump depends on the jump counters, and a leg with no
+  horizontal length may or may not be measured depending on the
+  altitudes, so missions containing either are not indexed
+ */
+bool AP_Mission::build_return_path_index()
+{
+    _return_path_index.clear();
+
+    // paths are numbered in mission order, and on equal distances
+    // jump_to_closest_mission_leg() prefers later paths
+    uint16_t path = 0;
+    for (uint16_t start = find_cmd(1, MAV_CMD_DO_RETURN_PATH_START); start != 0; start = find_cmd(start+1, MAV_CMD_DO_RETURN_PATH_START), path++) {
+        const uint16_t path_first_item = _return_path_index.num_items();
+        Location prev_loc;
+        uint16_t prev_index = 0;
+        uint16_t num_points = 0;
+        bool path_ended = false;
+        uint16_t cmd_index = start;
+        for (uint8_t i=0; i<255; i++) {
+            Mission_Command cmd;
+            if (!read_cmd_from_storage(cmd_index, cmd)) {
+                // got to the end of the mission
+                path_ended = true;
+                break;
+            }
+            if (cmd.id == MAV_CMD_DO_JUMP || cmd.id == MAV_CMD_DO_JUMP_TAG) {
+                return false;
+            }
+            cmd_index++;
+
+            const Location &loc = cmd.content.location;
+            if (stored_in_location(cmd.id) && loc.initialised()) {
+                if (loc.lat == 0 && loc.lng == 0) {
+                    // treated as a missing previous location by the walk
+                    return false;
+                }
+                // within a path earlier legs win on equal distances
+                const uint32_t order = (uint32_t(UINT16_MAX - path) << 16) | num_points;
+                if (num_points == 0) {
+                    if (!_return_path_index.add(loc, loc, cmd.index, cmd.index, cmd.index, order)) {
+                        return false;
+                    }
+                } else if (loc.lat == prev_loc.lat && loc.lng == prev_loc.lng) {
+                    return false;
+                } else if (!_return_path_index.add(prev_loc, loc, prev_index, cmd.index, cmd.index, order)) {
+                    return false;
+                }
+                prev_loc = loc;
+                prev_index = cmd.index;
+                num_points++;
+            }
+
+            if (is_landing_type_cmd(cmd.id) || (cmd.id == MAV_CMD_DO_LAND_START)) {
+                path_ended = true;
+                break;
+            }
+        }
+        if (!path_ended) {
+            // distance_to_mission_leg() gives up on paths this long
+            _return_path_index.truncate(path_first_item);
+        }
+    }
+    return _return_path_index.build();
+}
+
+/*
+  index the location get_landing_sequence_start() measures for each
+  DO_LAND_START
+ */
+bool AP_Mission::build_landing_start_index()
+{
+    _landing_start_index.clear();
+
+    uint16_t num_starts = 0;
+    for (uint16_t i = find_cmd(1, MAV_CMD_DO_LAND_START); i != 0; i = find_cmd(i+1, MAV_CMD_DO_LAND_START)) {
+        Mission_Command tmp;
+        if (!read_cmd_from_storage(i, tmp)) {
+            continue;
+        }
+        if (!tmp.content.location.initialised()) {
+            // use the next nav command, which without jumps in the way
+            // is the next one in the mission
+            bool found = false;
+            for (uint16_t j = i+1; j < (unsigned)_cmd_total && !found; j++) {
+                if (!read_cmd_from_storage(j, tmp)) {
+                    return false;
+                }
+                if (tmp.id == MAV_CMD_DO_JUMP || tmp.id == MAV_CMD_DO_JUMP_TAG) {
+                    return false;
+                }
+                found = is_nav_cmd(tmp);
+            }
+            if (!found) {
+                continue;
+            }
+        }
+        // earlier starts win on equal distances
+        if (!_landing_start_index.add(tmp.content.location, tmp.content.location, tmp.index, tmp.index, i, num_starts++)) {
+            return false;
+        }
+    }
+    return _landing_start_index.build();
+}
+#endif // AP_MISSION_LEG_INDEX_ENABLED
+
+bool AP_Mission::closest_mission_leg_from_index(const Location &current_loc, uint16_t &index)
+{
+#if AP_MISSION_LEG_INDEX_ENABLED
+    WITH_SEMAPHORE(_rsem);
+    update_leg_indexes();
+    if (!_return_path_index_ok) {
+        return false;
+    }
+    // the same distance calculation as distance_to_mission_leg()
+    auto leg_distance = [this, &current_loc](const AP_Mission_LegIndex::Item &item) -> float {
+        Mission_Command cmd;
+        read_cmd_from_storage(item.end, cmd);
+        const Location &loc = cmd.content.location;
+        if (item.start == item.end) {
+            return loc.get_distance_NED_alt_frame(current_loc).length();
+        }
+        Mission_Command prev_cmd;
+        read_cmd_from_storage(item.start, prev_cmd);
+        const Location &prev_loc = prev_cmd.content.location;
+        const Vector3f mission_vector = prev_loc.get_distance_NED_alt_frame(loc);
+        const Vector3f pos = prev_loc.get_distance_NED_alt_frame(current_loc);
+        Vector3f p = pos.projected(mission_vector);
+        p.x = constrain_float(p.x, MIN(0,mission_vector.x), MAX(0,mission_vector.x));
+        p.y = constrain_float(p.y, MIN(0,mission_vector.y), MAX(0,mission_vector.y));
+        p.z = constrain_float(p.z, MIN(0,mission_vector.z), MAX(0,mission_vector.z));
+        return (p - pos).length();
+    };
+    index = 0;
+    return _return_path_index.nearest(current_loc, leg_distance, index);
+#else
+    return false;
+#endif
+}
+
+bool AP_Mission::landing_sequence_start_from_index(const Location &current_loc, uint16_t &index)
+{
+#if AP_MISSION_LEG_INDEX_ENABLED
+    WITH_SEMAPHORE(_rsem);
+    update_leg_indexes();
+    if (!_landing_start_index_ok) {
+        return false;
+    }
+    auto start_distance = [this, &current_loc](const AP_Mission_LegIndex::Item &item) -> float {
+        Mission_Command cmd;
+        read_cmd_from_storage(item.end, cmd);
+        return cmd.content.location.get_distance_NED_alt_frame(current_loc).length();
+    };
+    index = 0;
+    return _landing_start_index.nearest(current_loc, start_distance, index);
+#else
+    return false;
+#endif
+}
+
 // check if command is a landing type command.
 bool AP_Mission::is_landing_type_cmd(uint16_t id) const
 {
@@ -2845,6 +3218,14 @@ const char *AP_Mission::Mission_Command::type() const
  */
 uint16_t AP_Mission::get_command_id(uint16_t index) const
 {
+#if AP_MISSION_CACHE_ENABLED
+    {
+        WITH_SEMAPHORE(_rsem);
+        if (index < _cache_size && _cache[index].index == index) {
+            return _cache[index].id;
+        }
+    }
+#endif
     const uint16_t pos_in_storage = 4 + (index * AP_MISSION_EEPROM_COMMAND_SIZE);
     uint8_t b[3] {};
     if (!_storage.read_block(b, pos_in_storage, sizeof(b))) {
@@ -2864,21 +3245,7 @@ uint16_t AP_Mission::get_command_id(uint16_t index) const
  */
 bool AP_Mission::contains_item(MAV_CMD command) const
 {
-    const auto count = num_commands();
-    for (uint16_t i = 1; i < count; i++) {
-        if (get_command_id(i) != uint16_t(command)) {
-            continue;
-        }
-        // confirm with full read
-        Mission_Command tmp;
-        if (!read_cmd_from_storage(i, tmp)) {
-            continue;
-        }
-        if (tmp.id == command) {
-            return true;
-        }
-    }
-    return false;
+    return find_cmd(1, command) != 0;
 }
 
 /*
@@ -21,6 +21,7 @@
 #include <AP_Param/AP_Param.h>
 #include <StorageManager/StorageManager.h>
 #include <AP_Common/float16.h>
+#include "AP_Mission_LegIndex.h"
 
 // definitions
 #define AP_MISSION_EEPROM_VERSION           0x65AE  // version number stored in first four bytes of eeprom.  increment this by one when eeprom format is changed
@@ -773,6 +774,8 @@ public:
 #endif
 
 private:
+    friend class AP_Mission_Test;
+
     static AP_Mission *_singleton;
 
     static StorageAccess _storage;
@@ -916,6 +919,73 @@ private:
     // fast call to get command ID of a mission index
     uint16_t get_command_id(uint16_t index) const;
 
+    // decode a command from storage without range checks or caching
+    void decode_cmd_from_storage(uint16_t index, Mission_Command& cmd) const;
+
+    // find the first command with this id at or after start_index
+    // (which must be at least 1). Returns 0 if there is none
+    uint16_t find_cmd(uint16_t start_index, uint16_t id) const;
+
+    // true for commands find_cmd() can locate through the cache index
+    static bool is_indexed_cmd(uint16_t id);
+
+#if AP_MISSION_CACHE_ENABLED
+    /*
+      decoded copies of the first _cache_size commands. An entry is
+      valid when its index matches its position, home (index 0) is
+      never cached as it comes from the AHRS. Entries are filled when
+      read and written through when a command is stored. The cache is
+      sized to the mission when it is searched, see resize_cache()
+     */
+    mutable Mission_Command *_cache;
+    mutable uint16_t _cache_size;
+    uint16_t _cache_max;        // most commands the RAM budget allows
+
+    /*
+      per-command search index, only used while the whole mission fits
+      in the cache. Rebuilt on first use after the mission changes
+     */
+    struct cache_index {
+        uint16_t next_nav_or_jump;  // first nav or jump command at or after this one
+        uint16_t next_indexed;      // first command find_cmd() looks for at or after this one
+    };
+    mutable cache_index *_cache_index;
+    mutable bool _cache_index_valid;
+    mutable uint16_t _cache_index_cmd_total;   // mission length the index was built for
+    mutable uint16_t _cache_index_skipped_total;   // mission length last reported as too long to index
+
+    void init_cache();
+    void resize_cache(uint16_t total) const;
+    // build the search index if needed, returns false if it is unavailable
+    bool update_cache_index() const;
+#endif
+
+#if AP_MISSION_LEG_INDEX_ENABLED
+    /*
+      spatial indexes of the legs after each DO_RETURN_PATH_START and
+      of the DO_LAND_START locations. They are rebuilt on first use
+      after the mission changes, and are not used if the mission
+      contains anything they cannot represent exactly
+     */
+    AP_Mission_LegIndex _return_path_index;
+    AP_Mission_LegIndex _landing_start_index;
+    bool _leg_index_built;
+    uint16_t _leg_index_cmd_total;     // mission length the indexes were built for
+    bool _return_path_index_ok;
+    bool _landing_start_index_ok;
+
+    void update_leg_indexes();
+    bool build_return_path_index();
+    bool build_landing_start_index();
+#endif
+
+    // find the closest mission leg using the spatial index. Returns
+    // false if the index cannot answer
+    bool closest_mission_leg_from_index(const Location &current_loc, uint16_t &index);
+    // find the closest landing sequence start using the spatial
+    // index. Returns false if the index cannot answer
+    bool landing_sequence_start_from_index(const Location &current_loc, uint16_t &index);
+
     // memoisation of contains-relative:
     bool _contains_terrain_alt_items;  // true if the mission has terrain-relative items
     uint32_t _last_contains_relative_calculated_ms;  // will be equal to _last_change_time_ms if _contains_terrain_alt_items is up-to-date
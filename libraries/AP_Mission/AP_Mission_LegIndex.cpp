@@ -0,0 +1,185 @@
+/// @file    AP_Mission_LegIndex.cpp
+/// @brief   Spatial index of mission legs for nearest leg searches
+
+#include "AP_Mission_LegIndex.h"
+
+#if AP_MISSION_LEG_INDEX_ENABLED
+
+#include <string.h>
+
+// maximum number of items in a leaf of the tree
+#define LEG_INDEX_LEAF_SIZE 4
+
+// items are allocated in blocks of this many
+#define LEG_INDEX_ALLOC_BLOCK 32
+
+// the local frame is not used near the poles
+#define LEG_INDEX_MAX_LATITUDE_E7 800000000
+
+AP_Mission_LegIndex::~AP_Mission_LegIndex()
+{
+    delete[] _items;
+    delete[] _nodes;
+}
+
+void AP_Mission_LegIndex::clear()
+{
+    _num_items = 0;
+    _num_nodes = 0;
+    _radius = 0;
+}
+
+bool AP_Mission_LegIndex::add(const Location &start_loc, const Location &end_loc, uint16_t start, uint16_t end, uint16_t result, uint32_t order)
+{
+    if (_num_items == 0) {
+        if (abs(start_loc.lat) > LEG_INDEX_MAX_LATITUDE_E7) {
+            return false;
+        }
+        _frame.set_origin(start_loc);
+    }
+    if (_num_items == UINT16_MAX) {
+        return false;
+    }
+    if (_num_items >= _items_space) {
+        const uint16_t space = MIN(uint32_t(_items_space) + LEG_INDEX_ALLOC_BLOCK, uint32_t(UINT16_MAX));
+        Item *items = NEW_NOTHROW Item[space];
+        if (items == nullptr) {
+            return false;
+        }
+        if (_items != nullptr) {
+            memcpy(items, _items, _num_items * sizeof(Item));
+        }
+        delete[] _items;
+        _items = items;
+        _items_space = space;
+    }
+
+    const Vector2f a = _frame.get_distance_NE(start_loc);
+    const Vector2f b = _frame.get_distance_NE(end_loc);
+    const float radius = MAX(a.length(), b.length());
+    if (!(radius < AP_MISSION_LEG_INDEX_MAX_RADIUS_M)) {
+        return false;
+    }
+    _radius = MAX(_radius, radius);
+
+    Item &item = _items[_num_items++];
+    item.min_ne = Vector2f(MIN(a.x, b.x), MIN(a.y, b.y));
+    item.max_ne = Vector2f(MAX(a.x, b.x), MAX(a.y, b.y));
+    item.start = start;
+    item.end = end;
+    item.result = result;
+    item.order = order;
+
+    // the tree must be rebuilt
+    _num_nodes = 0;
+    return true;
+}
+
+bool AP_Mission_LegIndex::build()
+{
+    _num_nodes = 0;
+    if (_num_items == 0) {
+        return true;
+    }
+    // each leaf holds at least two items, except for a tree of one
+    // item, so there are never more nodes than items
+    if (_nodes_space < _num_items) {
+        delete[] _nodes;
+        _nodes = NEW_NOTHROW Node[_num_items];
+        if (_nodes == nullptr) {
+            _nodes_space = 0;
+            return false;
+        }
+        _nodes_space = _num_items;
+    }
+    build_node(0, _num_items);
+    return true;
+}
+
+uint16_t AP_Mission_LegIndex::build_node(uint16_t first, uint16_t count)
+{
+    const uint16_t n = _num_nodes++;
+    Node &node = _nodes[n];
+
+    node.min_ne = _items[first].min_ne;
+    node.max_ne = _items[first].max_ne;
+    for (uint16_t i = first+1; i < first+count; i++) {
+        node.min_ne.x = MIN(node.min_ne.x, _items[i].min_ne.x);
+        node.min_ne.y = MIN(node.min_ne.y, _items[i].min_ne.y);
+        node.max_ne.x = MAX(node.max_ne.x, _items[i].max_ne.x);
+        node.max_ne.y = MAX(node.max_ne.y, _items[i].max_ne.y);
+    }
+
+    if (count <= LEG_INDEX_LEAF_SIZE) {
+        node.first = first;
+        node.count = count;
+        return n;
+    }
+
+    // split at the median centre along the longer side of the box,
+    // using quickselect to partition the items
+    const bool split_north = (node.max_ne.x - node.min_ne.x) >= (node.max_ne.y - node.min_ne.y);
+    const uint16_t half = count / 2;
+    uint16_t lo = first;
+    uint16_t hi = first + count - 1;
+    const uint16_t mid = first + half;
+    while (lo < hi) {
+        const Item &p = _items[(lo + hi) / 2];
+        const float pivot = split_north ? p.min_ne.x + p.max_ne.x : p.min_ne.y + p.max_ne.y;
+        uint16_t i = lo;
+        uint16_t j = hi;
+        while (i <= j) {
+            while ((split_north ? _items[i].min_ne.x + _items[i].max_ne.x : _items[i].min_ne.y + _items[i].max_ne.y) < pivot) {
+                i++;
+            }
+            while ((split_north ? _items[j].min_ne.x + _items[j].max_ne.x : _items[j].min_ne.y + _items[j].max_ne.y) > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                const Item tmp = _items[i];
+                _items[i] = _items[j];
+                _items[j] = tmp;
+                i++;
+                if (j == 0) {
+                    break;
+                }
+                j--;
+            }
+        }
+        if (mid <= j) {
+            hi = j;
+        } else if (mid >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+
+    node.count = 0;
+    build_node(first, half);
+    _nodes[n].right = build_node(first + half, count - half);
+    return n;
+}
+
+float AP_Mission_LegIndex::box_distance(const Vector2f &pos, const Vector2f &min_ne, const Vector2f &max_ne)
+{
+    const float dn = MAX(MAX(min_ne.x - pos.x, pos.x - max_ne.x), 0.0f);
+    const float de = MAX(MAX(min_ne.y - pos.y, pos.y - max_ne.y), 0.0f);
+    return norm(dn, de);
+}
+
+/*
+  distances in the local frame use the longitude scale between the
+  origin and each point, while distances between two points use the
+  scale between them. The relative difference is about the latitude
+  difference in radians times the tangent of the latitude, which is
+  allowed for twice over
+ */
+float AP_Mission_LegIndex::lower_bound_scale(float radius) const
+{
+    const float lat_rad = fabsf(_frame.get_origin().lat * (1.0e-7f * DEG_TO_RAD));
+    const float dlat_rad = radius / RADIUS_OF_EARTH;
+    return MAX(1.0f - 2.0f * dlat_rad * (tanf(lat_rad) + 1.0f), 0.0f);
+}
+
+#endif // AP_MISSION_LEG_INDEX_ENABLED
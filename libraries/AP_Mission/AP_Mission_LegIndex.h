@@ -0,0 +1,163 @@
+/// @file    AP_Mission_LegIndex.h
+/// @brief   Spatial index of mission legs for nearest leg searches
+
+/*
+ *   The AP_Mission_LegIndex library:
+ *   - holds mission legs (pairs of locations) and single points
+ *   - arranges their bounding boxes in a local north/east frame into a tree
+ *   - finds the nearest item to a location without visiting every item
+ *
+ *   The tree only provides lower bounds on distances. The caller
+ *   supplies the real distance to an item, so results match a linear
+ *   search using the same distance calculation
+ */
+#pragma once
+
+#include "AP_Mission_config.h"
+
+#if AP_MISSION_LEG_INDEX_ENABLED
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Common/Location.h>
+#include <AP_Common/LocalTangentPlane.h>
+#include <AP_Math/AP_Math.h>
+
+// items further than this from the first item are not supported, to
+// bound the distortion of the local frame
+#define AP_MISSION_LEG_INDEX_MAX_RADIUS_M 100000.0f
+
+// allowance for rounding when comparing lower bounds with distances
+#define AP_MISSION_LEG_INDEX_MARGIN_M 0.5f
+
+/// @class    AP_Mission_LegIndex
+/// @brief    Bounding box tree over mission legs
+class AP_Mission_LegIndex
+{
+public:
+    AP_Mission_LegIndex() {}
+    ~AP_Mission_LegIndex();
+
+    CLASS_NO_COPY(AP_Mission_LegIndex);
+
+    struct Item {
+        Vector2f min_ne;    // bounding box in the local frame
+        Vector2f max_ne;
+        uint16_t start;     // mission index of the start of the leg, equal to end for single points
+        uint16_t end;       // mission index of the end of the leg
+        uint16_t result;    // mission index reported when this item is nearest
+        uint32_t order;     // on equal distances the lowest order wins
+    };
+
+    // remove all items
+    void clear();
+
+    // add a leg from start_loc to end_loc, or a single point if the
+    // indexes are equal. Returns false if the item cannot be indexed
+    bool add(const Location &start_loc, const Location &end_loc, uint16_t start, uint16_t end, uint16_t result, uint32_t order);
+
+    // number of items added, and discarding those added after the first count
+    uint16_t num_items() const { return _num_items; }
+    void truncate(uint16_t count) { _num_items = MIN(count, _num_items); }
+
+    // build the tree over the added items, returns false if out of memory
+    bool build();
+
+    /*
+      find the item with the smallest distance to loc. distance(item)
+      must return the real distance to an item, which must be at least
+      the north/east distance to the item's locations. Returns false if
+      the tree cannot answer for this location, in which case the caller
+      must fall back to a linear search. If the index is empty result
+      is left unchanged
+     */
+    template <typename F>
+    bool nearest(const Location &loc, F distance, uint16_t &result) const;
+
+private:
+    struct Node {
+        Vector2f min_ne;
+        Vector2f max_ne;
+        uint16_t first;     // first item of a leaf
+        uint16_t count;     // number of items in a leaf, zero for inner nodes
+        uint16_t right;     // right child of an inner node, the left child follows the node
+    };
+
+    // build the subtree over count items from first, returns its node
+    uint16_t build_node(uint16_t first, uint16_t count);
+
+    // lower bound on the distance from pos to a bounding box
+    static float box_distance(const Vector2f &pos, const Vector2f &min_ne, const Vector2f &max_ne);
+
+    // scale factor below one that allows for the distortion of the
+    // local frame out to the given radius
+    float lower_bound_scale(float radius) const;
+
+    LocalTangentPlane _frame;
+    // largest distance of an item from the frame origin
+    float _radius = 0;
+
+    Item *_items = nullptr;
+    uint16_t _num_items = 0;
+    uint16_t _items_space = 0;
+
+    Node *_nodes = nullptr;
+    uint16_t _num_nodes = 0;
+    uint16_t _nodes_space = 0;
+};
+
+template <typename F>
+bool AP_Mission_LegIndex::nearest(const Location &loc, F distance, uint16_t &result) const
+{
+    if (_num_items == 0) {
+        return true;
+    }
+    if (_num_nodes == 0) {
+        return false;
+    }
+    const Vector2f pos = _frame.get_distance_NE(loc);
+    const float pos_radius = pos.length();
+    if (!(pos_radius < AP_MISSION_LEG_INDEX_MAX_RADIUS_M)) {
+        return false;
+    }
+    const float scale = lower_bound_scale(MAX(_radius, pos_radius));
+
+    bool found = false;
+    float best = 0;
+    uint32_t best_order = 0;
+
+    // depth first search, nearer children first. The tree depth is
+    // at most log2 of the number of leaves
+    uint16_t stack[32];
+    uint8_t depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const Node &node = _nodes[stack[--depth]];
+        if (found && box_distance(pos, node.min_ne, node.max_ne) * scale - AP_MISSION_LEG_INDEX_MARGIN_M > best) {
+            continue;
+        }
+        if (node.count == 0) {
+            const uint16_t left = (&node - _nodes) + 1;
+            const bool left_first = box_distance(pos, _nodes[left].min_ne, _nodes[left].max_ne) <=
+                                    box_distance(pos, _nodes[node.right].min_ne, _nodes[node.right].max_ne);
+            stack[depth++] = left_first ? node.right : left;
+            stack[depth++] = left_first ? left : node.right;
+            continue;
+        }
+        for (uint16_t i = node.first; i < node.first + node.count; i++) {
+            const Item &item = _items[i];
+            if (found && box_distance(pos, item.min_ne, item.max_ne) * scale - AP_MISSION_LEG_INDEX_MARGIN_M > best) {
+                continue;
+            }
+            const float d = distance(item);
+            if (!found || d < best || (d == best && item.order < best_order)) {
+                found = true;
+                best = d;
+                best_order = item.order;
+                result = item.result;
+            }
+        }
+    }
+    return true;
+}
+
+#endif // AP_MISSION_LEG_INDEX_ENABLED
@@ -7,3 +7,32 @@
 #ifndef AP_MISSION_NAV_PAYLOAD_PLACE_ENABLED
 #define AP_MISSION_NAV_PAYLOAD_PLACE_ENABLED 1
 #endif
+
+// keep decoded copies of mission commands in RAM, with indexes for
+// finding the commands mission searches look for
+#ifndef AP_MISSION_CACHE_ENABLED
+#define AP_MISSION_CACHE_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_500)
+#endif
+
+// RAM budget for the cache, each command takes about 52 bytes so 40k
+// holds missions of up to about 780 commands. The cache is allocated
+// to fit the loaded mission, so no RAM is used without a mission.
+// Commands beyond what fits are read from storage as before, and the
+// search index is only used while the whole mission fits
+#ifndef AP_MISSION_CACHE_MAX_BYTES
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_1000
+#define AP_MISSION_CACHE_MAX_BYTES 65536
+#else
+#define AP_MISSION_CACHE_MAX_BYTES 40960
+#endif
+#endif
+
+// the cache grows and shrinks in steps of this many commands
+#ifndef AP_MISSION_CACHE_CHUNK
+#define AP_MISSION_CACHE_CHUNK 32
+#endif
+
+// bounding box tree over return path legs and landing sequence starts
+#ifndef AP_MISSION_LEG_INDEX_ENABLED
+#define AP_MISSION_LEG_INDEX_ENABLED AP_MISSION_CACHE_ENABLED
+#endif
@@ -0,0 +1,248 @@
+#include <AP_gtest.h>
+#include <AP_Mission/AP_Mission.h>
+#include <AP_AHRS/AP_AHRS.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class DummyVehicle {
+public:
+    bool start_cmd(const AP_Mission::Mission_Command& cmd) { return true; };
+    bool verify_cmd(const AP_Mission::Mission_Command& cmd) { return true; };
+    void mission_complete() { };
+    AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+
+    AP_Mission mission{
+        FUNCTOR_BIND_MEMBER(&DummyVehicle::start_cmd, bool, const AP_Mission::Mission_Command &),
+        FUNCTOR_BIND_MEMBER(&DummyVehicle::verify_cmd, bool, const AP_Mission::Mission_Command &),
+        FUNCTOR_BIND_MEMBER(&DummyVehicle::mission_complete, void)};
+};
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+static DummyVehicle vehicle;
+
+#if AP_MISSION_CACHE_ENABLED
+
+class AP_Mission_Test {
+public:
+    static uint16_t find_cmd(uint16_t start_index, uint16_t id) {
+        return vehicle.mission.find_cmd(start_index, id);
+    }
+
+    // the same search done by decoding every command from storage
+    static uint16_t find_cmd_in_storage(uint16_t start_index, uint16_t id) {
+        for (uint16_t i = start_index; i < vehicle.mission.num_commands(); i++) {
+            AP_Mission::Mission_Command cmd;
+            vehicle.mission.decode_cmd_from_storage(i, cmd);
+            if (cmd.id == id) {
+                return i;
+            }
+        }
+        return 0;
+    }
+
+    static void decode(uint16_t index, AP_Mission::Mission_Command &cmd) {
+        vehicle.mission.decode_cmd_from_storage(index, cmd);
+    }
+
+    static uint16_t cache_size() { return vehicle.mission._cache_size; }
+    static uint16_t cache_max() { return vehicle.mission._cache_max; }
+    static void set_cache_max(uint16_t size) { vehicle.mission._cache_max = size; }
+    static bool index_available() { return vehicle.mission.update_cache_index(); }
+};
+
+static const uint16_t cmd_ids[] {
+    MAV_CMD_NAV_WAYPOINT,
+    MAV_CMD_NAV_WAYPOINT,
+    MAV_CMD_DO_CHANGE_SPEED,
+    MAV_CMD_DO_LAND_START,
+    MAV_CMD_DO_RETURN_PATH_START,
+    MAV_CMD_DO_GO_AROUND,
+    MAV_CMD_JUMP_TAG,
+};
+
+static void init_mission()
+{
+    static bool done;
+    if (!done) {
+        vehicle.mission.init();
+        done = true;
+    }
+}
+
+static AP_Mission::Mission_Command random_cmd()
+{
+    AP_Mission::Mission_Command cmd {};
+    cmd.id = cmd_ids[rand() % ARRAY_SIZE(cmd_ids)];
+    switch (cmd.id) {
+    case MAV_CMD_DO_CHANGE_SPEED:
+        cmd.content.speed.speed_type = 1;
+        cmd.content.speed.target_ms = rand() % 20;
+        break;
+    case MAV_CMD_JUMP_TAG:
+        cmd.content.jump.target = rand() % 8;
+        break;
+    default:
+        cmd.content.location.lat = -353632610 + rand() % 100000;
+        cmd.content.location.lng = 1491652300 + rand() % 100000;
+        cmd.content.location.set_alt_cm(rand() % 10000, Location::AltFrame::ABOVE_HOME);
+        break;
+    }
+    return cmd;
+}
+
+// fill the mission with count commands after home
+static void random_mission(uint16_t count)
+{
+    vehicle.mission.clear();
+    AP_Mission::Mission_Command home {};
+    home.id = MAV_CMD_NAV_WAYPOINT;
+    ASSERT_TRUE(vehicle.mission.add_cmd(home));
+    for (uint16_t i = 0; i < count; i++) {
+        AP_Mission::Mission_Command cmd = random_cmd();
+        ASSERT_TRUE(vehicle.mission.add_cmd(cmd));
+    }
+}
+
+static void check_reads_match_storage()
+{
+    for (uint16_t i = 1; i < vehicle.mission.num_commands(); i++) {
+        AP_Mission::Mission_Command cached, stored;
+        EXPECT_TRUE(vehicle.mission.read_cmd_from_storage(i, cached));
+        AP_Mission_Test::decode(i, stored);
+        EXPECT_TRUE(cached == stored) << "command " << i;
+    }
+}
+
+static void check_find_cmd()
+{
+    static const uint16_t indexed_ids[] {
+        MAV_CMD_DO_LAND_START,
+        MAV_CMD_DO_RETURN_PATH_START,
+        MAV_CMD_DO_GO_AROUND,
+        MAV_CMD_JUMP_TAG,
+        MAV_CMD_DO_CHANGE_SPEED,    // not indexed, always scans
+    };
+    for (const uint16_t id : indexed_ids) {
+        for (uint16_t start = 1; start <= vehicle.mission.num_commands(); start++) {
+            EXPECT_EQ(AP_Mission_Test::find_cmd(start, id),
+                      AP_Mission_Test::find_cmd_in_storage(start, id)) << "id " << id << " start " << start;
+        }
+    }
+}
+
+TEST(AP_Mission, CacheSize)
+{
+    init_mission();
+    // the whole mission storage area fits within the RAM budget, or
+    // the cache is capped by the budget
+    const uint16_t per_cmd = sizeof(AP_Mission::Mission_Command) + 4;
+    EXPECT_GT(AP_Mission_Test::cache_max(), 1U);
+    EXPECT_LE(AP_Mission_Test::cache_max() * per_cmd, AP_MISSION_CACHE_MAX_BYTES);
+    EXPECT_TRUE(AP_Mission_Test::cache_max() == vehicle.mission.num_commands_max() ||
+                (AP_Mission_Test::cache_max() + 1) * per_cmd > AP_MISSION_CACHE_MAX_BYTES);
+
+    // nothing is allocated without a mission
+    vehicle.mission.clear();
+    EXPECT_EQ(AP_Mission_Test::cache_size(), 0U);
+    AP_Mission_Test::index_available();
+    EXPECT_EQ(AP_Mission_Test::cache_size(), 0U);
+
+    // the cache is sized to the mission when it is searched
+    random_mission(40);
+    EXPECT_EQ(AP_Mission_Test::cache_size(), 0U);
+    EXPECT_TRUE(AP_Mission_Test::index_available());
+    EXPECT_GE(AP_Mission_Test::cache_size(), vehicle.mission.num_commands());
+    EXPECT_LT(AP_Mission_Test::cache_size(), vehicle.mission.num_commands() + AP_MISSION_CACHE_CHUNK);
+    check_reads_match_storage();
+
+    // and grows with it
+    random_mission(100);
+    EXPECT_TRUE(AP_Mission_Test::index_available());
+    EXPECT_GE(AP_Mission_Test::cache_size(), vehicle.mission.num_commands());
+    check_reads_match_storage();
+    check_find_cmd();
+
+    // clearing the mission frees the cache
+    vehicle.mission.clear();
+    EXPECT_EQ(AP_Mission_Test::cache_size(), 0U);
+}
+
+TEST(AP_Mission, CacheMatchesStorage)
+{
+    srand(1);
+    init_mission();
+    random_mission(100);
+    check_reads_match_storage();
+
+    // writes go through the cache
+    for (uint8_t i = 0; i < 20; i++) {
+        const uint16_t index = 1 + rand() % (vehicle.mission.num_commands() - 1);
+        ASSERT_TRUE(vehicle.mission.replace_cmd(index, random_cmd()));
+    }
+    check_reads_match_storage();
+}
+
+TEST(AP_Mission, FindCmd)
+{
+    srand(2);
+    init_mission();
+    for (uint8_t n = 0; n < 5; n++) {
+        random_mission(20 + 30 * n);
+        EXPECT_TRUE(AP_Mission_Test::index_available());
+        check_find_cmd();
+
+        // the index is rebuilt after the mission changes
+        const uint16_t index = 1 + rand() % (vehicle.mission.num_commands() - 1);
+        AP_Mission::Mission_Command cmd {};
+        cmd.id = MAV_CMD_DO_LAND_START;
+        ASSERT_TRUE(vehicle.mission.replace_cmd(index, cmd));
+        check_find_cmd();
+        EXPECT_EQ(AP_Mission_Test::find_cmd(index, MAV_CMD_DO_LAND_START), index);
+    }
+}
+
+TEST(AP_Mission, FindCmdBeyondCache)
+{
+    srand(3);
+    init_mission();
+    random_mission(60);
+    const uint16_t cache_max = AP_Mission_Test::cache_max();
+
+    // a mission longer than the cache is searched in storage
+    AP_Mission_Test::set_cache_max(30);
+    EXPECT_FALSE(AP_Mission_Test::index_available());
+    EXPECT_EQ(AP_Mission_Test::cache_size(), 30U);
+    check_find_cmd();
+    check_reads_match_storage();
+
+    AP_Mission_Test::set_cache_max(cache_max);
+    EXPECT_TRUE(AP_Mission_Test::index_available());
+    check_find_cmd();
+}
+
+TEST(AP_Mission, NextNavCmd)
+{
+    srand(4);
+    init_mission();
+    random_mission(80);
+    for (uint16_t start = 1; start < vehicle.mission.num_commands(); start++) {
+        AP_Mission::Mission_Command cmd;
+        const uint16_t expected = AP_Mission_Test::find_cmd_in_storage(start, MAV_CMD_NAV_WAYPOINT);
+        if (expected == 0) {
+            EXPECT_FALSE(vehicle.mission.get_next_nav_cmd(start, cmd));
+            continue;
+        }
+        ASSERT_TRUE(vehicle.mission.get_next_nav_cmd(start, cmd));
+        EXPECT_EQ(cmd.index, expected);
+    }
+}
+
+#endif // AP_MISSION_CACHE_ENABLED
+
+AP_GTEST_PANIC()
+AP_GTEST_MAIN()
@@ -0,0 +1,227 @@
+#include <AP_gtest.h>
+#include <AP_Mission/AP_Mission.h>
+#include <AP_AHRS/AP_AHRS.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+class DummyVehicle {
+public:
+    bool start_cmd(const AP_Mission::Mission_Command& cmd) { return true; };
+    bool verify_cmd(const AP_Mission::Mission_Command& cmd) { return true; };
+    void mission_complete() { };
+    AP_AHRS ahrs{AP_AHRS::FLAG_ALWAYS_USE_EKF};
+
+    AP_Mission mission{
+        FUNCTOR_BIND_MEMBER(&DummyVehicle::start_cmd, bool, const AP_Mission::Mission_Command &),
+        FUNCTOR_BIND_MEMBER(&DummyVehicle::verify_cmd, bool, const AP_Mission::Mission_Command &),
+        FUNCTOR_BIND_MEMBER(&DummyVehicle::mission_complete, void)};
+};
+
+const struct AP_Param::GroupInfo        GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+static DummyVehicle vehicle;
+
+#if AP_MISSION_LEG_INDEX_ENABLED
+
+/*
+  locations on a coarse grid of roughly 10m spacing, so that many
+  items are at exactly the same distance from a query location
+ */
+static Location grid_location(int16_t north, int16_t east)
+{
+    Location loc;
+    loc.lat = -353632610 + north * 900;
+    loc.lng = 1491652300 + east * 1100;
+    loc.set_alt_cm(10000, Location::AltFrame::ABOVE_HOME);
+    return loc;
+}
+
+static Location random_location(int16_t extent)
+{
+    return grid_location(rand() % (2*extent+1) - extent, rand() % (2*extent+1) - extent);
+}
+
+// distance from p to the leg from a to b in the north/east plane
+static float leg_distance(const Location &a, const Location &b, const Location &p)
+{
+    const Vector2f ab = a.get_distance_NE(b);
+    const Vector2f ap = a.get_distance_NE(p);
+    return (Vector2f::closest_point(ap, Vector2f(), ab) - ap).length();
+}
+
+struct TestItem {
+    uint16_t start;
+    uint16_t end;
+    uint16_t result;
+    uint32_t order;
+};
+
+// linear search with the same tie break as the tree
+static uint16_t brute_force_nearest(const TestItem *items, uint16_t count, const Location *locs, const Location &loc)
+{
+    uint16_t result = UINT16_MAX;
+    float best = 0;
+    uint32_t best_order = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        const float d = leg_distance(locs[items[i].start], locs[items[i].end], loc);
+        if (result == UINT16_MAX || d < best || (d == best && items[i].order < best_order)) {
+            best = d;
+            best_order = items[i].order;
+            result = items[i].result;
+        }
+    }
+    return result;
+}
+
+TEST(AP_Mission_LegIndex, NearestMatchesBruteForce)
+{
+    srand(1);
+    AP_Mission_LegIndex index;
+    Location locs[400];
+    TestItem items[200];
+
+    for (uint8_t mission = 0; mission < 50; mission++) {
+        // small extents give many ties, large ones a deep tree
+        const int16_t extent = (mission % 2) ? 5 : 200;
+        const uint16_t num_locs = 1 + rand() % ARRAY_SIZE(locs);
+        for (uint16_t i = 0; i < num_locs; i++) {
+            locs[i] = random_location(extent);
+        }
+        const uint16_t num_items = 1 + rand() % ARRAY_SIZE(items);
+        index.clear();
+        for (uint16_t i = 0; i < num_items; i++) {
+            TestItem &item = items[i];
+            item.start = rand() % num_locs;
+            // a third of the items are single points
+            item.end = (rand() % 3 == 0) ? item.start : rand() % num_locs;
+            item.result = i;
+            item.order = i;
+        }
+        // unique orders in a different sequence to the items
+        for (uint16_t i = num_items-1; i > 0; i--) {
+            const uint16_t j = rand() % (i+1);
+            const uint32_t tmp = items[i].order;
+            items[i].order = items[j].order;
+            items[j].order = tmp;
+        }
+        for (uint16_t i = 0; i < num_items; i++) {
+            const TestItem &item = items[i];
+            ASSERT_TRUE(index.add(locs[item.start], locs[item.end], item.start, item.end, item.result, item.order));
+        }
+        ASSERT_TRUE(index.build());
+        EXPECT_EQ(index.num_items(), num_items);
+
+        for (uint8_t q = 0; q < 50; q++) {
+            // query from the grid, including far outside the items
+            const Location loc = random_location(q < 40 ? extent : 4 * extent);
+            auto distance = [&locs, &loc](const AP_Mission_LegIndex::Item &item) -> float {
+                return leg_distance(locs[item.start], locs[item.end], loc);
+            };
+            uint16_t result = UINT16_MAX;
+            ASSERT_TRUE(index.nearest(loc, distance, result));
+            EXPECT_EQ(result, brute_force_nearest(items, num_items, locs, loc)) << "mission " << unsigned(mission) << " query " << unsigned(q);
+        }
+    }
+}
+
+TEST(AP_Mission_LegIndex, EmptyAndOutOfRange)
+{
+    AP_Mission_LegIndex index;
+    ASSERT_TRUE(index.build());
+    uint16_t result = 7;
+    auto distance = [](const AP_Mission_LegIndex::Item &) -> float { return 0; };
+    EXPECT_TRUE(index.nearest(grid_location(0, 0), distance, result));
+    EXPECT_EQ(result, 7);
+
+    ASSERT_TRUE(index.add(grid_location(0, 0), grid_location(1, 1), 0, 1, 1, 0));
+    ASSERT_TRUE(index.build());
+    // beyond the supported radius the caller must fall back to a linear search
+    Location far = grid_location(0, 0);
+    far.offset(AP_MISSION_LEG_INDEX_MAX_RADIUS_M * 2, 0);
+    EXPECT_FALSE(index.nearest(far, distance, result));
+}
+
+class AP_Mission_Test {
+public:
+    static bool landing_sequence_start_from_index(const Location &loc, uint16_t &index) {
+        return vehicle.mission.landing_sequence_start_from_index(loc, index);
+    }
+};
+
+static void add_cmd(uint16_t id, const Location &loc)
+{
+    AP_Mission::Mission_Command cmd {};
+    cmd.id = id;
+    cmd.content.location = loc;
+    ASSERT_TRUE(vehicle.mission.add_cmd(cmd));
+}
+
+/*
+  the DO_LAND_START nearest to loc as get_landing_sequence_start()
+  finds it without the index: a start without a location uses the
+  next nav command, and the earliest start wins on equal distances
+ */
+static uint16_t brute_force_landing_start(const Location &loc)
+{
+    uint16_t result = 0;
+    float best = -1;
+    for (uint16_t i = 1; i < vehicle.mission.num_commands(); i++) {
+        AP_Mission::Mission_Command cmd;
+        if (!vehicle.mission.read_cmd_from_storage(i, cmd) || cmd.id != MAV_CMD_DO_LAND_START) {
+            continue;
+        }
+        if (!cmd.content.location.initialised() && !vehicle.mission.get_next_nav_cmd(i, cmd)) {
+            continue;
+        }
+        const float d = cmd.content.location.get_distance_NED_alt_frame(loc).length();
+        if (best < 0 || d < best) {
+            best = d;
+            result = i;
+        }
+    }
+    return result;
+}
+
+TEST(AP_Mission_LegIndex, LandingSequenceStart)
+{
+    srand(2);
+    vehicle.mission.init();
+    for (uint8_t mission = 0; mission < 20; mission++) {
+        const int16_t extent = (mission % 2) ? 3 : 100;
+        vehicle.mission.clear();
+        add_cmd(MAV_CMD_NAV_WAYPOINT, grid_location(0, 0));
+        const uint8_t num_cmds = 10 + rand() % 80;
+        for (uint8_t i = 0; i < num_cmds; i++) {
+            switch (rand() % 4) {
+            case 0:
+                add_cmd(MAV_CMD_DO_LAND_START, random_location(extent));
+                break;
+            case 1:
+                // a start without a location is measured at the next waypoint
+                add_cmd(MAV_CMD_DO_LAND_START, Location());
+                break;
+            default:
+                add_cmd(MAV_CMD_NAV_WAYPOINT, random_location(extent));
+                break;
+            }
+        }
+        add_cmd(MAV_CMD_NAV_LAND, random_location(extent));
+
+        for (uint8_t q = 0; q < 30; q++) {
+            const Location loc = random_location(2 * extent);
+            uint16_t index = UINT16_MAX;
+            ASSERT_TRUE(AP_Mission_Test::landing_sequence_start_from_index(loc, index));
+            EXPECT_EQ(index, brute_force_landing_start(loc)) << "mission " << unsigned(mission) << " query " << unsigned(q);
+            EXPECT_EQ(vehicle.mission.get_landing_sequence_start(loc), index);
+        }
+    }
+}
+
+#endif // AP_MISSION_LEG_INDEX_ENABLED
+
+AP_GTEST_PANIC()
+AP_GTEST_MAIN()
@@ -10,6 +10,7 @@
 #include "AP_Networking_Backend.h"
 #include <AP_SerialManager/AP_SerialManager.h>
 #include <AP_HAL/utility/RingBuffer.h>
+#include <atomic>
 
 /*
   Note! all uint32_t IPv4 addresses are in host byte order
@@ -20,6 +21,7 @@ class AP_Networking_Backend;
 class AP_Networking_ChibiOS;
 
 class SocketAPM;
+class ExpandingString;
 
 class AP_Networking
 {
@@ -228,21 +230,41 @@ private:
             return false;
         }
 
-        void udp_client_init(void);
-        void udp_server_init(void);
-        void tcp_server_init(void);
-        void tcp_client_init(void);
+        bool udp_client_init(void);
+        bool udp_server_init(void);
+        bool tcp_server_init(void);
+        bool tcp_client_init(void);
 
-        void udp_client_loop(void);
-        void udp_server_loop(void);
+        // connection setup run by the port reactor, returns false if
+        // the port cannot be used
+        bool udp_client_start(void);
+        bool udp_server_start(void);
+        bool tcp_server_start(void);
+
+        // thread making TCP client connections
         void tcp_client_loop(void);
-        void tcp_server_loop(void);
 
-        bool send_receive(void);
+        // accept a pending connection on a TCP server
+        void tcp_server_accept(void);
+
+        // read from the socket into the read buffer. Returns true if
+        // data was read
+        bool receive(void);
+
+        // write from the write buffer to the socket. Returns true if
+        // data remains to be sent once the socket is writeable
+        bool send(void);
+
+        // socket the reactor should service, nullptr if there is none
+        SocketAPM *active_socket(void);
+
+        // add a line of statistics for @SYS/net_ports.txt
+        void port_info(ExpandingString &str, uint32_t dt_ms);
 
     private:
+        friend class AP_Networking;
+
         bool init_buffers(const uint32_t size_rx, const uint32_t size_tx);
-        void thread_create(AP_HAL::MemberProc);
 
         uint32_t txspace() override;
         void _begin(uint32_t b, uint16_t rxS, uint16_t txS) override;
@@ -272,7 +294,30 @@ private:
         bool close_on_recv_error;
         uint32_t last_udp_srv_recv_time_ms;
         HAL_Semaphore sem;
+
+        // reactor state
+        bool started;       // setup by the reactor has completed
+        bool tx_wake;       // data written since the reactor last looked
+        bool rx_blocked;    // reading stopped because the read buffer was full
+        uint32_t tx_queued_us;  // time data was written to an empty write buffer
+
+        // statistics, only updated or read with sem held
+        struct {
+            uint32_t tx_bytes;
+            uint32_t rx_bytes;
+            uint32_t wakeups;
+            uint32_t tx_latency_sum_us;
+            uint32_t tx_latency_count;
+            uint32_t tx_latency_max_us;
+        } stats, last_stats;
     };
+
+public:
+    // wake the port reactor, for instance because a port has data to send
+    void ports_wakeup(void);
+
+    // write statistics for each port for @SYS/net_ports.txt
+    void ports_info(ExpandingString &str);
 #endif // AP_NETWORKING_REGISTER_PORT_ENABLED
 
 private:
@@ -295,6 +340,23 @@ private:
 #if AP_NETWORKING_REGISTER_PORT_ENABLED
     // ports for registration with serial manager
     Port ports[AP_NETWORKING_NUM_PORTS];
+
+    /*
+      a single reactor thread services all ports, sleeping until a
+      socket is ready or a port has data to send
+     */
+    void ports_thread(void);
+    bool ports_wake_init(void);
+    void ports_wake_drain(void);
+    std::atomic<bool> ports_wake_requested;
+#if AP_NETWORKING_NEED_LWIP
+    // loopback UDP socket used to wake lwip_select()
+    SocketAPM *ports_wake_sock;
+#else
+    // pipe used to wake select()
+    int ports_wake_fd[2] {-1, -1};
+#endif
+    uint32_t ports_info_ms;
 #endif
 
     // support for sendfile()
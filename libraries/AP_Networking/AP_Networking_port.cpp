@@ -28,6 +28,10 @@ extern const AP_HAL::HAL& hal;
 #define AP_NETWORKING_PORT_STACK_SIZE 1024
 #endif
 
+#ifndef AP_NETWORKING_PORT_REACTOR_STACK_SIZE
+#define AP_NETWORKING_PORT_REACTOR_STACK_SIZE 2048
+#endif
+
 const AP_Param::GroupInfo AP_Networking::Port::var_info[] = {
     // @Param: TYPE
     // @DisplayName: Port type
@@ -66,58 +70,56 @@ const AP_Param::GroupInfo AP_Networking::Port::var_info[] = {
  */
 void AP_Networking::ports_init(void)
 {
+    bool have_ports = false;
     for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
         auto &p = ports[i];
         NetworkPortType ptype = (NetworkPortType)p.type;
         p.state.idx = AP_SERIALMANAGER_NET_PORT_1 + i;
+        if (ptype == NetworkPortType::NONE) {
+            continue;
+        }
+        if (!p.init_buffers(AP_NETWORKING_PORT_MIN_RXSIZE, AP_NETWORKING_PORT_MIN_TXSIZE)) {
+            AP_BoardConfig::allocation_error("Failed to allocate NET_P%u buffers", unsigned(i));
+            continue;
+        }
+        bool ok = false;
         switch (ptype) {
         case NetworkPortType::NONE:
             break;
         case NetworkPortType::UDP_CLIENT:
-            p.udp_client_init();
+            ok = p.udp_client_init();
             break;
         case NetworkPortType::UDP_SERVER:
-            p.udp_server_init();
+            ok = p.udp_server_init();
             break;
         case NetworkPortType::TCP_SERVER:
-            p.tcp_server_init();
+            ok = p.tcp_server_init();
             break;
         case NetworkPortType::TCP_CLIENT:
-            p.tcp_client_init();
+            ok = p.tcp_client_init();
             break;
         }
-        if (p.sock != nullptr || p.listen_sock != nullptr) {
+        if (ok) {
             AP::serialmanager().register_port(&p);
+            have_ports = true;
         }
     }
-}
-
-/*
-  wrapper for thread_create for port functions
- */
-void AP_Networking::Port::thread_create(AP_HAL::MemberProc proc)
-{
-    const uint8_t idx = state.idx - AP_SERIALMANAGER_NET_PORT_1;
-    hal.util->snprintf(thread_name, sizeof(thread_name), "NET_P%u", unsigned(idx));
-
-    if (!init_buffers(AP_NETWORKING_PORT_MIN_RXSIZE, AP_NETWORKING_PORT_MIN_TXSIZE)) {
-        AP_BoardConfig::allocation_error("Failed to allocate %s buffers", thread_name);
-        return;
-    }
 
-    if (!hal.scheduler->thread_create(proc, thread_name, AP_NETWORKING_PORT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
-        AP_BoardConfig::allocation_error("Failed to allocate %s client thread", thread_name);
+    if (have_ports &&
+        !hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::ports_thread, void),
+                                      "NET_PORTS", AP_NETWORKING_PORT_REACTOR_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+        AP_BoardConfig::allocation_error("Failed to allocate NET_PORTS thread");
     }
 }
 
 /*
   initialise a UDP client
  */
-void AP_Networking::Port::udp_client_init(void)
+bool AP_Networking::Port::udp_client_init(void)
 {
     sock = NEW_NOTHROW SocketAPM(true);
     if (sock == nullptr) {
-        return;
+        return false;
     }
     sock->set_blocking(false);
 
@@ -125,17 +127,17 @@ void AP_Networking::Port::udp_client_init(void)
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
 
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_client_loop, void));
+    return true;
 }
 
 /*
   initialise a UDP server
  */
-void AP_Networking::Port::udp_server_init(void)
+bool AP_Networking::Port::udp_server_init(void)
 {
     sock = NEW_NOTHROW SocketAPM(true);
     if (sock == nullptr) {
-        return;
+        return false;
     }
     sock->set_blocking(false);
 
@@ -143,136 +145,118 @@ void AP_Networking::Port::udp_server_init(void)
     packetise = (state.protocol == AP_SerialManager::SerialProtocol_MAVLink ||
                  state.protocol == AP_SerialManager::SerialProtocol_MAVLink2);
 
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::udp_server_loop, void));
+    return true;
 }
 
 /*
   initialise a TCP server
  */
-void AP_Networking::Port::tcp_server_init(void)
+bool AP_Networking::Port::tcp_server_init(void)
 {
     listen_sock = NEW_NOTHROW SocketAPM(false);
     if (listen_sock == nullptr) {
-        return;
+        return false;
     }
     listen_sock->reuseaddress();
+    listen_sock->set_blocking(false);
 
-    thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::tcp_server_loop, void));
+    return true;
 }
 
 /*
-  initialise a TCP client
+  initialise a TCP client. Connecting blocks, so it is done by a
+  thread for this port and the connection is then handed to the
+  reactor
  */
-void AP_Networking::Port::tcp_client_init(void)
+bool AP_Networking::Port::tcp_client_init(void)
 {
-    sock = NEW_NOTHROW SocketAPM(false);
-    if (sock != nullptr) {
-        sock->set_blocking(true);
-        thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::tcp_client_loop, void));
+    const uint8_t idx = state.idx - AP_SERIALMANAGER_NET_PORT_1;
+    hal.util->snprintf(thread_name, sizeof(thread_name), "NET_P%u", unsigned(idx));
+
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_Networking::Port::tcp_client_loop, void), thread_name, AP_NETWORKING_PORT_STACK_SIZE, AP_HAL::Scheduler::PRIORITY_UART, 0)) {
+        AP_BoardConfig::allocation_error("Failed to allocate %s client thread", thread_name);
+        return false;
     }
+    return true;
 }
 
 /*
-  update a UDP client
+  start a UDP client
  */
-void AP_Networking::Port::udp_client_loop(void)
+bool AP_Networking::Port::udp_client_start(void)
 {
-    AP::network().startup_wait();
-
     const char *dest = ip.get_str();
     if (!sock->connect(dest, port.get())) {
         GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to connect to %s", (unsigned)state.idx, dest);
-        delete sock;
-        sock = nullptr;
-        return;
+        return false;
     }
 
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: connected to %s:%u", (unsigned)state.idx, dest, unsigned(port.get()));
 
     connected = true;
-
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
-        }
-        active = send_receive();
-    }
+    return true;
 }
 
 /*
-  update a UDP server
+  start a UDP server
  */
-void AP_Networking::Port::udp_server_loop(void)
+bool AP_Networking::Port::udp_server_start(void)
 {
-    AP::network().startup_wait();
-
     const char *addr = ip.get_str();
     if (!sock->bind(addr, port.get())) {
         GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "UDP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-        delete sock;
-        sock = nullptr;
-        return;
+        return false;
     }
     sock->reuseaddress();
 
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "UDP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
-        }
-        active = send_receive();
-    }
+    return true;
 }
 
 /*
-  update a TCP server
+  start a TCP server
  */
-void AP_Networking::Port::tcp_server_loop(void)
+bool AP_Networking::Port::tcp_server_start(void)
 {
-    AP::network().startup_wait();
-
     const char *addr = ip.get_str();
     if (!listen_sock->bind(addr, port.get()) || !listen_sock->listen(1)) {
         GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "TCP[%u]: Failed to bind to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
-        delete listen_sock;
-        listen_sock = nullptr;
-        return;
+        return false;
     }
 
     GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: bound to %s:%u", (unsigned)state.idx, addr, unsigned(port.get()));
 
     close_on_recv_error = true;
+    return true;
+}
 
-    bool active = false;
-    while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
-        }
-        if (sock == nullptr) {
-            sock = listen_sock->accept(100);
-            if (sock != nullptr) {
-                sock->set_blocking(false);
-                char buf[IP4_STR_LEN];
-                uint16_t last_port;
-                const char *last_addr = listen_sock->last_recv_address(buf, sizeof(buf), last_port);
-                if (last_addr != nullptr) {
-                    GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connection from %s:%u", (unsigned)state.idx, last_addr, unsigned(last_port));
-                }
-                connected = true;
-                sock->reuseaddress();
-            }
-        }
-        if (sock != nullptr) {
-            active = send_receive();
-        }
+/*
+  accept a connection on a TCP server, called by the reactor when the
+  listening socket is readable
+ */
+void AP_Networking::Port::tcp_server_accept(void)
+{
+    SocketAPM *new_sock = listen_sock->accept(0);
+    if (new_sock == nullptr) {
+        return;
     }
+    new_sock->set_blocking(false);
+    char buf[IP4_STR_LEN];
+    uint16_t last_port;
+    const char *last_addr = listen_sock->last_recv_address(buf, sizeof(buf), last_port);
+    if (last_addr != nullptr) {
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connection from %s:%u", (unsigned)state.idx, last_addr, unsigned(last_port));
+    }
+    new_sock->reuseaddress();
+
+    WITH_SEMAPHORE(sem);
+    sock = new_sock;
+    connected = true;
 }
 
 /*
-  update a TCP client
+  make TCP client connections. Once connected the reactor services
+  the socket until it closes, when this thread connects again
  */
 void AP_Networking::Port::tcp_client_loop(void)
 {
@@ -280,52 +264,64 @@ void AP_Networking::Port::tcp_client_loop(void)
 
     close_on_recv_error = true;
 
-    bool active = false;
     while (true) {
-        if (!active) {
-            hal.scheduler->delay_microseconds(100);
+        if (active_socket() != nullptr) {
+            hal.scheduler->delay(100);
+            continue;
         }
-        if (sock == nullptr) {
-            sock = NEW_NOTHROW SocketAPM(false);
-            if (sock == nullptr) {
-                continue;
-            }
-            sock->set_blocking(true);
-            connected = false;
+        SocketAPM *new_sock = NEW_NOTHROW SocketAPM(false);
+        if (new_sock == nullptr) {
+            hal.scheduler->delay(100);
+            continue;
         }
-        if (!connected) {
-            const char *dest = ip.get_str();
-            connected = sock->connect(dest, port.get());
-            if (connected) {
-                GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connected to %s:%u", unsigned(state.idx), dest, unsigned(port.get()));
-                sock->set_blocking(false);
-            } else {
-                delete sock;
-                sock = nullptr;
-                // don't try and connect too fast
-                hal.scheduler->delay(100);
-            }
+        new_sock->set_blocking(true);
+        const char *dest = ip.get_str();
+        if (!new_sock->connect(dest, port.get())) {
+            delete new_sock;
+            // don't try and connect too fast
+            hal.scheduler->delay(100);
+            continue;
         }
-        if (sock != nullptr && connected) {
-            active = send_receive();
+        GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: connected to %s:%u", unsigned(state.idx), dest, unsigned(port.get()));
+        new_sock->set_blocking(false);
+        {
+            WITH_SEMAPHORE(sem);
+            sock = new_sock;
+            connected = true;
+            started = true;
         }
+        AP::network().ports_wakeup();
     }
 }
 
 /*
-  run one send/receive loop
+  socket the reactor should service
  */
-bool AP_Networking::Port::send_receive(void)
+SocketAPM *AP_Networking::Port::active_socket(void)
 {
+    WITH_SEMAPHORE(sem);
+    if (!started || sock == nullptr) {
+        return nullptr;
+    }
+    const NetworkPortType ptype = (NetworkPortType)type;
+    if ((ptype == NetworkPortType::TCP_CLIENT || ptype == NetworkPortType::TCP_SERVER) && !connected) {
+        return nullptr;
+    }
+    return sock;
+}
 
+/*
+  handle incoming data
+ */
+bool AP_Networking::Port::receive(void)
+{
     bool active = false;
     uint32_t space;
 
-
-    // handle incoming packets
     {
         WITH_SEMAPHORE(sem);
         space = readbuffer->space();
+        rx_blocked = (space == 0);
     }
     if (space > 0) {
         const uint32_t n = MIN(300U, space);
@@ -333,8 +329,10 @@ bool AP_Networking::Port::send_receive(void)
         const auto ret = sock->recv(buf, n, 0);
         if (close_on_recv_error && ret == 0) {
             GCS_SEND_TEXT(MAV_SEVERITY_INFO, "TCP[%u]: closed connection", unsigned(state.idx));
+            WITH_SEMAPHORE(sem);
             delete sock;
             sock = nullptr;
+            connected = false;
             return false;
         }
         if (ret > 0) {
@@ -342,6 +340,7 @@ bool AP_Networking::Port::send_receive(void)
             readbuffer->write(buf, ret);
             active = true;
             have_received = true;
+            stats.rx_bytes += ret;
         }
     }
 
@@ -369,54 +368,106 @@ bool AP_Networking::Port::send_receive(void)
         }
     }
 
-    if (connected) {
-        // handle outgoing packets
-        uint32_t available;
+    return active;
+}
 
-        {
-            WITH_SEMAPHORE(sem);
-            available = writebuffer->available();
-            available = MIN(300U, available);
+/*
+  handle outgoing data
+ */
+bool AP_Networking::Port::send(void)
+{
+    {
+        WITH_SEMAPHORE(sem);
+        tx_wake = false;
+    }
+    if (!connected) {
+        return false;
+    }
+
+    uint32_t available;
+    {
+        WITH_SEMAPHORE(sem);
+        available = writebuffer->available();
+        available = MIN(300U, available);
 #if AP_MAVLINK_PACKETISE_ENABLED
-            if (packetise) {
-                available = mavlink_packetise(*writebuffer, available);
-            }
-#endif
-            if (available == 0) {
-                return active;
-            }
+        if (packetise) {
+            available = mavlink_packetise(*writebuffer, available);
         }
-        uint8_t buf[available];
-        uint32_t n;
-        {
-            WITH_SEMAPHORE(sem);
-            n = writebuffer->peekbytes(buf, available);
+#endif
+        if (available == 0) {
+            // nothing complete to send, wait for the next write
+            return false;
         }
+    }
+    uint8_t buf[available];
+    uint32_t n;
+    {
+        WITH_SEMAPHORE(sem);
+        n = writebuffer->peekbytes(buf, available);
+    }
 
-        // nothing to send return
-        if (n <= 0) {
-            return active;
-        }
+    // nothing to send return
+    if (n <= 0) {
+        return false;
+    }
 
-        ssize_t ret = -1;
-        if (type == NetworkPortType::UDP_SERVER) {
-            // UDP Server uses sendto, allowing us to change the destination address port on the fly
-            if(last_udp_connect_address != 0 && last_udp_connect_port != 0) {
-                ret = sock->sendto(buf, n, last_udp_connect_address, last_udp_connect_port);
-            }
-        } else {
-            // TCP Server and Client and UDP Client use send
-            ret = sock->send(buf, n);
+    ssize_t ret = -1;
+    if (type == NetworkPortType::UDP_SERVER) {
+        // UDP Server uses sendto, allowing us to change the destination address port on the fly
+        if (last_udp_connect_address == 0 || last_udp_connect_port == 0) {
+            // no destination yet, wait for the next write
+            return false;
         }
+        ret = sock->sendto(buf, n, last_udp_connect_address, last_udp_connect_port);
+    } else {
+        // TCP Server and Client and UDP Client use send
+        ret = sock->send(buf, n);
+    }
 
-        if (ret > 0) {
-            WITH_SEMAPHORE(sem);
-            writebuffer->advance(ret);
-            active = true;
-        }
+    if (ret <= 0) {
+        // wait for the socket to be writeable
+        return true;
     }
 
-    return active;
+    WITH_SEMAPHORE(sem);
+    writebuffer->advance(ret);
+    stats.tx_bytes += ret;
+    if (tx_queued_us != 0) {
+        const uint32_t now_us = AP_HAL::micros();
+        const uint32_t latency_us = now_us - tx_queued_us;
+        stats.tx_latency_sum_us += latency_us;
+        stats.tx_latency_count++;
+        stats.tx_latency_max_us = MAX(stats.tx_latency_max_us, latency_us);
+        // the latency of any remaining data is counted from now
+        tx_queued_us = writebuffer->available() > 0 ? now_us : 0;
+    }
+    return writebuffer->available() > 0;
+}
+
+/*
+  add a line of statistics for this port
+ */
+void AP_Networking::Port::port_info(ExpandingString &str, uint32_t dt_ms)
+{
+    WITH_SEMAPHORE(sem);
+    const uint32_t tx_bytes = stats.tx_bytes - last_stats.tx_bytes;
+    const uint32_t rx_bytes = stats.rx_bytes - last_stats.rx_bytes;
+    const uint32_t wakeups = stats.wakeups - last_stats.wakeups;
+    const uint32_t latency_count = stats.tx_latency_count - last_stats.tx_latency_count;
+    const uint32_t latency_sum_us = stats.tx_latency_sum_us - last_stats.tx_latency_sum_us;
+    dt_ms = MAX(dt_ms, 1U);
+    str.printf("NET_P%u TX=%8u RX=%8u TXBD=%6u RXBD=%6u WAKE/s=%5u TXLAT=%5uus TXLATMAX=%6uus\n",
+               unsigned(state.idx - AP_SERIALMANAGER_NET_PORT_1),
+               unsigned(tx_bytes),
+               unsigned(rx_bytes),
+               unsigned((tx_bytes * 1000ULL) / dt_ms),
+               unsigned((rx_bytes * 1000ULL) / dt_ms),
+               unsigned((wakeups * 1000ULL) / dt_ms),
+               unsigned(latency_count > 0 ? latency_sum_us / latency_count : 0),
+               unsigned(stats.tx_latency_max_us));
+    // the maximum is over each reporting interval
+    stats.tx_latency_max_us = 0;
+    last_stats = stats;
 }
 
 /*
@@ -437,14 +488,42 @@ void AP_Networking::Port::_begin(uint32_t b, uint16_t rxS, uint16_t txS)
 
 size_t AP_Networking::Port::_write(const uint8_t *buffer, size_t size)
 {
-    WITH_SEMAPHORE(sem);
-    return writebuffer->write(buffer, size);
+    bool wake = false;
+    size_t ret;
+    {
+        WITH_SEMAPHORE(sem);
+        if (writebuffer->available() == 0) {
+            tx_queued_us = AP_HAL::micros();
+        }
+        ret = writebuffer->write(buffer, size);
+        if (ret > 0 && !tx_wake) {
+            tx_wake = true;
+            wake = true;
+        }
+    }
+    if (wake) {
+        AP::network().ports_wakeup();
+    }
+    return ret;
 }
 
 ssize_t AP_Networking::Port::_read(uint8_t *buffer, uint16_t count)
 {
-    WITH_SEMAPHORE(sem);
-    return readbuffer->read(buffer, count);
+    bool wake = false;
+    ssize_t ret;
+    {
+        WITH_SEMAPHORE(sem);
+        ret = readbuffer->read(buffer, count);
+        if (rx_blocked && ret > 0) {
+            // the reactor stopped reading while the buffer was full
+            rx_blocked = false;
+            wake = true;
+        }
+    }
+    if (wake) {
+        AP::network().ports_wakeup();
+    }
+    return ret;
 }
 
 uint32_t AP_Networking::Port::_available()
@@ -0,0 +1,292 @@
+/*
+  reactor thread servicing all mapped network ports
+ */
+
+#include "AP_Networking_Config.h"
+
+#if AP_NETWORKING_REGISTER_PORT_ENABLED
+
+#include "AP_Networking.h"
+#include <AP_HAL/utility/Socket.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS.h>
+
+#if AP_NETWORKING_NEED_LWIP
+#include <lwip/sockets.h>
+#define CALL_PREFIX(x) ::lwip_##x
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/select.h>
+#define CALL_PREFIX(x) ::x
+#endif
+
+#include <errno.h>
+
+extern const AP_HAL::HAL& hal;
+
+// longest wait for socket events. Pending data that could not be sent
+// is retried at this interval
+#ifndef AP_NETWORKING_PORT_REACTOR_TIMEOUT_MS
+#define AP_NETWORKING_PORT_REACTOR_TIMEOUT_MS 100
+#endif
+
+#if AP_NETWORKING_NEED_LWIP
+// loopback UDP port used to wake the reactor
+#ifndef AP_NETWORKING_PORT_WAKE_PORT
+#define AP_NETWORKING_PORT_WAKE_PORT 5790
+#endif
+#endif
+
+/*
+  setup the mechanism for waking the reactor from other threads
+ */
+bool AP_Networking::ports_wake_init(void)
+{
+#if AP_NETWORKING_NEED_LWIP
+    // a UDP socket connected to itself on the loopback interface
+    ports_wake_sock = NEW_NOTHROW SocketAPM(true);
+    if (ports_wake_sock == nullptr) {
+        return false;
+    }
+    if (!ports_wake_sock->bind("127.0.0.1", AP_NETWORKING_PORT_WAKE_PORT) ||
+        !ports_wake_sock->connect("127.0.0.1", AP_NETWORKING_PORT_WAKE_PORT)) {
+        delete ports_wake_sock;
+        ports_wake_sock = nullptr;
+        return false;
+    }
+    ports_wake_sock->set_blocking(false);
+    return true;
+#else
+    if (pipe(ports_wake_fd) != 0) {
+        ports_wake_fd[0] = ports_wake_fd[1] = -1;
+        return false;
+    }
+    for (uint8_t i=0; i<2; i++) {
+        fcntl(ports_wake_fd[i], F_SETFL, fcntl(ports_wake_fd[i], F_GETFL, 0) | O_NONBLOCK);
+#ifdef FD_CLOEXEC
+        fcntl(ports_wake_fd[i], F_SETFD, FD_CLOEXEC);
+#endif
+    }
+    return true;
+#endif
+}
+
+/*
+  wake the reactor. Only the first request after the reactor last
+  woke writes to the wake socket
+ */
+void AP_Networking::ports_wakeup(void)
+{
+    if (ports_wake_requested.exchange(true)) {
+        return;
+    }
+    const uint8_t b = 0;
+#if AP_NETWORKING_NEED_LWIP
+    if (ports_wake_sock != nullptr) {
+        ports_wake_sock->send(&b, 1);
+    }
+#else
+    if (ports_wake_fd[1] != -1) {
+        IGNORE_RETURN(write(ports_wake_fd[1], &b, 1));
+    }
+#endif
+}
+
+/*
+  empty the wake socket
+ */
+void AP_Networking::ports_wake_drain(void)
+{
+    uint8_t buf[16];
+#if AP_NETWORKING_NEED_LWIP
+    if (ports_wake_sock != nullptr) {
+        while (ports_wake_sock->recv(buf, sizeof(buf), 0) > 0) {}
+    }
+#else
+    if (ports_wake_fd[0] != -1) {
+        while (read(ports_wake_fd[0], buf, sizeof(buf)) > 0) {}
+    }
+#endif
+}
+
+/*
+  service all ports. Each port socket is watched for input, and for
+  output while it has data the socket would not take. Data written to
+  a port wakes the reactor so it is sent without polling
+ */
+void AP_Networking::ports_thread(void)
+{
+    startup_wait();
+
+    if (!ports_wake_init()) {
+        // ports are still serviced, with data written to them sent
+        // at the reactor timeout
+        GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "NET: failed to setup port wakeup");
+    }
+
+    for (auto &p : ports) {
+        const NetworkPortType ptype = (NetworkPortType)p.type;
+        bool ok = false;
+        switch (ptype) {
+        case NetworkPortType::UDP_CLIENT:
+            ok = p.sock != nullptr && p.udp_client_start();
+            break;
+        case NetworkPortType::UDP_SERVER:
+            ok = p.sock != nullptr && p.udp_server_start();
+            break;
+        case NetworkPortType::TCP_SERVER:
+            ok = p.listen_sock != nullptr && p.tcp_server_start();
+            break;
+        case NetworkPortType::TCP_CLIENT:
+            // started by its connection thread
+        case NetworkPortType::NONE:
+            continue;
+        }
+        WITH_SEMAPHORE(p.sem);
+        if (ok) {
+            p.started = true;
+            continue;
+        }
+        delete p.sock;
+        p.sock = nullptr;
+        delete p.listen_sock;
+        p.listen_sock = nullptr;
+    }
+
+    // ports with data waiting for their socket to be writeable
+    bool want_write[ARRAY_SIZE(ports)] {};
+
+    while (true) {
+        fd_set rfds, wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        int maxfd = -1;
+
+        SocketAPM *socks[ARRAY_SIZE(ports)];
+        SocketAPM *listen_socks[ARRAY_SIZE(ports)];
+        for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+            auto &p = ports[i];
+            socks[i] = p.active_socket();
+            listen_socks[i] = nullptr;
+            if (socks[i] != nullptr) {
+                bool rx_blocked;
+                {
+                    WITH_SEMAPHORE(p.sem);
+                    rx_blocked = p.rx_blocked;
+                }
+                if (!rx_blocked) {
+                    const int fd = socks[i]->get_read_fd();
+                    FD_SET(fd, &rfds);
+                    maxfd = MAX(maxfd, fd);
+                }
+                if (want_write[i]) {
+                    const int fd = socks[i]->get_write_fd();
+                    FD_SET(fd, &wfds);
+                    maxfd = MAX(maxfd, fd);
+                }
+            } else if (p.type == NetworkPortType::TCP_SERVER && p.started && p.sock == nullptr) {
+                // waiting for a connection
+                listen_socks[i] = p.listen_sock;
+                const int fd = listen_socks[i]->get_read_fd();
+                FD_SET(fd, &rfds);
+                maxfd = MAX(maxfd, fd);
+            } else {
+                want_write[i] = false;
+            }
+        }
+
+#if AP_NETWORKING_NEED_LWIP
+        const int wake_fd = ports_wake_sock != nullptr ? ports_wake_sock->get_read_fd() : -1;
+#else
+        const int wake_fd = ports_wake_fd[0];
+#endif
+        if (wake_fd != -1) {
+            FD_SET(wake_fd, &rfds);
+            maxfd = MAX(maxfd, wake_fd);
+        }
+
+        struct timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = AP_NETWORKING_PORT_REACTOR_TIMEOUT_MS * 1000UL;
+        int ret = -1;
+        if (maxfd >= 0) {
+            ret = CALL_PREFIX(select)(maxfd+1, &rfds, &wfds, nullptr, &tv);
+        }
+        if (ret < 0) {
+            if (maxfd < 0 || errno != EINTR) {
+                // nothing to wait on, or a socket error
+                hal.scheduler->delay(AP_NETWORKING_PORT_REACTOR_TIMEOUT_MS);
+            }
+            FD_ZERO(&rfds);
+            FD_ZERO(&wfds);
+        }
+        const bool timed_out = (ret <= 0);
+
+        /*
+          drain before allowing new wake requests, a request made
+          after the flag is cleared writes a byte that is left for
+          the next select() to see
+         */
+        if (wake_fd != -1 && FD_ISSET(wake_fd, &rfds)) {
+            ports_wake_drain();
+        }
+        ports_wake_requested.store(false);
+
+        for (uint8_t i=0; i<ARRAY_SIZE(ports); i++) {
+            auto &p = ports[i];
+            bool woken = false;
+
+            if (listen_socks[i] != nullptr && FD_ISSET(listen_socks[i]->get_read_fd(), &rfds)) {
+                p.tcp_server_accept();
+                woken = true;
+            }
+
+            SocketAPM *s = socks[i];
+            if (s != nullptr && FD_ISSET(s->get_read_fd(), &rfds)) {
+                p.receive();
+                woken = true;
+                // the connection may have closed
+                s = p.active_socket();
+            }
+            if (s == nullptr) {
+                want_write[i] = false;
+            } else {
+                bool tx_wake;
+                {
+                    WITH_SEMAPHORE(p.sem);
+                    tx_wake = p.tx_wake;
+                }
+                const bool writeable = want_write[i] && FD_ISSET(s->get_write_fd(), &wfds);
+                if (tx_wake || writeable || timed_out) {
+                    want_write[i] = p.send();
+                    woken |= tx_wake || writeable;
+                }
+            }
+
+            if (woken) {
+                WITH_SEMAPHORE(p.sem);
+                p.stats.wakeups++;
+            }
+        }
+    }
+}
+
+/*
+  write per-port statistics since the last call
+ */
+void AP_Networking::ports_info(ExpandingString &str)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = now_ms - ports_info_ms;
+    ports_info_ms = now_ms;
+    for (auto &p : ports) {
+        if (p.type == NetworkPortType::NONE) {
+            continue;
+        }
+        p.port_info(str, dt_ms);
+    }
+}
+
+#endif // AP_NETWORKING_REGISTER_PORT_ENABLED
@@ -102,6 +102,7 @@ uint8_t AP_Param::_dynamic_table_sizes[AP_PARAM_MAX_DYNAMIC];
 uint16_t AP_Param::_parameter_count;
 uint16_t AP_Param::_count_marker;
 uint16_t AP_Param::_count_marker_done;
+uint16_t AP_Param::_save_generation;
 HAL_Semaphore AP_Param::_count_sem;
 
 // storage and naming information about all types that can be saved
@@ -1150,6 +1151,8 @@ void AP_Param::save_sync(bool force_save, bool send_to_gcs)
         return;
     }
 
+    _save_generation++;
+
     struct Param_header phdr;
 
     // create the header we will use to store the variable
@@ -2683,6 +2686,7 @@ void AP_Param::invalidate_count(void)
     // not-equal test is strong enough to ensure we get the right
     // answer
     _count_marker++;
+    _save_generation++;
 }
 
 /*
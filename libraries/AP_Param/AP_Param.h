@@ -575,6 +575,11 @@ public:
     // invalidate parameter count
     static void invalidate_count(void);
 
+    // counter incremented on every parameter save and every change to
+    // the set of parameters. Used by consumers that cache a packed
+    // copy of the parameter table to know when to refresh it
+    static uint16_t get_save_generation(void) { return _save_generation; }
+
     static void set_hide_disabled_groups(bool value) { _hide_disabled_groups = value; }
 
     // set frame type flags. Used to unhide frame specific parameters
@@ -812,6 +817,7 @@ private:
     static uint16_t             _parameter_count;
     static uint16_t             _count_marker;
     static uint16_t             _count_marker_done;
+    static uint16_t             _save_generation;
     static HAL_Semaphore        _count_sem;
     static const struct Info *  _var_info;
 
@@ -94,6 +94,7 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @Bitmask: 3: log runtime memory usage and execution time
     // @Bitmask: 4: Disable pre-arm check
     // @Bitmask: 5: Save CRC of current scripts to loaded and running checksum parameters enabling pre-arm
+    // @Bitmask: 6: Enable bytecode cache. WARNING: cached bytecode is trusted, so anyone able to write files on the vehicle, including over MAVLink FTP, can change the scripts that run. The cache is not used while SCR_LD_CHECKSUM or SCR_RUN_CHECKSUM are set
     // @User: Advanced
     AP_GROUPINFO("DEBUG_OPTS", 4, AP_Scripting, _debug_options, 0),
 
@@ -161,6 +162,29 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("THD_PRIORITY", 14, AP_Scripting, _thd_priority, uint8_t(ThreadPriority::NORMAL)),
 
+    // @Param: GC_MODE
+    // @DisplayName: Scripting garbage collection mode
+    // @Description: Garbage collection run after each script. Full runs a complete collection every time. Incremental runs a step of SCR_GC_STEP kilobytes, with a complete collection only when the scripting heap is more than SCR_GC_FULL_PCT full or an allocation has failed
+    // @Values: 0:Full, 1:Incremental
+    // @User: Advanced
+    AP_GROUPINFO("GC_MODE", 19, AP_Scripting, _gc_mode, uint8_t(GCMode::INCREMENTAL)),
+
+    // @Param: GC_STEP
+    // @DisplayName: Scripting garbage collection step
+    // @Description: Amount of memory the incremental garbage collection step after each script run accounts for. Larger steps free memory faster at the cost of longer pauses
+    // @Range: 0 100
+    // @Units: kB
+    // @User: Advanced
+    AP_GROUPINFO("GC_STEP", 20, AP_Scripting, _gc_step_kb, 4),
+
+    // @Param: GC_FULL_PCT
+    // @DisplayName: Scripting full garbage collection threshold
+    // @Description: Percentage of the scripting heap in use above which incremental garbage collection runs a complete collection
+    // @Range: 10 100
+    // @Units: %
+    // @User: Advanced
+    AP_GROUPINFO("GC_FULL_PCT", 21, AP_Scripting, _gc_full_pct, 75),
+
 #if AP_SCRIPTING_SERIALDEVICE_ENABLED
     // @Param: SDEV_EN
     // @DisplayName: Scripting serial device enable
@@ -96,6 +96,18 @@ public:
     };
     uint16_t get_disabled_dir() { return uint16_t(_dir_disable.get());}
 
+    // garbage collection after each script run
+    enum class GCMode : uint8_t {
+        FULL = 0,           // full collection
+        INCREMENTAL = 1,    // incremental step, full collection under heap pressure
+    };
+    GCMode get_gc_mode() const { return _gc_mode; }
+    uint8_t get_gc_step_kb() const { return uint8_t(_gc_step_kb.get()); }
+    uint8_t get_gc_full_pct() const { return uint8_t(_gc_full_pct.get()); }
+
+    // true if the loaded or running scripts must match a checksum
+    bool checksum_required() const { return _required_loaded_checksum != -1 || _required_running_checksum != -1; }
+
     // the number of and storage for i2c devices
     uint8_t num_i2c_devices;
     AP_HAL::OwnPtr<AP_HAL::I2CDevice> *_i2c_dev[SCRIPTING_MAX_NUM_I2C_DEVICE];
@@ -187,6 +199,10 @@ private:
 
     AP_Enum<ThreadPriority> _thd_priority;
 
+    AP_Enum<GCMode> _gc_mode;
+    AP_Int8 _gc_step_kb;
+    AP_Int8 _gc_full_pct;
+
     bool _thread_failed; // thread allocation failed
     bool _init_failed;  // true if memory allocation failed
     bool _restart; // true if scripts should be restarted
@@ -803,6 +803,16 @@ function Vector2f() end
 ---@return Vector2f_ud -- a copy of this Vector2f
 function Vector2f_ud:copy() end
 
+-- Add another Vector2f to this one in place, without creating a new userdata object
+---@param value Vector2f_ud
+---@return Vector2f_ud -- this Vector2f
+function Vector2f_ud:add(value) end
+
+-- Subtract another Vector2f from this one in place, without creating a new userdata object
+---@param value Vector2f_ud
+---@return Vector2f_ud -- this Vector2f
+function Vector2f_ud:sub(value) end
+
 -- get y component
 ---@return number
 function Vector2f_ud:y() end
@@ -863,6 +873,16 @@ function Vector3f() end
 ---@return Vector3f_ud -- a copy of this Vector3f
 function Vector3f_ud:copy() end
 
+-- Add another Vector3f to this one in place, without creating a new userdata object
+---@param value Vector3f_ud
+---@return Vector3f_ud -- this Vector3f
+function Vector3f_ud:add(value) end
+
+-- Subtract another Vector3f from this one in place, without creating a new userdata object
+---@param value Vector3f_ud
+---@return Vector3f_ud -- this Vector3f
+function Vector3f_ud:sub(value) end
+
 -- get z component
 ---@return number
 function Vector3f_ud:z() end
@@ -982,6 +1002,11 @@ function Quaternion_ud:earth_to_body(vec) end
 ---@return Quaternion_ud
 function Quaternion_ud:inverse() end
 
+-- Multiply this quaternion by another in place, without creating a new userdata object
+---@param value Quaternion_ud
+---@return Quaternion_ud -- this quaternion
+function Quaternion_ud:mul(value) end
+
 -- Integrates angular velocity over small time delta
 ---@param angular_velocity Vector3f_ud
 ---@param time_delta number
@@ -32,6 +32,7 @@ char keyword_global[]              = "global";
 char keyword_creation[]            = "creation";
 char keyword_manual_operator[]     = "manual_operator";
 char keyword_operator_getter[]     = "operator_getter";
+char keyword_operator_inplace[]    = "operator_inplace";
 
 // attributes (should include the leading ' )
 char keyword_attr_enum[]    = "'enum";
@@ -406,6 +407,12 @@ struct userdata_enum {
   char * name;     // enum name
 };
 
+struct inplace_operator {
+  struct inplace_operator *next;
+  enum operator_type type;
+  char *name; // method name for scripting access
+};
+
 struct userdata {
   struct userdata * next;
   char *name;  // name of the C++ singleton
@@ -422,6 +429,7 @@ struct userdata {
   char *creation; // name of a manual creation function if set, note that this will not be used internally
   int creation_args; // number of args for custom creation function
   char *operator_getter; // Custom function to get values for use in operators
+  struct inplace_operator *inplace_operators; // operators that update the first argument rather than creating a new object
 };
 
 static struct userdata *parsed_userdata;
@@ -925,18 +933,7 @@ void handle_manual(struct userdata *node, enum alias_type type) {
   node->method_aliases = alias;
 }
 
-void handle_operator(struct userdata *data) {
-  trace(TRACE_USERDATA, "Adding a operator");
-
-  if (data->ud_type != UD_USERDATA) {
-    error(ERROR_USERDATA, "Operators are only allowed on userdata objects");
-  }
-
-  char *operator = next_token();
-  if (operator == NULL) {
-    error(ERROR_USERDATA, "Needed a symbol for the operator");
-  }
-
+enum operator_type parse_operator(const char *operator) {
   enum operator_type operation = OP_ADD;
   if (strcmp(operator, "+") == 0) {
     operation = OP_ADD;
@@ -969,6 +966,22 @@ void handle_operator(struct userdata *data) {
   } else {
     error(ERROR_USERDATA, "Unknown operation type: %s", operator);
   }
+  return operation;
+}
+
+void handle_operator(struct userdata *data) {
+  trace(TRACE_USERDATA, "Adding a operator");
+
+  if (data->ud_type != UD_USERDATA) {
+    error(ERROR_USERDATA, "Operators are only allowed on userdata objects");
+  }
+
+  char *operator = next_token();
+  if (operator == NULL) {
+    error(ERROR_USERDATA, "Needed a symbol for the operator");
+  }
+
+  enum operator_type operation = parse_operator(operator);
 
   if ((data->operations) & operation) {
     error(ERROR_USERDATA, "Operation %s was already defined for %s", operator, data->name);
@@ -983,6 +996,49 @@ void handle_operator(struct userdata *data) {
   }
 }
 
+void handle_operator_inplace(struct userdata *data) {
+  trace(TRACE_USERDATA, "Adding a in-place operator");
+
+  if (data->ud_type != UD_USERDATA) {
+    error(ERROR_USERDATA, "Operators are only allowed on userdata objects");
+  }
+
+  char *operator = next_token();
+  if (operator == NULL) {
+    error(ERROR_USERDATA, "Needed a symbol for the operator");
+  }
+
+  enum operator_type operation = parse_operator(operator);
+  if (operation & (OP_EQ | OP_LT | OP_LE | OP_BNOT | OP_MANUAL)) {
+    error(ERROR_USERDATA, "In-place operation %s must take two values and return the same type", operator);
+  }
+
+  char *name = next_token();
+  if (name == NULL) {
+    error(ERROR_USERDATA, "Needed a method name for in-place operation %s", operator);
+  }
+
+  // keep the order of the description
+  struct inplace_operator **tail = &(data->inplace_operators);
+  while (*tail != NULL) {
+    if ((*tail)->type == operation) {
+      error(ERROR_USERDATA, "In-place operation %s was already defined for %s", operator, data->name);
+    }
+    tail = &((*tail)->next);
+  }
+
+  trace(TRACE_USERDATA, "Adding in-place operation %d to %s as %s", operation, data->name, name);
+
+  struct inplace_operator *inplace = (struct inplace_operator *)allocate(sizeof(struct inplace_operator));
+  inplace->type = operation;
+  string_copy(&(inplace->name), name);
+  *tail = inplace;
+
+  if (next_token() != NULL) {
+    error(ERROR_USERDATA, "Extra token on in-place operation %s", operator);
+  }
+}
+
 void handle_userdata(void) {
   trace(TRACE_USERDATA, "Adding a userdata");
 
@@ -1064,6 +1120,9 @@ void handle_userdata(void) {
     handle_manual(node, ALIAS_TYPE_MANUAL_OPERATOR);
     node->operations |= OP_MANUAL;
 
+  } else if (strcmp(type, keyword_operator_inplace) == 0) {
+    handle_operator_inplace(node);
+
   } else if (strcmp(type, keyword_operator_getter) == 0) {
       if (node->operator_getter != NULL) {
         error(ERROR_USERDATA, "Userdata only support a single getter string");
@@ -2360,6 +2419,31 @@ void emit_operators(struct userdata *data) {
 
   }
 
+  // in-place operators write the result into the first argument and
+  // return it, so no new userdata is created
+  struct inplace_operator *inplace = data->inplace_operators;
+  while (inplace != NULL) {
+    const char * op_name = get_name_for_operation(inplace->type);
+    const char * op_sym = get_sym_for_operation(inplace->type);
+
+    const int have_getter = data->operator_getter != NULL;
+    const char * access = have_getter ? "" : "*";
+    const char * getter_prefix = have_getter ? "" : "check_";
+    const char * getter = have_getter ? data->operator_getter : data->sanatized_name;
+
+    fprintf(source, "static int %s_%s_inplace(lua_State *L) {\n", data->sanatized_name, op_name);
+    fprintf(source, "    binding_argcheck(L, 2);\n");
+    // the first argument must be the userdata to update
+    fprintf(source, "    %s *ud = check_%s(L, 1);\n", data->name, data->sanatized_name);
+    fprintf(source, "    %s %sud2 = %s%s(L, 2);\n", data->name, access, getter_prefix, getter);
+    fprintf(source, "    *ud = (*ud) %s (%sud2);\n", op_sym, access);
+    fprintf(source, "    lua_settop(L, 1);\n");
+    fprintf(source, "    return 1;\n");
+    fprintf(source, "}\n\n");
+
+    inplace = inplace->next;
+  }
+
   end_dependency(source, data->dependency);
 }
 
@@ -2373,7 +2457,7 @@ void emit_methods(struct userdata *node) {
     }
 
     // operators
-    if (node->operations) {
+    if (node->operations || node->inplace_operators) {
       emit_operators(node);
     }
     node = node->next;
@@ -2412,6 +2496,12 @@ void emit_index(struct userdata *head) {
       field = field->next;
     }
 
+    struct inplace_operator *inplace = node->inplace_operators;
+    while(inplace) {
+      fprintf(source, "    {\"%s\", %s_%s_inplace},\n", inplace->name, node->sanatized_name, get_name_for_operation(inplace->type));
+      inplace = inplace->next;
+    }
+
     struct method_alias *alias = node->method_aliases;
     while(alias) {
       start_dependency(source, alias->dependency);
@@ -2941,6 +3031,20 @@ void emit_docs(struct userdata *node, int is_userdata, int emit_creation) {
       method = method->next;
     }
 
+    // in-place operators
+    struct inplace_operator *inplace = node->inplace_operators;
+    while(inplace) {
+      fprintf(docs, "-- desc\n");
+      if (node->operator_getter != NULL) {
+        fprintf(docs, "---@param value %s|integer|number\n", name);
+      } else {
+        fprintf(docs, "---@param value %s\n", name);
+      }
+      fprintf(docs, "---@return %s\n", name);
+      fprintf(docs, "function %s:%s(value) end\n\n", name, inplace->name);
+      inplace = inplace->next;
+    }
+
     // aliases
     struct method_alias *alias = node->method_aliases;
     while(alias) {
@@ -772,6 +772,17 @@ static void checkmode (lua_State *L, const char *mode, const char *x) {
 }
 
 
+/*
+  compared by address, so only callers of lua_trustedbinarymode can
+  load binary chunks when LUA_SUPPORT_LOAD_BINARY is disabled
+ */
+static const char trusted_binary_mode[] = "b";
+
+LUA_API const char *lua_trustedbinarymode (void) {
+  return trusted_binary_mode;
+}
+
+
 static void f_parser (lua_State *L, void *ud) {
   LClosure *cl;
   struct SParser *p = cast(struct SParser *, ud);
@@ -779,11 +790,13 @@ static void f_parser (lua_State *L, void *ud) {
 #if LUA_SUPPORT_LOAD_BINARY
   // support loading pre-compiled luac
   if (c == LUA_SIGNATURE[0]) {
+#else
+  if (c == LUA_SIGNATURE[0] && p->mode == trusted_binary_mode) {
+#endif
     checkmode(L, p->mode, "binary");
     cl = luaU_undump(L, p->z, p->name);
   }
   else
-#endif
   {
     checkmode(L, p->mode, "text");
     cl = luaY_parser(L, p->z, &p->buff, &p->dyd, p->name, c);
@@ -282,6 +282,13 @@ LUA_API int   (lua_load) (lua_State *L, lua_Reader reader, void *dt,
 
 LUA_API int (lua_dump) (lua_State *L, lua_Writer writer, void *data, int strip);
 
+/*
+  mode for lua_load that accepts binary chunks even when
+  LUA_SUPPORT_LOAD_BINARY is disabled. Only for bytecode the caller
+  has validated, scripts can't pass this mode to load()
+ */
+LUA_API const char *(lua_trustedbinarymode) (void);
+
 
 /*
 ** coroutine functions
@@ -23,6 +23,16 @@
 #include <AP_Logger/AP_Logger.h>
 
 #include <AP_Scripting/lua_generated_bindings.h>
+#include <AP_Math/crc.h>
+#include <string.h>
+
+#if AP_SCRIPTING_USERDATA_POOL_ENABLED
+extern "C" {
+#include "lua/src/lobject.h"
+}
+
+#define UD_POOL_BLOCK_SIZE(payload) uint16_t((sizeof(UUdata) + (payload) + 7U) & ~7U)
+#endif
 
 #define DISABLE_INTERRUPTS_FOR_SCRIPT_RUN 0
 
@@ -48,6 +58,9 @@ lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, co
 }
 
 lua_scripts::~lua_scripts() {
+#if AP_SCRIPTING_USERDATA_POOL_ENABLED
+    _ud_pool.reset();
+#endif
     _heap.destroy();
 }
 
@@ -127,13 +140,14 @@ int lua_scripts::atpanic(lua_State *L) {
 }
 
 // helper for print and log of runtime stats
-void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem)
+void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem, uint32_t gc_time)
 {
     if ((_debug_options.get() & uint8_t(DebugLevel::RUNTIME_MSG)) != 0) {
-        GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Time: %u Mem: %d + %d",
+        GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Time: %u Mem: %d + %d GC: %u",
                                             (unsigned int)run_time,
                                             (int)total_mem,
-                                            (int)run_mem);
+                                            (int)run_mem,
+                                            (unsigned int)gc_time);
     }
 #if HAL_LOGGING_ENABLED
     if ((_debug_options.get() & uint8_t(DebugLevel::LOG_RUNTIME)) != 0) {
@@ -143,7 +157,8 @@ void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_me
             name         : {},
             run_time     : run_time,
             total_mem    : total_mem,
-            run_mem      : run_mem
+            run_mem      : run_mem,
+            gc_time      : gc_time
         };
         const char * name_short = strrchr(name, '/');
         if ((strlen(name) > sizeof(pkt.name)) && (name_short != nullptr)) {
@@ -156,8 +171,213 @@ void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_me
 #endif // HAL_LOGGING_ENABLED
 }
 
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+#define BYTECODE_CACHE_MAGIC "APLB"
+#define BYTECODE_CACHE_HEADER_VERSION 1
+#define BYTECODE_CACHE_SUFFIX "c"
+
+// size of the buffer used for reading and writing cache files
+#define BYTECODE_CACHE_BUFFER_SIZE 256
+
+struct BytecodeCacheIO {
+    int fd;
+    uint8_t *buf;
+    uint32_t used;
+    uint32_t len;
+    uint32_t crc;
+    bool failed;
+};
+
+static const char *bytecode_cache_reader(lua_State *L, void *ud, size_t *size)
+{
+    (void)L;
+    BytecodeCacheIO &io = *(BytecodeCacheIO *)ud;
+    const int32_t n = AP::FS().read(io.fd, io.buf, BYTECODE_CACHE_BUFFER_SIZE);
+    if (n <= 0) {
+        *size = 0;
+        return nullptr;
+    }
+    *size = n;
+    return (const char *)io.buf;
+}
+
+static bool bytecode_cache_flush(BytecodeCacheIO &io)
+{
+    if (io.used > 0 && AP::FS().write(io.fd, io.buf, io.used) != int32_t(io.used)) {
+        io.failed = true;
+    }
+    io.used = 0;
+    return !io.failed;
+}
+
+// lua_dump produces many small blocks, so buffer them into larger writes
+static int bytecode_cache_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+    (void)L;
+    BytecodeCacheIO &io = *(BytecodeCacheIO *)ud;
+    const uint8_t *data = (const uint8_t *)p;
+    io.crc = crc_crc32(io.crc, data, sz);
+    io.len += sz;
+    while (sz > 0) {
+        const uint32_t n = MIN(sz, BYTECODE_CACHE_BUFFER_SIZE - io.used);
+        memcpy(&io.buf[io.used], data, n);
+        io.used += n;
+        data += n;
+        sz -= n;
+        if (io.used == BYTECODE_CACHE_BUFFER_SIZE && !bytecode_cache_flush(io)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+  the cache name is the script name prefixed with the crc32 of its
+  directory, so scripts of the same name in ROMFS and on the SD card
+  have their own entries
+ */
+char *lua_scripts::bytecode_cache_name(const char *filename)
+{
+    const char *base = strrchr(filename, '/');
+    base = (base == nullptr) ? filename : base + 1;
+    const uint32_t dir_crc = crc_crc32(0, (const uint8_t *)filename, base - filename);
+    const size_t size = strlen(AP_SCRIPTING_BYTECODE_CACHE_DIRECTORY) + strlen(base) + strlen(BYTECODE_CACHE_SUFFIX) + 11;
+    char *cache_name = (char *)_heap.allocate(size);
+    if (cache_name != nullptr) {
+        hal.util->snprintf(cache_name, size, "%s/%08x_%s%s", AP_SCRIPTING_BYTECODE_CACHE_DIRECTORY,
+                           unsigned(dir_crc), base, BYTECODE_CACHE_SUFFIX);
+    }
+    return cache_name;
+}
+
+bool lua_scripts::load_bytecode_cache(lua_State *L, const char *filename, const char *cache_name, uint32_t crc)
+{
+    const int fd = AP::FS().open(cache_name, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    BytecodeCacheIO io {};
+    io.fd = fd;
+    io.buf = (uint8_t *)_heap.allocate(BYTECODE_CACHE_BUFFER_SIZE);
+
+    BytecodeCacheHeader hdr;
+    bool ok = io.buf != nullptr &&
+              AP::FS().read(fd, &hdr, sizeof(hdr)) == int32_t(sizeof(hdr)) &&
+              memcmp(hdr.magic, BYTECODE_CACHE_MAGIC, sizeof(hdr.magic)) == 0 &&
+              hdr.lua_version == LUA_VERSION_NUM &&
+              hdr.header_version == BYTECODE_CACHE_HEADER_VERSION &&
+              hdr.source_crc == crc;
+
+    // check all of the bytecode before Lua sees any of it
+    while (ok) {
+        const int32_t n = AP::FS().read(fd, io.buf, BYTECODE_CACHE_BUFFER_SIZE);
+        if (n < 0) {
+            ok = false;
+        } else if (n == 0) {
+            break;
+        } else {
+            io.crc = crc_crc32(io.crc, io.buf, n);
+            io.len += n;
+        }
+    }
+    ok = ok && io.len == hdr.bytecode_len && io.crc == hdr.bytecode_crc &&
+         AP::FS().lseek(fd, sizeof(hdr), SEEK_SET) == int32_t(sizeof(hdr));
+
+    if (ok) {
+        // use the same chunk name as luaL_loadfile
+        lua_pushfstring(L, "@%s", filename);
+        const int status = lua_load(L, bytecode_cache_reader, &io, lua_tostring(L, -1), lua_trustedbinarymode());
+        lua_remove(L, -2);
+        if (status != LUA_OK) {
+            lua_pop(L, 1);
+            ok = false;
+        }
+    }
+
+    AP::FS().close(fd);
+    _heap.deallocate(io.buf);
+    return ok;
+}
+
+void lua_scripts::save_bytecode_cache(lua_State *L, const char *cache_name, uint32_t crc)
+{
+    int fd = AP::FS().open(cache_name, O_WRONLY|O_CREAT|O_TRUNC);
+    if (fd == -1) {
+        AP::FS().mkdir(AP_SCRIPTING_BYTECODE_CACHE_DIRECTORY);
+        fd = AP::FS().open(cache_name, O_WRONLY|O_CREAT|O_TRUNC);
+        if (fd == -1) {
+            return;
+        }
+    }
+    BytecodeCacheIO io {};
+    io.fd = fd;
+    io.buf = (uint8_t *)_heap.allocate(BYTECODE_CACHE_BUFFER_SIZE);
+
+    // the header is written last, so a partial file is never valid
+    BytecodeCacheHeader hdr {};
+    bool ok = io.buf != nullptr &&
+              AP::FS().write(fd, &hdr, sizeof(hdr)) == int32_t(sizeof(hdr)) &&
+              lua_dump(L, bytecode_cache_writer, &io, 0) == 0 &&
+              bytecode_cache_flush(io);
+    if (ok) {
+        memcpy(hdr.magic, BYTECODE_CACHE_MAGIC, sizeof(hdr.magic));
+        hdr.lua_version = LUA_VERSION_NUM;
+        hdr.header_version = BYTECODE_CACHE_HEADER_VERSION;
+        hdr.source_crc = crc;
+        hdr.bytecode_len = io.len;
+        hdr.bytecode_crc = io.crc;
+        ok = AP::FS().lseek(fd, 0, SEEK_SET) == 0 &&
+             AP::FS().write(fd, &hdr, sizeof(hdr)) == int32_t(sizeof(hdr));
+    }
+
+    AP::FS().close(fd);
+    _heap.deallocate(io.buf);
+    if (!ok) {
+        AP::FS().unlink(cache_name);
+    }
+}
+#endif // AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+
+/*
+  load a script, from the bytecode cache if it holds the current
+  version of the script. Otherwise the source is compiled and the
+  result added to the cache
+ */
+int lua_scripts::load_chunk(lua_State *L, const char *filename, bool have_crc, uint32_t crc)
+{
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+    char *cache_name = nullptr;
+    // the loaded and running checksums are of the source, so they
+    // could not vouch for cached bytecode
+    if (have_crc && (_debug_options.get() & uint8_t(DebugLevel::ENABLE_BYTECODE_CACHE)) != 0 &&
+        !AP_Scripting::get_singleton()->checksum_required()) {
+        cache_name = bytecode_cache_name(filename);
+    }
+    if (cache_name != nullptr && load_bytecode_cache(L, filename, cache_name, crc)) {
+        _heap.deallocate(cache_name);
+        return LUA_OK;
+    }
+#endif
+
+    const int error = luaL_loadfile(L, filename);
+
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+    if (cache_name != nullptr) {
+        if (error == LUA_OK) {
+            save_bytecode_cache(L, cache_name, crc);
+        }
+        _heap.deallocate(cache_name);
+    }
+#endif
+    return error;
+}
+
 lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename) {
-    if (int error = luaL_loadfile(L, filename)) {
+    // Get checksum of file
+    uint32_t crc = 0;
+    const bool have_crc = AP::FS().crc32(filename, crc);
+
+    if (int error = load_chunk(L, filename, have_crc, crc)) {
         switch (error) {
             case LUA_ERRSYNTAX:
                 set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "Error: %s", lua_tostring(L, -1));
@@ -196,15 +416,13 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
     const uint32_t loadEnd = AP_HAL::micros();
     const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
 
-    update_stats(filename, loadEnd-loadStart, endMem, loadMem);
+    update_stats(filename, loadEnd-loadStart, endMem, loadMem, 0);
 
     new_script->name = filename;
     new_script->lua_ref = luaL_ref(L, LUA_REGISTRYINDEX);   // cache the reference
     new_script->next_run_ms = AP_HAL::millis64() - 1; // force the script to be stale
 
-    // Get checksum of file
-    uint32_t crc = 0;
-    if (AP::FS().crc32(filename, crc)) {
+    if (have_crc) {
         // Record crc of this script
         new_script->crc = crc;
         {
@@ -452,9 +670,78 @@ void lua_scripts::reschedule_script(script_info *script) {
 
 MultiHeap lua_scripts::_heap;
 
+/*
+  a complete collection is needed once the heap is nearly full, or
+  if an allocation has failed since the last check
+ */
+bool lua_scripts::heap_pressure(lua_State *L)
+{
+    const uint32_t failed = _heap.get_failed_allocations();
+    if (failed != gc_failed_allocations) {
+        gc_failed_allocations = failed;
+        return true;
+    }
+    uint32_t used = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+#if AP_SCRIPTING_USERDATA_POOL_ENABLED
+    // free pooled blocks are not counted by Lua but are not free in the heap
+    used += _ud_pool.free_bytes();
+#endif
+    return uint64_t(used) * 100U > uint64_t(_heap.get_size()) * AP_Scripting::get_singleton()->get_gc_full_pct();
+}
+
+/*
+  collect garbage after a script has run. Lua collects incrementally
+  as memory is allocated, the step here keeps the collector ahead of
+  the scripts without the cost of a complete collection every run
+ */
+uint32_t lua_scripts::collect_garbage(lua_State *L)
+{
+    const uint32_t start_us = AP_HAL::micros();
+    const AP_Scripting *scripting = AP_Scripting::get_singleton();
+    if (scripting->get_gc_mode() == AP_Scripting::GCMode::FULL || heap_pressure(L)) {
+        lua_gc(L, LUA_GCCOLLECT, 0);
+#if AP_SCRIPTING_USERDATA_POOL_ENABLED
+        // return the slabs emptied by the collection to the heap
+        _ud_pool.trim();
+#endif
+    } else {
+        lua_gc(L, LUA_GCSTEP, scripting->get_gc_step_kb());
+    }
+    return AP_HAL::micros() - start_us;
+}
+
+#if AP_SCRIPTING_USERDATA_POOL_ENABLED
+/*
+  block sizes hold the userdata header plus a boxed number, a Vector3f
+  or Location, and the larger vectors and quaternions
+ */
+static const uint16_t ud_pool_block_sizes[] {
+    UD_POOL_BLOCK_SIZE(8),
+    UD_POOL_BLOCK_SIZE(16),
+    UD_POOL_BLOCK_SIZE(32),
+};
+lua_scripts::UserdataPool lua_scripts::_ud_pool{_heap, ud_pool_block_sizes};
+#endif // AP_SCRIPTING_USERDATA_POOL_ENABLED
+
 void *lua_scripts::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
     (void)ud; /* not used */
+#if AP_SCRIPTING_USERDATA_POOL_ENABLED
+    // for a new object osize is its type
+    if (ptr == nullptr && osize == LUA_TUSERDATA && nsize != 0) {
+        void *ret = _ud_pool.allocate(nsize);
+        if (ret != nullptr) {
+            return ret;
+        }
+    }
+    void *ret = _ud_pool.change_size(ptr, osize, nsize);
+    if (ret == nullptr && nsize != 0 && _ud_pool.trim()) {
+        // empty slabs have been returned to the heap
+        ret = _ud_pool.change_size(ptr, osize, nsize);
+    }
+    return ret;
+#else
     return _heap.change_size(ptr, osize, nsize);
+#endif
 }
 
 void lua_scripts::run(void) {
@@ -560,7 +847,9 @@ void lua_scripts::run(void) {
             void *istate = hal.scheduler->disable_interrupts_save();
 #endif
 
-            const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+            // memory is only accounted for when the stats are used
+            const bool want_stats = (_debug_options.get() & (uint8_t(DebugLevel::RUNTIME_MSG) | uint8_t(DebugLevel::LOG_RUNTIME))) != 0;
+            const int startMem = want_stats ? lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0) : 0;
             const uint32_t loadEnd = AP_HAL::micros();
 
             // NOTE!  the base pointer of our scripts linked list,
@@ -570,17 +859,18 @@ void lua_scripts::run(void) {
             run_next_script(L);
 
             const uint32_t runEnd = AP_HAL::micros();
-            const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+            const int endMem = want_stats ? lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0) : 0;
 
 #if DISABLE_INTERRUPTS_FOR_SCRIPT_RUN
             hal.scheduler->restore_interrupts(istate);
 #endif
 
-            update_stats(script_name, runEnd - loadEnd, endMem, endMem - startMem);
+            // garbage collect after each script, see SCR_GC_MODE
+            const uint32_t gc_time = collect_garbage(L);
 
-
-            // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
-            lua_gc(L, LUA_GCCOLLECT, 0);
+            if (want_stats) {
+                update_stats(script_name, runEnd - loadEnd, endMem, endMem - startMem, gc_time);
+            }
 
         } else {
             if ((_debug_options.get() & uint8_t(DebugLevel::NO_SCRIPTS_TO_RUN)) != 0) {
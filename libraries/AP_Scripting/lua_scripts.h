@@ -27,10 +27,35 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_HAL/Semaphores.h>
 #include <AP_Common/MultiHeap.h>
+#include <AP_Common/MultiHeapPool.h>
 #include "lua_common_defs.h"
 
 #include "lua/src/lua.hpp"
 
+#ifndef AP_SCRIPTING_USERDATA_POOL_ENABLED
+#define AP_SCRIPTING_USERDATA_POOL_ENABLED 1
+#endif
+
+// number of blocks in each slab of a userdata pool
+#ifndef AP_SCRIPTING_USERDATA_POOL_BLOCKS
+#define AP_SCRIPTING_USERDATA_POOL_BLOCKS 32
+#endif
+
+// maximum number of slabs in each userdata pool, allocations beyond
+// this come from the heap
+#ifndef AP_SCRIPTING_USERDATA_POOL_SLABS
+#define AP_SCRIPTING_USERDATA_POOL_SLABS 8
+#endif
+
+#ifndef AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+#define AP_SCRIPTING_BYTECODE_CACHE_ENABLED 1
+#endif
+
+// directory holding compiled scripts
+#ifndef AP_SCRIPTING_BYTECODE_CACHE_DIRECTORY
+#define AP_SCRIPTING_BYTECODE_CACHE_DIRECTORY SCRIPTING_DIRECTORY "/cache"
+#endif
+
 class lua_scripts
 {
 public:
@@ -55,6 +80,7 @@ public:
         LOG_RUNTIME = 1U << 3,
         DISABLE_PRE_ARM = 1U << 4,
         SAVE_CHECKSUM = 1U << 5,
+        ENABLE_BYTECODE_CACHE = 1U << 6,
     };
 
 private:
@@ -71,6 +97,37 @@ private:
 
     script_info *load_script(lua_State *L, char *filename);
 
+    // load a script as a function on the top of the stack, returns a lua error code
+    int load_chunk(lua_State *L, const char *filename, bool have_crc, uint32_t crc);
+
+#if AP_SCRIPTING_BYTECODE_CACHE_ENABLED
+    /*
+      compiled scripts are cached as the output of lua_dump after this
+      header. The checksum of the source is used to find stale entries
+      and the checksum of the bytecode is checked before it is loaded,
+      as Lua does not validate bytecode. The checksums only detect
+      stale and corrupt entries, anyone able to write the cache can
+      replace a script, so the cache is opt-in
+     */
+    struct PACKED BytecodeCacheHeader {
+        char magic[4];
+        uint16_t lua_version;
+        uint16_t header_version;
+        uint32_t source_crc;
+        uint32_t bytecode_len;
+        uint32_t bytecode_crc;
+    };
+
+    // return the cache file name for a script, allocated on the heap
+    char *bytecode_cache_name(const char *filename);
+
+    // load a script from the cache, false if the cache entry is missing or stale
+    bool load_bytecode_cache(lua_State *L, const char *filename, const char *cache_name, uint32_t crc);
+
+    // save the function on the top of the stack to the cache
+    void save_bytecode_cache(lua_State *L, const char *cache_name, uint32_t crc);
+#endif
+
     void reset_loop_overtime(lua_State *L);
 
     void load_all_scripts_in_dir(lua_State *L, const char *dirname);
@@ -101,8 +158,25 @@ private:
 
     static MultiHeap _heap;
 
+#if AP_SCRIPTING_USERDATA_POOL_ENABLED
+    /*
+      pools of fixed size blocks for small userdata. Boxed numbers and
+      vectors are created for nearly every binding call and operator,
+      so they are taken from slabs instead of the heap
+     */
+    typedef MultiHeapPool<3, AP_SCRIPTING_USERDATA_POOL_BLOCKS, AP_SCRIPTING_USERDATA_POOL_SLABS> UserdataPool;
+    static UserdataPool _ud_pool;
+#endif
+
     // helper for print and log of runtime stats
-    void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem);
+    void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem, uint32_t gc_time);
+
+    // run garbage collection after a script, returning the time taken in microseconds
+    uint32_t collect_garbage(lua_State *L);
+
+    // true if the heap is full enough to need a complete collection
+    bool heap_pressure(lua_State *L);
+    uint32_t gc_failed_allocations; // heap allocation failures at the last check
 
     // must be static for use in atpanic
     static void print_error(MAV_SEVERITY severity);
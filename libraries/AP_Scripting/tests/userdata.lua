@@ -0,0 +1,118 @@
+-- tests of userdata allocation and the in-place operators
+-- each run creates more userdata than the pools hold, so objects come
+-- from both the pools and the heap, and are freed and reused by the
+-- garbage collection between runs
+
+local loop_time = 100 -- number of ms between runs
+local num_objects = 1000 -- more than the pools hold
+local runs = 0
+
+local function vec3(x, y, z)
+  local v = Vector3f()
+  v:x(x)
+  v:y(y)
+  v:z(z)
+  return v
+end
+
+local function vec2(x, y)
+  local v = Vector2f()
+  v:x(x)
+  v:y(y)
+  return v
+end
+
+local function eq3(a, b)
+  return a:x() == b:x() and a:y() == b:y() and a:z() == b:z()
+end
+
+local function eq2(a, b)
+  return a:x() == b:x() and a:y() == b:y()
+end
+
+local function test_inplace()
+  local pass = true
+
+  local a = vec3(1, 2, 3)
+  local b = vec3(0.5, -1, 4)
+  local sum = a + b
+  if not rawequal(a:add(b), a) or not eq3(a, sum) then
+    gcs:send_text(0, "Failed Vector3f add")
+    pass = false
+  end
+  local diff = a - b
+  if not rawequal(a:sub(b), a) or not eq3(a, diff) or not eq3(a, vec3(1, 2, 3)) then
+    gcs:send_text(0, "Failed Vector3f sub")
+    pass = false
+  end
+
+  local c = vec2(1, 2)
+  local d = vec2(-3, 0.25)
+  local sum2 = c + d
+  if not rawequal(c:add(d), c) or not eq2(c, sum2) then
+    gcs:send_text(0, "Failed Vector2f add")
+    pass = false
+  end
+  if not rawequal(c:sub(d), c) or not eq2(c, vec2(1, 2)) then
+    gcs:send_text(0, "Failed Vector2f sub")
+    pass = false
+  end
+
+  local q = Quaternion()
+  q:from_euler(0.1, 0.2, 0.3)
+  local r = Quaternion()
+  r:from_euler(-0.3, 0.1, 0.5)
+  local prod = q * r
+  if not rawequal(q:mul(r), q) then
+    gcs:send_text(0, "Failed Quaternion mul return")
+    pass = false
+  end
+  if q:q1() ~= prod:q1() or q:q2() ~= prod:q2() or q:q3() ~= prod:q3() or q:q4() ~= prod:q4() then
+    gcs:send_text(0, "Failed Quaternion mul")
+    pass = false
+  end
+
+  return pass
+end
+
+-- objects of each pool size must keep their own values while many are live
+local function test_allocation()
+  local vectors = {}
+  local vectors2 = {}
+  local numbers = {}
+  local locations = {}
+  for i = 1, num_objects do
+    vectors[i] = vec3(i, -i, runs)
+    vectors2[i] = vec2(runs, i)
+    numbers[i] = uint32_t(i * 7)
+    local loc = Location()
+    loc:lat(i)
+    loc:lng(-i)
+    locations[i] = loc
+  end
+  for i = 1, num_objects do
+    local v = vectors[i]
+    local v2 = vectors2[i]
+    if v:x() ~= i or v:y() ~= -i or v:z() ~= runs or v2:x() ~= runs or v2:y() ~= i or
+       numbers[i] ~= uint32_t(i * 7) or locations[i]:lat() ~= i or locations[i]:lng() ~= -i then
+      gcs:send_text(0, string.format("Failed userdata %d of run %d", i, runs))
+      return false
+    end
+  end
+  return true
+end
+
+function update()
+  local pass = test_inplace()
+  pass = test_allocation() and pass
+  runs = runs + 1
+  -- free everything so the next run reuses the pooled blocks
+  collectgarbage("collect")
+
+  if pass and runs >= 3 then
+    gcs:send_text(3, "Userdata tests passed")
+  end
+  return update, loop_time
+end
+
+return update()
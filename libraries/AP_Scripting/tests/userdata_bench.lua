@@ -0,0 +1,77 @@
+-- benchmark of userdata heavy operations, reporting operations per second for each case
+-- each case is run in short batches so the script stays well within its time slot
+
+local loop_time = 100 -- number of ms between runs
+local batch = 200 -- operations per batch
+local run_time_ms = 2000 -- time to spend on each case
+
+local a = Vector3f()
+local b = Vector3f()
+b:x(1)
+b:y(2)
+b:z(3)
+local c = Vector2f()
+local d = Vector2f()
+d:x(1)
+d:y(2)
+local n = uint32_t(0)
+
+local cases = {
+  { "Vector3f a + b", function() for _ = 1, batch do a = a + b end end },
+  { "Vector3f a:add(b)", function() for _ = 1, batch do a:add(b) end end },
+  { "Vector2f c + d", function() for _ = 1, batch do c = c + d end end },
+  { "Vector2f c:add(d)", function() for _ = 1, batch do c:add(d) end end },
+  { "uint32_t n + 1", function() for _ = 1, batch do n = n + 1 end end },
+  { "Vector3f()", function() for _ = 1, batch do local _ = Vector3f() end end },
+}
+
+-- the in-place methods must give the same result as the operators
+local function check_inplace()
+  local v = Vector3f()
+  v:x(1)
+  local sum = v + b
+  v:add(b)
+  local diff = v - b
+  if v ~= v:sub(b) then
+    return false
+  end
+  return (sum:x() == 2) and (sum:z() == 3) and (diff:x() == v:x()) and (v:x() == 1) and (v:z() == 0)
+end
+
+local case = 1
+local ops = 0
+local elapsed_us = uint32_t(0)
+local start_ms
+
+local function update()
+  if case > #cases then
+    gcs:send_text(6, "userdata bench: done")
+    return
+  end
+  if start_ms == nil then
+    start_ms = millis()
+  end
+
+  local t0 = micros()
+  cases[case][2]()
+  elapsed_us = elapsed_us + (micros() - t0)
+  ops = ops + batch
+
+  if (millis() - start_ms):toint() >= run_time_ms then
+    local us = elapsed_us:toint()
+    gcs:send_text(6, string.format("userdata bench: %s %.0f ops/s", cases[case][1], ops * 1.0e6 / math.max(us, 1)))
+    case = case + 1
+    ops = 0
+    elapsed_us = uint32_t(0)
+    start_ms = nil
+    collectgarbage("collect")
+  end
+  return update, loop_time
+end
+
+if not check_inplace() then
+  gcs:send_text(0, "userdata bench: in-place operators failed")
+  return
+end
+gcs:send_text(6, "userdata bench: starting")
+return update()
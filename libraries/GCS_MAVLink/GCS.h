@@ -16,6 +16,7 @@
 #include "MAVLink_routing.h"
 #include <AP_RTC/JitterCorrection.h>
 #include <AP_Common/Bitmask.h>
+#include <AP_Common/ExpandingString.h>
 #include <AP_LTM_Telem/AP_LTM_Telem.h>
 #include <AP_Devo_Telem/AP_Devo_Telem.h>
 #include <AP_Filesystem/AP_Filesystem_config.h>
@@ -114,6 +115,9 @@ public:
 
     // saveable rate of each stream
     AP_Int16        streamRates[GCS_MAVLINK_NUM_STREAM_RATES];
+
+    // transmit bandwidth budget in bytes/second, 0 to disable
+    AP_Int32        tx_budget;
 };
 
 #if HAL_MAVLINK_INTERVALS_FROM_FILES_ENABLED
@@ -228,6 +232,19 @@ public:
     // this is called when we discover we'd like to send something but can't:
     void out_of_space_to_send() { out_of_space_to_send_count++; }
 
+    // this is called for every chunk of bytes written to our port,
+    // with the channel lock held:
+    void note_bytes_written(uint16_t nbytes) { tx_bw.bytes_written += nbytes; }
+
+    // filtered estimate of bytes/second written to our port
+    uint32_t tx_bytes_per_second() const { return tx_bw.estimate_bps; }
+
+#if AP_MAVLINK_SEND_RATE_STATS_ENABLED
+    // write the requested and achieved send intervals and routing
+    // counts of this link
+    void send_rate_info(ExpandingString &str);
+#endif
+
     void send_mission_ack(const mavlink_message_t &msg,
                           MAV_MISSION_TYPE mission_type,
                           MAV_MISSION_RESULT result) const {
@@ -514,6 +531,9 @@ protected:
     // saveable rate of each stream
     AP_Int16        *streamRates;
 
+    // transmit bandwidth budget in bytes/second
+    AP_Int32        *tx_budget;
+
     void handle_heartbeat(const mavlink_message_t &msg) const;
 
     virtual bool persist_streamrates() const { return false; }
@@ -881,6 +901,7 @@ private:
     // try_send_message, will cause a mavlink message with that id to
     // be emitted.  Returns MSG_LAST if no such mapping exists.
     ap_message mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const;
+    static uint32_t ap_message_id_to_mavlink_id(const ap_message id);
     // set the interval at which an ap_message should be emitted (in ms)
     bool set_ap_message_interval(enum ap_message id, uint16_t interval_ms);
     // call set_ap_message_interval for each entry in a stream,
@@ -905,6 +926,50 @@ private:
 
     bool do_try_send_message(const ap_message id);
 
+    /*
+      transmit bandwidth scheduling. When a budget is configured the
+      traffic classes below share it in proportion to their weight
+      using deficit round robin; classes that are idle give their
+      share to the active ones.
+     */
+    enum class TxClass : uint8_t {
+        STREAMS = 0,    // stream-rated messages in deferred buckets
+        PARAMS  = 1,    // PARAM_VALUE replies to a parameter download
+        FTP     = 2,    // FILE_TRANSFER_PROTOCOL replies
+        NUM_CLASSES
+    };
+    // returns true if traffic class c may send now; marks c active
+    bool tx_budget_available(TxClass c);
+    // charge bytes sent by traffic class c against its share
+    void tx_budget_charge(TxClass c, uint16_t nbytes);
+    // refill class shares and update the bandwidth estimate
+    void update_tx_budget();
+    // receive throughput statistics
+    struct {
+        uint32_t bytes;
+        uint32_t bytes_skipped;
+    } rx_stats;
+
+    struct {
+        uint32_t bytes_written;             // running total, wraps
+        uint32_t estimate_last_bytes;
+        uint32_t estimate_last_ms;
+        uint32_t estimate_bps;
+        uint32_t refill_last_ms;
+        int32_t deficit[uint8_t(TxClass::NUM_CLASSES)];
+        uint32_t last_active_ms[uint8_t(TxClass::NUM_CLASSES)];
+    } tx_bw;
+
+#if AP_MAVLINK_SEND_RATE_STATS_ENABLED
+    // achieved send interval of each ap_message, for comparison with
+    // the requested interval
+    struct {
+        uint16_t last_sent_ms;              // from AP_HAL::millis16()
+        uint16_t interval_ms;               // filtered achieved interval
+    } send_rate_stats[MSG_LAST];
+    void update_send_rate_stats(ap_message id);
+#endif
+
     // time when we missed sending a parameter for GCS
     static uint32_t reserve_param_space_start_ms;
     
@@ -1187,6 +1252,11 @@ public:
     virtual const GCS_MAVLINK *chan(const uint8_t ofs) const = 0;
     // return the number of valid GCS objects
     uint8_t num_gcs() const { return _num_gcs; };
+
+#if AP_MAVLINK_SEND_RATE_STATS_ENABLED
+    // write the achieved send intervals of all links
+    void send_rate_info(ExpandingString &str);
+#endif
     void send_message(enum ap_message id);
     void send_mission_item_reached_message(uint16_t mission_index);
     void send_named_float(const char *name, float value) const;
@@ -134,6 +134,7 @@ GCS_MAVLINK::GCS_MAVLINK(GCS_MAVLINK_Parameters &parameters,
     _port = &uart;
 
     streamRates = parameters.streamRates;
+    tx_budget = &parameters.tx_budget;
 }
 
 bool GCS_MAVLINK::init(uint8_t instance)
@@ -975,161 +976,175 @@ void GCS_MAVLINK::handle_mission_item(const mavlink_message_t &msg)
     prot->handle_mission_item(msg, mission_item_int);
 }
 
-ap_message GCS_MAVLINK::mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const
-{
-    // MSG_NEXT_MISSION_REQUEST doesn't correspond to a mavlink message directly.
-    // It is used to request the next waypoint after receiving one.
+/*
+  map between MAVLink message IDs and ap_message IDs
 
-    // MSG_NEXT_PARAM doesn't correspond to a mavlink message directly.
-    // It is used to send the next parameter in a stream after sending one
+  MSG_NEXT_MISSION_REQUEST doesn't correspond to a mavlink message directly.
+  It is used to request the next waypoint after receiving one.
 
-    // MSG_NAMED_FLOAT messages can't really be "streamed"...
+  MSG_NEXT_PARAM doesn't correspond to a mavlink message directly.
+  It is used to send the next parameter in a stream after sending one
 
-    static const struct {
-        uint32_t mavlink_id;
-        ap_message msg_id;
-    } map[] {
-        { MAVLINK_MSG_ID_HEARTBEAT,             MSG_HEARTBEAT},
-        { MAVLINK_MSG_ID_HOME_POSITION,         MSG_HOME},
-        { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,     MSG_ORIGIN},
-        { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS},
-        { MAVLINK_MSG_ID_POWER_STATUS,          MSG_POWER_STATUS},
+  MSG_NAMED_FLOAT messages can't really be "streamed"...
+ */
+static const struct {
+    uint32_t mavlink_id;
+    ap_message msg_id;
+} ap_message_map[] {
+    { MAVLINK_MSG_ID_HEARTBEAT,             MSG_HEARTBEAT},
+    { MAVLINK_MSG_ID_HOME_POSITION,         MSG_HOME},
+    { MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN,     MSG_ORIGIN},
+    { MAVLINK_MSG_ID_SYS_STATUS,            MSG_SYS_STATUS},
+    { MAVLINK_MSG_ID_POWER_STATUS,          MSG_POWER_STATUS},
 #if HAL_WITH_MCU_MONITORING
-        { MAVLINK_MSG_ID_MCU_STATUS,            MSG_MCU_STATUS},
-#endif
-        { MAVLINK_MSG_ID_MEMINFO,               MSG_MEMINFO},
-        { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT},
-        { MAVLINK_MSG_ID_MISSION_CURRENT,       MSG_CURRENT_WAYPOINT},
-        { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW},
-        { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS},
-        { MAVLINK_MSG_ID_RC_CHANNELS_RAW,       MSG_RC_CHANNELS_RAW},
-        { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU},
-        { MAVLINK_MSG_ID_SCALED_IMU,            MSG_SCALED_IMU},
-        { MAVLINK_MSG_ID_SCALED_IMU2,           MSG_SCALED_IMU2},
-        { MAVLINK_MSG_ID_SCALED_IMU3,           MSG_SCALED_IMU3},
+    { MAVLINK_MSG_ID_MCU_STATUS,            MSG_MCU_STATUS},
+#endif
+    { MAVLINK_MSG_ID_MEMINFO,               MSG_MEMINFO},
+    { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, MSG_NAV_CONTROLLER_OUTPUT},
+    { MAVLINK_MSG_ID_MISSION_CURRENT,       MSG_CURRENT_WAYPOINT},
+    { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      MSG_SERVO_OUTPUT_RAW},
+    { MAVLINK_MSG_ID_RC_CHANNELS,           MSG_RC_CHANNELS},
+    { MAVLINK_MSG_ID_RC_CHANNELS_RAW,       MSG_RC_CHANNELS_RAW},
+    { MAVLINK_MSG_ID_RAW_IMU,               MSG_RAW_IMU},
+    { MAVLINK_MSG_ID_SCALED_IMU,            MSG_SCALED_IMU},
+    { MAVLINK_MSG_ID_SCALED_IMU2,           MSG_SCALED_IMU2},
+    { MAVLINK_MSG_ID_SCALED_IMU3,           MSG_SCALED_IMU3},
 #if AP_MAVLINK_MSG_HIGHRES_IMU_ENABLED
-        { MAVLINK_MSG_ID_HIGHRES_IMU,           MSG_HIGHRES_IMU},
+    { MAVLINK_MSG_ID_HIGHRES_IMU,           MSG_HIGHRES_IMU},
 #endif
-        { MAVLINK_MSG_ID_SCALED_PRESSURE,       MSG_SCALED_PRESSURE},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE2,      MSG_SCALED_PRESSURE2},
-        { MAVLINK_MSG_ID_SCALED_PRESSURE3,      MSG_SCALED_PRESSURE3},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE,       MSG_SCALED_PRESSURE},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE2,      MSG_SCALED_PRESSURE2},
+    { MAVLINK_MSG_ID_SCALED_PRESSURE3,      MSG_SCALED_PRESSURE3},
 #if AP_GPS_ENABLED
-        { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW},
-        { MAVLINK_MSG_ID_GPS_RTK,               MSG_GPS_RTK},
+    { MAVLINK_MSG_ID_GPS_RAW_INT,           MSG_GPS_RAW},
+    { MAVLINK_MSG_ID_GPS_RTK,               MSG_GPS_RTK},
 #if GPS_MAX_RECEIVERS > 1
-        { MAVLINK_MSG_ID_GPS2_RAW,              MSG_GPS2_RAW},
-        { MAVLINK_MSG_ID_GPS2_RTK,              MSG_GPS2_RTK},
+    { MAVLINK_MSG_ID_GPS2_RAW,              MSG_GPS2_RAW},
+    { MAVLINK_MSG_ID_GPS2_RTK,              MSG_GPS2_RTK},
 #endif
 #endif
-        { MAVLINK_MSG_ID_SYSTEM_TIME,           MSG_SYSTEM_TIME},
-        { MAVLINK_MSG_ID_RC_CHANNELS_SCALED,    MSG_SERVO_OUT},
-        { MAVLINK_MSG_ID_PARAM_VALUE,           MSG_NEXT_PARAM},
+    { MAVLINK_MSG_ID_SYSTEM_TIME,           MSG_SYSTEM_TIME},
+    { MAVLINK_MSG_ID_RC_CHANNELS_SCALED,    MSG_SERVO_OUT},
+    { MAVLINK_MSG_ID_PARAM_VALUE,           MSG_NEXT_PARAM},
 #if AP_FENCE_ENABLED
-        { MAVLINK_MSG_ID_FENCE_STATUS,          MSG_FENCE_STATUS},
+    { MAVLINK_MSG_ID_FENCE_STATUS,          MSG_FENCE_STATUS},
 #endif
 #if AP_SIM_ENABLED
-        { MAVLINK_MSG_ID_SIMSTATE,              MSG_SIMSTATE},
-        { MAVLINK_MSG_ID_SIM_STATE,             MSG_SIM_STATE},
+    { MAVLINK_MSG_ID_SIMSTATE,              MSG_SIMSTATE},
+    { MAVLINK_MSG_ID_SIM_STATE,             MSG_SIM_STATE},
 #endif
 #if AP_AHRS_ENABLED
-        { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2},
-        { MAVLINK_MSG_ID_AHRS,                  MSG_AHRS},
-        { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE},
-        { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,   MSG_ATTITUDE_QUATERNION},
-        { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION},
-        { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    MSG_LOCAL_POSITION},
-        { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD},
-#endif
-        { MAVLINK_MSG_ID_HWSTATUS,              MSG_HWSTATUS},
-        { MAVLINK_MSG_ID_WIND,                  MSG_WIND},
+    { MAVLINK_MSG_ID_AHRS2,                 MSG_AHRS2},
+    { MAVLINK_MSG_ID_AHRS,                  MSG_AHRS},
+    { MAVLINK_MSG_ID_ATTITUDE,              MSG_ATTITUDE},
+    { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,   MSG_ATTITUDE_QUATERNION},
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   MSG_LOCATION},
+    { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    MSG_LOCAL_POSITION},
+    { MAVLINK_MSG_ID_VFR_HUD,               MSG_VFR_HUD},
+#endif
+    { MAVLINK_MSG_ID_HWSTATUS,              MSG_HWSTATUS},
+    { MAVLINK_MSG_ID_WIND,                  MSG_WIND},
 #if AP_RANGEFINDER_ENABLED
-        { MAVLINK_MSG_ID_RANGEFINDER,           MSG_RANGEFINDER},
+    { MAVLINK_MSG_ID_RANGEFINDER,           MSG_RANGEFINDER},
 #endif
-        { MAVLINK_MSG_ID_DISTANCE_SENSOR,       MSG_DISTANCE_SENSOR},
-            // request also does report:
-        { MAVLINK_MSG_ID_TERRAIN_REQUEST,       MSG_TERRAIN},
+    { MAVLINK_MSG_ID_DISTANCE_SENSOR,       MSG_DISTANCE_SENSOR},
+        // request also does report:
+    { MAVLINK_MSG_ID_TERRAIN_REQUEST,       MSG_TERRAIN},
 #if AP_MAVLINK_BATTERY2_ENABLED
-        { MAVLINK_MSG_ID_BATTERY2,              MSG_BATTERY2},
+    { MAVLINK_MSG_ID_BATTERY2,              MSG_BATTERY2},
 #endif
 #if AP_CAMERA_ENABLED
-        { MAVLINK_MSG_ID_CAMERA_FEEDBACK,       MSG_CAMERA_FEEDBACK},
-        { MAVLINK_MSG_ID_CAMERA_INFORMATION,    MSG_CAMERA_INFORMATION},
-        { MAVLINK_MSG_ID_CAMERA_SETTINGS,       MSG_CAMERA_SETTINGS},
-        { MAVLINK_MSG_ID_CAMERA_FOV_STATUS,     MSG_CAMERA_FOV_STATUS},
-        { MAVLINK_MSG_ID_CAMERA_CAPTURE_STATUS, MSG_CAMERA_CAPTURE_STATUS},
+    { MAVLINK_MSG_ID_CAMERA_FEEDBACK,       MSG_CAMERA_FEEDBACK},
+    { MAVLINK_MSG_ID_CAMERA_INFORMATION,    MSG_CAMERA_INFORMATION},
+    { MAVLINK_MSG_ID_CAMERA_SETTINGS,       MSG_CAMERA_SETTINGS},
+    { MAVLINK_MSG_ID_CAMERA_FOV_STATUS,     MSG_CAMERA_FOV_STATUS},
+    { MAVLINK_MSG_ID_CAMERA_CAPTURE_STATUS, MSG_CAMERA_CAPTURE_STATUS},
 #endif
 #if HAL_MOUNT_ENABLED
-        { MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, MSG_GIMBAL_DEVICE_ATTITUDE_STATUS},
-        { MAVLINK_MSG_ID_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE, MSG_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE},
-        { MAVLINK_MSG_ID_GIMBAL_MANAGER_INFORMATION, MSG_GIMBAL_MANAGER_INFORMATION},
-        { MAVLINK_MSG_ID_GIMBAL_MANAGER_STATUS, MSG_GIMBAL_MANAGER_STATUS},
+    { MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, MSG_GIMBAL_DEVICE_ATTITUDE_STATUS},
+    { MAVLINK_MSG_ID_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE, MSG_AUTOPILOT_STATE_FOR_GIMBAL_DEVICE},
+    { MAVLINK_MSG_ID_GIMBAL_MANAGER_INFORMATION, MSG_GIMBAL_MANAGER_INFORMATION},
+    { MAVLINK_MSG_ID_GIMBAL_MANAGER_STATUS, MSG_GIMBAL_MANAGER_STATUS},
 #endif
 #if AP_OPTICALFLOW_ENABLED
-        { MAVLINK_MSG_ID_OPTICAL_FLOW,          MSG_OPTICAL_FLOW},
+    { MAVLINK_MSG_ID_OPTICAL_FLOW,          MSG_OPTICAL_FLOW},
 #endif
 #if COMPASS_CAL_ENABLED
-        { MAVLINK_MSG_ID_MAG_CAL_PROGRESS,      MSG_MAG_CAL_PROGRESS},
-        { MAVLINK_MSG_ID_MAG_CAL_REPORT,        MSG_MAG_CAL_REPORT},
+    { MAVLINK_MSG_ID_MAG_CAL_PROGRESS,      MSG_MAG_CAL_PROGRESS},
+    { MAVLINK_MSG_ID_MAG_CAL_REPORT,        MSG_MAG_CAL_REPORT},
 #endif
-        { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT},
-        { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING},
-        { MAVLINK_MSG_ID_VIBRATION,             MSG_VIBRATION},
+    { MAVLINK_MSG_ID_EKF_STATUS_REPORT,     MSG_EKF_STATUS_REPORT},
+    { MAVLINK_MSG_ID_PID_TUNING,            MSG_PID_TUNING},
+    { MAVLINK_MSG_ID_VIBRATION,             MSG_VIBRATION},
 #if AP_RPM_ENABLED
-        { MAVLINK_MSG_ID_RPM,                   MSG_RPM},
+    { MAVLINK_MSG_ID_RPM,                   MSG_RPM},
 #endif
-        { MAVLINK_MSG_ID_MISSION_ITEM_REACHED,  MSG_MISSION_ITEM_REACHED},
-        { MAVLINK_MSG_ID_ATTITUDE_TARGET,       MSG_ATTITUDE_TARGET},
-        { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,  MSG_POSITION_TARGET_GLOBAL_INT},
-        { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,  MSG_POSITION_TARGET_LOCAL_NED},
+    { MAVLINK_MSG_ID_MISSION_ITEM_REACHED,  MSG_MISSION_ITEM_REACHED},
+    { MAVLINK_MSG_ID_ATTITUDE_TARGET,       MSG_ATTITUDE_TARGET},
+    { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,  MSG_POSITION_TARGET_GLOBAL_INT},
+    { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,  MSG_POSITION_TARGET_LOCAL_NED},
 #if HAL_ADSB_ENABLED
-        { MAVLINK_MSG_ID_ADSB_VEHICLE,          MSG_ADSB_VEHICLE},
+    { MAVLINK_MSG_ID_ADSB_VEHICLE,          MSG_ADSB_VEHICLE},
 #endif
 #if AP_BATTERY_ENABLED
-        { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS},
+    { MAVLINK_MSG_ID_BATTERY_STATUS,        MSG_BATTERY_STATUS},
 #endif
-        { MAVLINK_MSG_ID_AOA_SSA,               MSG_AOA_SSA},
+    { MAVLINK_MSG_ID_AOA_SSA,               MSG_AOA_SSA},
 #if HAL_LANDING_DEEPSTALL_ENABLED
-        { MAVLINK_MSG_ID_DEEPSTALL,             MSG_LANDING},
+    { MAVLINK_MSG_ID_DEEPSTALL,             MSG_LANDING},
 #endif
-        { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    MSG_EXTENDED_SYS_STATE},
-        { MAVLINK_MSG_ID_AUTOPILOT_VERSION,     MSG_AUTOPILOT_VERSION},
+    { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,    MSG_EXTENDED_SYS_STATE},
+    { MAVLINK_MSG_ID_AUTOPILOT_VERSION,     MSG_AUTOPILOT_VERSION},
 #if HAL_EFI_ENABLED
-        { MAVLINK_MSG_ID_EFI_STATUS,            MSG_EFI_STATUS},
+    { MAVLINK_MSG_ID_EFI_STATUS,            MSG_EFI_STATUS},
 #endif
 #if HAL_GENERATOR_ENABLED
-        { MAVLINK_MSG_ID_GENERATOR_STATUS,      MSG_GENERATOR_STATUS},
+    { MAVLINK_MSG_ID_GENERATOR_STATUS,      MSG_GENERATOR_STATUS},
 #endif
 #if AP_WINCH_ENABLED
-        { MAVLINK_MSG_ID_WINCH_STATUS,          MSG_WINCH_STATUS},
+    { MAVLINK_MSG_ID_WINCH_STATUS,          MSG_WINCH_STATUS},
 #endif
 #if HAL_WITH_ESC_TELEM
-        { MAVLINK_MSG_ID_ESC_TELEMETRY_1_TO_4,  MSG_ESC_TELEMETRY},
+    { MAVLINK_MSG_ID_ESC_TELEMETRY_1_TO_4,  MSG_ESC_TELEMETRY},
 #endif
 #if AP_RANGEFINDER_ENABLED && APM_BUILD_TYPE(APM_BUILD_Rover)
-        { MAVLINK_MSG_ID_WATER_DEPTH,           MSG_WATER_DEPTH},
+    { MAVLINK_MSG_ID_WATER_DEPTH,           MSG_WATER_DEPTH},
 #endif
 #if HAL_HIGH_LATENCY2_ENABLED
-        { MAVLINK_MSG_ID_HIGH_LATENCY2,         MSG_HIGH_LATENCY2},
+    { MAVLINK_MSG_ID_HIGH_LATENCY2,         MSG_HIGH_LATENCY2},
 #endif
 #if AP_AIS_ENABLED
-        { MAVLINK_MSG_ID_AIS_VESSEL,            MSG_AIS_VESSEL},
+    { MAVLINK_MSG_ID_AIS_VESSEL,            MSG_AIS_VESSEL},
 #endif
 #if AP_MAVLINK_MSG_UAVIONIX_ADSB_OUT_STATUS_ENABLED
-        { MAVLINK_MSG_ID_UAVIONIX_ADSB_OUT_STATUS, MSG_UAVIONIX_ADSB_OUT_STATUS},
+    { MAVLINK_MSG_ID_UAVIONIX_ADSB_OUT_STATUS, MSG_UAVIONIX_ADSB_OUT_STATUS},
 #endif
 #if AP_MAVLINK_MSG_RELAY_STATUS_ENABLED
-        { MAVLINK_MSG_ID_RELAY_STATUS, MSG_RELAY_STATUS},
+    { MAVLINK_MSG_ID_RELAY_STATUS, MSG_RELAY_STATUS},
 #endif
-            };
+};
 
-    for (uint8_t i=0; i<ARRAY_SIZE(map); i++) {
-        if (map[i].mavlink_id == mavlink_id) {
-            return map[i].msg_id;
+ap_message GCS_MAVLINK::mavlink_id_to_ap_message_id(const uint32_t mavlink_id) const
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(ap_message_map); i++) {
+        if (ap_message_map[i].mavlink_id == mavlink_id) {
+            return ap_message_map[i].msg_id;
         }
     }
     return MSG_LAST;
 }
 
+// returns the MAVLink message ID for an ap_message, or UINT32_MAX if there is none
+uint32_t GCS_MAVLINK::ap_message_id_to_mavlink_id(const ap_message id)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(ap_message_map); i++) {
+        if (ap_message_map[i].msg_id == id) {
+            return ap_message_map[i].mavlink_id;
+        }
+    }
+    return UINT32_MAX;
+}
+
 bool GCS_MAVLINK::set_mavlink_message_id_interval(const uint32_t mavlink_id,
                                                   const uint16_t interval_ms)
 {
@@ -1191,6 +1206,148 @@ uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const deferred_message_bucket_t
     return interval_ms;
 }
 
+/*
+  update the transmit bandwidth estimate and refill the share of the
+  transmit budget held by each traffic class
+ */
+void GCS_MAVLINK::update_tx_budget()
+{
+    const uint32_t now_ms = AP_HAL::millis();
+
+    // bytes_written is updated by any thread sending on this link,
+    // and the class shares by the parameter and FTP threads
+    WITH_SEMAPHORE(comm_chan_lock(chan));
+
+    // bandwidth estimate, filtered over roughly one second
+    const uint32_t estimate_dt_ms = now_ms - tx_bw.estimate_last_ms;
+    if (estimate_dt_ms >= 200) {
+        const uint32_t bytes = tx_bw.bytes_written - tx_bw.estimate_last_bytes;
+        const uint32_t bps = uint64_t(bytes) * 1000U / estimate_dt_ms;
+        tx_bw.estimate_bps = (tx_bw.estimate_bps * 3 + bps) / 4;
+        tx_bw.estimate_last_bytes = tx_bw.bytes_written;
+        tx_bw.estimate_last_ms = now_ms;
+    }
+
+    const uint32_t refill_dt_ms = now_ms - tx_bw.refill_last_ms;
+    tx_bw.refill_last_ms = now_ms;
+    const int32_t budget = tx_budget->get();
+    if (budget <= 0 || refill_dt_ms == 0) {
+        return;
+    }
+
+    // relative share of the budget given to each class when active
+    static const uint8_t weights[uint8_t(TxClass::NUM_CLASSES)] { 2, 1, 1 };
+
+    // a class is active if it has wanted to send recently
+    const uint32_t active_timeout_ms = 200;
+    uint8_t active_weight = 0;
+    for (uint8_t i=0; i<ARRAY_SIZE(weights); i++) {
+        if (now_ms - tx_bw.last_active_ms[i] < active_timeout_ms) {
+            active_weight += weights[i];
+        }
+    }
+    if (active_weight == 0) {
+        return;
+    }
+
+    // allow for bursts of up to 200ms of budget, but always enough
+    // for a maximum size packet
+    const int32_t max_deficit = MAX(budget / 5, int32_t(MAVLINK_MAX_PACKET_LEN));
+    const uint32_t refill = MIN(uint64_t(budget) * refill_dt_ms / 1000U, uint32_t(max_deficit));
+
+    for (uint8_t i=0; i<ARRAY_SIZE(weights); i++) {
+        if (now_ms - tx_bw.last_active_ms[i] >= active_timeout_ms) {
+            // idle classes may not hoard budget, but keep their debt
+            tx_bw.deficit[i] = MIN(tx_bw.deficit[i], 0);
+            continue;
+        }
+        tx_bw.deficit[i] += refill * weights[i] / active_weight;
+        tx_bw.deficit[i] = MIN(tx_bw.deficit[i], max_deficit);
+    }
+}
+
+/*
+  returns true if the transmit budget allows traffic class c to send
+ */
+bool GCS_MAVLINK::tx_budget_available(TxClass c)
+{
+    if (tx_budget->get() <= 0) {
+        return true;
+    }
+    WITH_SEMAPHORE(comm_chan_lock(chan));
+    tx_bw.last_active_ms[uint8_t(c)] = AP_HAL::millis();
+    return tx_bw.deficit[uint8_t(c)] > 0;
+}
+
+/*
+  charge bytes sent against a traffic class. The share may go
+  negative, in which case the class waits until it is refilled
+ */
+void GCS_MAVLINK::tx_budget_charge(TxClass c, uint16_t nbytes)
+{
+    if (tx_budget->get() <= 0) {
+        return;
+    }
+    WITH_SEMAPHORE(comm_chan_lock(chan));
+    tx_bw.deficit[uint8_t(c)] -= nbytes;
+}
+
+#if AP_MAVLINK_SEND_RATE_STATS_ENABLED
+/*
+  update the achieved send interval of a message
+ */
+void GCS_MAVLINK::update_send_rate_stats(ap_message id)
+{
+    const uint16_t now16_ms = AP_HAL::millis16();
+    auto &stats = send_rate_stats[id];
+    if (stats.last_sent_ms != 0) {
+        const uint16_t interval_ms = now16_ms - stats.last_sent_ms;
+        if (stats.interval_ms == 0) {
+            stats.interval_ms = interval_ms;
+        } else {
+            stats.interval_ms = (uint32_t(stats.interval_ms) * 7 + interval_ms) / 8;
+        }
+    }
+    stats.last_sent_ms = now16_ms;
+}
+
+/*
+  write the requested and achieved interval of each message sent on
+  this link, and the packets routed onto it from other links
+ */
+void GCS_MAVLINK::send_rate_info(ExpandingString &str)
+{
+    uint32_t forwarded, dropped;
+    routing.get_chan_stats(chan, forwarded, dropped);
+    str.printf("chan %u: %u bytes/s forwarded %u dropped %u\n", unsigned(chan),
+               unsigned(tx_bytes_per_second()), unsigned(forwarded), unsigned(dropped));
+    for (uint16_t i=0; i<MSG_LAST; i++) {
+        const ap_message id = ap_message(i);
+        const uint16_t achieved_ms = send_rate_stats[id].interval_ms;
+        const uint32_t mavlink_id = ap_message_id_to_mavlink_id(id);
+        if (achieved_ms == 0 || mavlink_id == UINT32_MAX) {
+            continue;
+        }
+        uint16_t interval_ms = 0;
+        if (!get_ap_message_interval(id, interval_ms)) {
+            interval_ms = 0;
+        }
+        str.printf("  msg %-6u interval %5ums achieved %5ums\n",
+                   unsigned(mavlink_id), unsigned(interval_ms), unsigned(achieved_ms));
+    }
+}
+
+void GCS::send_rate_info(ExpandingString &str)
+{
+    for (uint8_t i=0; i<num_gcs(); i++) {
+        GCS_MAVLINK *c = chan(i);
+        if (c != nullptr) {
+            c->send_rate_info(str);
+        }
+    }
+}
+#endif
+
 // typical runtime on fmuv3: 5 microseconds for 3 buckets
 void GCS_MAVLINK::find_next_bucket_to_send(uint16_t now16_ms)
 {
@@ -1286,6 +1443,9 @@ bool GCS_MAVLINK::do_try_send_message(const ap_message id)
 #endif
         return false;
     }
+#if AP_MAVLINK_SEND_RATE_STATS_ENABLED
+    update_send_rate_stats(id);
+#endif
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     const uint32_t delta_us = AP_HAL::micros() - start_send_message_us;
     hal.scheduler->restore_interrupts(data);
@@ -1494,6 +1654,8 @@ void GCS_MAVLINK::update_send()
     // check for any in-progress tasks; check_tasks does its own rate-limiting
     GCS_MAVLINK_InProgress::check_tasks();
 
+    update_tx_budget();
+
     const uint32_t start = AP_HAL::millis();
     const uint16_t start16 = start & 0xFFFF;
     while (AP_HAL::millis() - start < 5) { // spend a max of 5ms sending messages.  This should never trigger - out_of_time() should become true
@@ -1558,9 +1720,14 @@ void GCS_MAVLINK::update_send()
 
         ap_message next = next_deferred_bucket_message_to_send(start16);
         if (next != no_message_to_send) {
+            if (!tx_budget_available(TxClass::STREAMS)) {
+                break;
+            }
+            const uint32_t bytes_before = tx_bw.bytes_written;
             if (!do_try_send_message(next)) {
                 break;
             }
+            tx_budget_charge(TxClass::STREAMS, tx_bw.bytes_written - bytes_before);
             bucket_message_ids_to_send.clear(next);
             if (bucket_message_ids_to_send.count() == 0) {
                 // we sent everything in the bucket.  Reschedule it.
@@ -1805,6 +1972,42 @@ void GCS_MAVLINK::packetReceived(const mavlink_status_t &status,
     handle_message(msg);
 }
 
+/*
+  length-based framing for a candidate frame starting at a start of
+  frame byte. Returns the total length of the frame including CRC and
+  signature, 0 if the header shows the start byte can't be the start
+  of a frame we would accept, or -1 if the header is not complete yet
+ */
+static int16_t mavlink_candidate_frame_length(const uint8_t *buf, uint16_t len)
+{
+    const bool mavlink1 = buf[0] == MAVLINK_STX_MAVLINK1;
+    const uint8_t header_len = mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN+1 : MAVLINK_NUM_HEADER_BYTES;
+    if (len < header_len) {
+        return -1;
+    }
+    const uint8_t payload_len = buf[1];
+    uint8_t signature_len = 0;
+    if (mavlink1) {
+        // MAVLink1 always carries the full base payload
+        const mavlink_msg_entry_t *e = mavlink_get_msg_entry(buf[5]);
+        if (e != nullptr && payload_len < e->min_msg_len) {
+            return 0;
+        }
+    } else {
+        // MAVLink2 frames are only bounded by the header, as newer
+        // dialects may send extension fields we don't know about
+        const uint8_t incompat_flags = buf[2];
+        if (incompat_flags & ~MAVLINK_IFLAG_MASK) {
+            // the parser would reject this frame
+            return 0;
+        }
+        if (incompat_flags & MAVLINK_IFLAG_SIGNED) {
+            signature_len = MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+    }
+    return header_len + payload_len + MAVLINK_NUM_CHECKSUM_BYTES + signature_len;
+}
+
 void
 GCS_MAVLINK::update_receive(uint32_t max_time_us)
 {
@@ -1822,50 +2025,96 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
     status.packet_rx_drop_count = 0;
 
     const uint16_t nbytes = _port->available();
-    for (uint16_t i=0; i<nbytes; i++)
-    {
-        const uint8_t c = (uint8_t)_port->read();
-        const uint32_t protocol_timeout = 4000;
-        
-        if (alternative.handler &&
-            now_ms - alternative.last_mavlink_ms > protocol_timeout) {
-            /*
-              we have an alternative protocol handler installed and we
-              haven't parsed a MAVLink packet for 4 seconds. Try
-              parsing using alternative handler
-             */
-            if (alternative.handler(c, mavlink_comm_port[chan])) {
-                alternative.last_alternate_ms = now_ms;
-                gcs_alternative_active[chan] = true;
+    uint16_t nread = 0;
+    bool out_of_time = false;
+    while (nread < nbytes && !out_of_time) {
+        // read in blocks rather than making a call into the UART
+        // driver for every byte
+        uint8_t buf[128];
+        const ssize_t n = _port->read(buf, MIN(uint16_t(sizeof(buf)), uint16_t(nbytes - nread)));
+        if (n <= 0) {
+            break;
+        }
+        nread += n;
+        rx_stats.bytes += n;
+
+        // all bytes read must be parsed, so the time limit is only
+        // checked between blocks
+        for (uint16_t i=0; i<n; i++) {
+            const uint8_t c = buf[i];
+            const uint32_t protocol_timeout = 4000;
+
+            if (alternative.handler &&
+                now_ms - alternative.last_mavlink_ms > protocol_timeout) {
+                /*
+                  we have an alternative protocol handler installed and we
+                  haven't parsed a MAVLink packet for 4 seconds. Try
+                  parsing using alternative handler
+                 */
+                if (alternative.handler(c, mavlink_comm_port[chan])) {
+                    alternative.last_alternate_ms = now_ms;
+                    gcs_alternative_active[chan] = true;
+                }
+
+                /*
+                  we may also try parsing as MAVLink if we haven't had a
+                  successful parse on the alternative protocol for 4s
+                 */
+                if (now_ms - alternative.last_alternate_ms <= protocol_timeout) {
+                    continue;
+                }
+            } else if (_channel_status.parse_state <= MAVLINK_PARSE_STATE_IDLE &&
+                       c != MAVLINK_STX && c != MAVLINK_STX_MAVLINK1) {
+                /*
+                  the parser is between frames and ignores anything
+                  but a start-of-frame byte, so scan ahead to the
+                  next one without calling the parser
+                 */
+                uint16_t j = i + 1;
+                while (j < n && buf[j] != MAVLINK_STX && buf[j] != MAVLINK_STX_MAVLINK1) {
+                    j++;
+                }
+                rx_stats.bytes_skipped += j - i;
+                i = j - 1;
+                continue;
             }
-            
+
             /*
-              we may also try parsing as MAVLink if we haven't had a
-              successful parse on the alternative protocol for 4s
+              at a start of frame byte use the header to frame the
+              packet: a header that can't be valid is skipped here
+              rather than letting the parser swallow the following
+              bytes as a bogus payload, and a frame that is complete
+              in the buffer is fed to the parser in one run
              */
-            if (now_ms - alternative.last_alternate_ms <= protocol_timeout) {
-                continue;
+            uint16_t count = 1;
+            if (_channel_status.parse_state <= MAVLINK_PARSE_STATE_IDLE &&
+                (c == MAVLINK_STX || c == MAVLINK_STX_MAVLINK1) &&
+                (!alternative.handler || now_ms - alternative.last_mavlink_ms <= protocol_timeout)) {
+                const int16_t frame_len = mavlink_candidate_frame_length(&buf[i], n - i);
+                if (frame_len == 0) {
+                    rx_stats.bytes_skipped++;
+                    continue;
+                }
+                if (frame_len > 0 && frame_len <= n - i) {
+                    count = frame_len;
+                }
             }
-        }
-
-        bool parsed_packet = false;
-
-        // Try to get a new message
-        if (mavlink_frame_char_buffer(channel_buffer(), channel_status(), c, &msg, &status) == MAVLINK_FRAMING_OK) {
-            hal.util->persistent_data.last_mavlink_msgid = msg.msgid;
-            packetReceived(status, msg);
-            parsed_packet = true;
-            gcs_alternative_active[chan] = false;
-            alternative.last_mavlink_ms = now_ms;
-            hal.util->persistent_data.last_mavlink_msgid = 0;
-        }
 
-        if (parsed_packet || i % 100 == 0) {
-            // make sure we don't spend too much time parsing mavlink messages
-            if (AP_HAL::micros() - tstart_us > max_time_us) {
-                break;
+            // Try to get a new message
+            for (uint16_t j=i; j<i+count; j++) {
+                if (mavlink_frame_char_buffer(channel_buffer(), channel_status(), buf[j], &msg, &status) == MAVLINK_FRAMING_OK) {
+                    hal.util->persistent_data.last_mavlink_msgid = msg.msgid;
+                    packetReceived(status, msg);
+                    gcs_alternative_active[chan] = false;
+                    alternative.last_mavlink_ms = now_ms;
+                    hal.util->persistent_data.last_mavlink_msgid = 0;
+                }
             }
+            i += count - 1;
         }
+
+        // make sure we don't spend too much time parsing mavlink messages
+        out_of_time = AP_HAL::micros() - tstart_us > max_time_us;
     }
 
     const uint32_t tnow = AP_HAL::millis();
@@ -2001,6 +2250,8 @@ void GCS_MAVLINK::log_mavlink_stats()
     flags                  : flags,
     stream_slowdown_ms     : stream_slowdown_ms,
     times_full             : out_of_space_to_send_count,
+    rx_bytes               : rx_stats.bytes,
+    rx_bytes_skipped       : rx_stats.bytes_skipped,
     };
 
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
@@ -101,6 +101,11 @@ bool GCS_MAVLINK::send_ftp_reply(const pending_ftp &reply)
         return false;
     }
     WITH_SEMAPHORE(comm_chan_lock(reply.chan));
+    // the reply may be for a different link to the one running the worker
+    GCS_MAVLINK *link = gcs().chan(reply.chan);
+    if (link != nullptr && !link->tx_budget_available(TxClass::FTP)) {
+        return false;
+    }
     if (!HAVE_PAYLOAD_SPACE(chan, FILE_TRANSFER_PROTOCOL)) {
         return false;
     }
@@ -117,6 +122,9 @@ bool GCS_MAVLINK::send_ftp_reply(const pending_ftp &reply)
         reply.chan,
         0, reply.sysid, reply.compid,
         payload);
+    if (link != nullptr) {
+        link->tx_budget_charge(TxClass::FTP, PAYLOAD_SIZE(reply.chan, FILE_TRANSFER_PROTOCOL));
+    }
     return true;
 }
 
@@ -491,17 +499,22 @@ void GCS_MAVLINK::ftp_worker(void) {
                           available bandwidth on links that don't have
                           flow control. This reduces the chance of
                           lost packets a lot, which results in overall
-                          faster transfers
+                          faster transfers. The delay is kept in
+                          microseconds and paced against a deadline
+                          so time spent reading the file counts
+                          towards it, and fast links are not slowed
+                          down by rounding to whole milliseconds
                          */
-                        uint32_t burst_delay_ms = 0;
+                        uint32_t burst_delay_us = 0;
                         if (valid_channel(request.chan)) {
                             auto *port = mavlink_comm_port[request.chan];
                             if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
-                                const uint32_t bw = port->bw_in_bytes_per_second();
+                                const uint32_t bw = MAX(port->bw_in_bytes_per_second(), 1U);
                                 const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
-                                burst_delay_ms = 3000 * pkt_size / bw;
+                                burst_delay_us = uint64_t(3000000U) * pkt_size / bw;
                             }
                         }
+                        uint32_t next_send_us = AP_HAL::micros();
 
                         // this transfer size is enough for a full parameter file with max parameters
                         const uint32_t transfer_size = 500;
@@ -538,7 +551,18 @@ void GCS_MAVLINK::ftp_worker(void) {
                             // prep the reply to be used again
                             reply.seq_number++;
 
-                            hal.scheduler->delay(burst_delay_ms);
+                            if (burst_delay_us > 0) {
+                                next_send_us += burst_delay_us;
+                                const int32_t wait_us = int32_t(next_send_us - AP_HAL::micros());
+                                if (wait_us >= 1000) {
+                                    hal.scheduler->delay(wait_us / 1000);
+                                } else if (wait_us > 0) {
+                                    hal.scheduler->delay_microseconds(wait_us);
+                                } else {
+                                    // we fell behind, don't catch up with a burst
+                                    next_send_us = AP_HAL::micros();
+                                }
+                            }
                         }
 
                         if (reply.opcode != FTP_OP::Nack) {
@@ -75,7 +75,8 @@ GCS_MAVLINK::queued_param_send()
     }
     count -= async_replies_sent_count;
 
-    while (count && _queued_parameter != nullptr && last_txbuf_is_greater(33)) {
+    while (count && _queued_parameter != nullptr && last_txbuf_is_greater(33) &&
+           tx_budget_available(TxClass::PARAMS)) {
         char param_name[AP_MAX_NAME_SIZE];
         _queued_parameter->copy_name_token(_queued_parameter_token, param_name, sizeof(param_name), true);
 
@@ -86,6 +87,7 @@ GCS_MAVLINK::queued_param_send()
             mav_param_type(_queued_parameter_type),
             _queued_parameter_count,
             _queued_parameter_index);
+        tx_budget_charge(TxClass::PARAMS, size_for_one_param_value_msg);
 
         _queued_parameter = AP_Param::next_scalar(&_queued_parameter_token, &_queued_parameter_type);
         _queued_parameter_index++;
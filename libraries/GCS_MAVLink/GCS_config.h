@@ -50,6 +50,12 @@
 #define HAL_MAVLINK_INTERVALS_FROM_FILES_ENABLED ((AP_FILESYSTEM_FATFS_ENABLED || AP_FILESYSTEM_POSIX_ENABLED) && BOARD_FLASH_SIZE > 1024)
 #endif
 
+// keep per-message achieved send interval statistics, reported with
+// the requested intervals of each link in @SYS/mavlink_rates.txt
+#ifndef AP_MAVLINK_SEND_RATE_STATS_ENABLED
+#define AP_MAVLINK_SEND_RATE_STATS_ENABLED HAL_GCS_ENABLED && (BOARD_FLASH_SIZE > 1024)
+#endif
+
 #ifndef AP_MAVLINK_MSG_RELAY_STATUS_ENABLED
 #define AP_MAVLINK_MSG_RELAY_STATUS_ENABLED HAL_GCS_ENABLED && AP_RELAY_ENABLED
 #endif
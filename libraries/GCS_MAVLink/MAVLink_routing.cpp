@@ -33,7 +33,10 @@ extern const AP_HAL::HAL& hal;
 #define ROUTING_DEBUG 0
 
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) : num_routes(0)
+{
+    memset(hash_head, no_route, sizeof(hash_head));
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -175,38 +178,50 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
     bool forwarded = false;
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
     memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
+
+    // broadcasts consider every route, targeted packets only need the
+    // routes chained under their target system
+    uint8_t i = broadcast_system ? 0 : first_route(target_system);
+    while (i < num_routes) {
+        const route &r = routes[i];
+        i = broadcast_system ? i+1 : r.next;
+        if (!broadcast_system && r.sysid != target_system) {
+            // another system sharing this hash bucket
+            continue;
+        }
 
         // Skip if channel is private and the target system or component IDs do not match
-        GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
+        GCS_MAVLINK *out_link = gcs().chan(r.channel);
         if (out_link == nullptr) {
             // this is bad
             continue;
         }
         if (out_link->is_private() &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
+            (target_system != r.sysid ||
+             target_component != r.compid)) {
             continue;
         }
 
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
+        if (broadcast_system || (broadcast_component ||
+                                 target_component == r.compid ||
+                                 !match_system)) {
 
-            if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
+            if (&in_link != out_link && !sent_to_chan[r.channel]) {
                 if (out_link->check_payload_size(msg.len)) {
 #if ROUTING_DEBUG
                     ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
                              msg.msgid,
                              (unsigned)in_link->get_chan(),
-                             (unsigned)routes[i].channel,
+                             (unsigned)r.channel,
                              (int)target_system,
                              (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
+                    _mavlink_resend_uart(r.channel, &msg);
+                    chan_stats[r.channel].forwarded++;
+                } else {
+                    chan_stats[r.channel].dropped++;
                 }
-                sent_to_chan[routes[i].channel] = true;
+                sent_to_chan[r.channel] = true;
                 forwarded = true;
             }
         }
@@ -239,9 +254,9 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
     bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
 
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=first_route(mavlink_system.sysid); i != no_route; i=routes[i].next) {
         if (routes[i].sysid != mavlink_system.sysid) {
-            // our system ID hasn't been seen on this link
+            // another system sharing this hash bucket
             continue;
         }
         if (sent_to_chan[routes[i].channel]) {
@@ -251,6 +266,7 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
         if (comm_get_txspace(routes[i].channel) <
             ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
             // it doesn't fit on this channel
+            chan_stats[routes[i].channel].dropped++;
             continue;
         }
 #if ROUTING_DEBUG
@@ -272,6 +288,7 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
                                         entry->min_msg_len,
                                         MIN(entry->max_msg_len, pkt_len),
                                         entry->crc_extra);
+        chan_stats[routes[i].channel].forwarded++;
         sent_to_chan[routes[i].channel] = true;
     }
 }
@@ -335,33 +352,101 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
         return;
     }
     const mavlink_channel_t in_channel = in_link.get_chan();
-    for (i=0; i<num_routes; i++) {
+    const uint32_t now_ms = AP_HAL::millis();
+    for (i=first_route(msg.sysid); i != no_route; i=routes[i].next) {
         if (routes[i].sysid == msg.sysid &&
             routes[i].compid == msg.compid &&
             routes[i].channel == in_channel) {
             if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
                 routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
             }
-            break;
+            routes[i].last_seen_ms = now_ms;
+            return;
         }
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-        }
-        num_routes++;
+    if (num_routes == MAVLINK_MAX_ROUTES && !expire_oldest_route()) {
+        // table is full of live routes
+        return;
+    }
+    i = num_routes;
+    routes[i].sysid = msg.sysid;
+    routes[i].compid = msg.compid;
+    routes[i].channel = in_channel;
+    routes[i].mavtype = 0;
+    if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+    routes[i].last_seen_ms = now_ms;
+    const uint8_t h = sysid_hash(msg.sysid);
+    routes[i].next = hash_head[h];
+    hash_head[h] = i;
+    num_routes++;
 #if ROUTING_DEBUG
-        ::printf("learned route %u %u via %u\n",
-                 (unsigned)msg.sysid,
-                 (unsigned)msg.compid,
-                 (unsigned)in_channel);
+    ::printf("learned route %u %u via %u\n",
+             (unsigned)msg.sysid,
+             (unsigned)msg.compid,
+             (unsigned)in_channel);
 #endif
+}
+
+
+/*
+  rebuild the sysid hash chains, needed after routes are moved
+*/
+void MAVLink_routing::rebuild_hash(void)
+{
+    memset(hash_head, no_route, sizeof(hash_head));
+    for (uint8_t i=0; i<num_routes; i++) {
+        const uint8_t h = sysid_hash(routes[i].sysid);
+        routes[i].next = hash_head[h];
+        hash_head[h] = i;
     }
 }
 
+/*
+  remove the least recently seen route if it has not been seen for
+  MAVLINK_ROUTE_TIMEOUT_MS, making room for a new route. Returns true
+  if a route was removed
+*/
+bool MAVLink_routing::expire_oldest_route(void)
+{
+    if (num_routes == 0) {
+        return false;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    uint8_t oldest = 0;
+    for (uint8_t i=1; i<num_routes; i++) {
+        if (now_ms - routes[i].last_seen_ms > now_ms - routes[oldest].last_seen_ms) {
+            oldest = i;
+        }
+    }
+    if (now_ms - routes[oldest].last_seen_ms < MAVLINK_ROUTE_TIMEOUT_MS) {
+        return false;
+    }
+#if ROUTING_DEBUG
+    ::printf("expired route %u %u via %u\n",
+             (unsigned)routes[oldest].sysid,
+             (unsigned)routes[oldest].compid,
+             (unsigned)routes[oldest].channel);
+#endif
+    routes[oldest] = routes[num_routes-1];
+    num_routes--;
+    rebuild_hash();
+    return true;
+}
+
+/*
+  get forwarding statistics for a channel
+*/
+void MAVLink_routing::get_chan_stats(mavlink_channel_t channel, uint32_t &forwarded, uint32_t &dropped) const
+{
+    if (!valid_channel(channel)) {
+        forwarded = dropped = 0;
+        return;
+    }
+    forwarded = chan_stats[channel].forwarded;
+    dropped = chan_stats[channel].dropped;
+}
 
 /*
   special handling for heartbeat messages. To ensure routing
@@ -382,7 +467,7 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint8_t i=first_route(msg.sysid); i != no_route; i=routes[i].next) {
         if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
             mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
         }
@@ -3,11 +3,30 @@
 #pragma once
 
 #include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL_Boards.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+// maximum number of learned routes. Boards with plenty of memory
+// allow for companion computers, cameras, gimbals, CAN-bridged
+// components and swarm peers
+#ifndef MAVLINK_MAX_ROUTES
+#if BOARD_FLASH_SIZE > 1024
+#define MAVLINK_MAX_ROUTES 64
+#else
 #define MAVLINK_MAX_ROUTES 20
+#endif
+#endif
+
+static_assert(MAVLINK_MAX_ROUTES < UINT8_MAX, "route indexes must fit in a uint8_t");
+
+// a route not refreshed for this long may be replaced by a new route
+// when the table is full
+#ifndef MAVLINK_ROUTE_TIMEOUT_MS
+#define MAVLINK_ROUTE_TIMEOUT_MS 30000
+#endif
+
+// number of hash buckets for route lookup by sysid, must be a power of 2
+#define MAVLINK_ROUTE_HASH_SIZE 16
 
 /*
   object to handle MAVLink packet routing
@@ -49,16 +68,42 @@ public:
      */
     bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const;
 
+    /*
+      get counts of packets forwarded onto a channel, and packets
+      which should have been forwarded onto it but were dropped for
+      lack of space
+     */
+    void get_chan_stats(mavlink_channel_t channel, uint32_t &forwarded, uint32_t &dropped) const;
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    // routes are stored densely so broadcasts can iterate them, and
+    // chained into hash buckets by sysid so targeted packets only
+    // look at the routes for their target system
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
         mavlink_channel_t channel;
         uint8_t mavtype;
+        uint8_t next;           // next route with the same sysid hash
+        uint32_t last_seen_ms;  // last time a packet arrived from this route
     } routes[MAVLINK_MAX_ROUTES];
+    uint8_t hash_head[MAVLINK_ROUTE_HASH_SIZE];
+    static const uint8_t no_route = UINT8_MAX;
+
+    static uint8_t sysid_hash(uint8_t sysid) { return sysid & (MAVLINK_ROUTE_HASH_SIZE-1); }
+    // return index of the first route with this sysid's hash
+    uint8_t first_route(uint8_t sysid) const { return hash_head[sysid_hash(sysid)]; }
+    // rebuild hash chains after routes have been moved
+    void rebuild_hash(void);
+    // remove the least recently seen route if it has timed out
+    bool expire_oldest_route(void);
+
+    // per-channel forwarding statistics
+    struct {
+        uint32_t forwarded;
+        uint32_t dropped;
+    } chan_stats[MAVLINK_COMM_NUM_BUFFERS];
     
     // a channel mask to block routing as required
     uint8_t no_route_mask;
@@ -101,6 +101,49 @@ void Aircraft::set_start_location(const Location &start_loc, const float start_y
     dcm.from_euler(0.0f, 0.0f, radians(home_yaw));
 }
 
+/*
+  get the kinematic state of the vehicle for a SITL checkpoint
+ */
+void Aircraft::get_checkpoint_state(CheckpointState &state) const
+{
+    state.origin = origin;
+    state.home = home;
+    state.location = location;
+    state.home_yaw = home_yaw;
+    state.ground_level = ground_level;
+    state.dcm = dcm;
+    state.gyro = gyro;
+    state.velocity_ef = velocity_ef;
+    state.accel_body = accel_body;
+    state.position = position;
+    state.time_now_us = time_now_us;
+}
+
+/*
+  restore the kinematic state of the vehicle from a SITL
+  checkpoint. This replaces the start location, so it must be called
+  after set_start_location()
+ */
+void Aircraft::set_checkpoint_state(const CheckpointState &state)
+{
+    origin = state.origin;
+    home = state.home;
+    home_is_set = true;
+    location = state.location;
+    home_yaw = state.home_yaw;
+    ground_level = state.ground_level;
+    dcm = state.dcm;
+    gyro = state.gyro;
+    velocity_ef = state.velocity_ef;
+    accel_body = state.accel_body;
+    position = state.position;
+    time_now_us = state.time_now_us;
+    last_time_us = time_now_us;
+
+    // force sensor smoothing to re-initialise from the restored state
+    smoothing.last_update_us = 0;
+}
+
 /*
    return difference in altitude between home position and current loc
 */
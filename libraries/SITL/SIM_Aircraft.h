@@ -163,6 +163,25 @@ public:
     float get_battery_voltage() const { return battery_voltage; }
     float get_battery_temperature() const { return battery.get_temperature(); }
 
+    /*
+      kinematic state saved and restored by SITL checkpoints
+     */
+    struct CheckpointState {
+        Location origin;
+        Location home;
+        Location location;
+        float home_yaw;
+        float ground_level;
+        Matrix3f dcm;
+        Vector3f gyro;
+        Vector3f velocity_ef;
+        Vector3f accel_body;
+        Vector3d position;
+        uint64_t time_now_us;
+    };
+    void get_checkpoint_state(CheckpointState &state) const;
+    void set_checkpoint_state(const CheckpointState &state);
+
     ADSB *adsb;
 
 protected: